@@ -8,9 +8,13 @@
 //
 //  History:   1.0   14.07.03  first released version
 //             1.2   31.01.08  change TBuffer toTBufferFile
+//             1.3   16.10.26  read elements from the memory mapped file
+//             1.4   16.10.26  thread safe reading with pread
+//             2.0   16.10.26  format ASRO0002 with 64 bit positions
 //
 // ////////////////////////////////////////////////////////////////////////////
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -25,14 +29,7 @@
 #define MyBuffer TBuffer
 #endif
 
-#ifdef R__BYTESWAP
-#if (defined(__linux) || defined(__APPLE__)) && defined(__i386__) && defined(__GNUC__)
-#define USE_BSWAPCPY
-#include <Bswapcpy.h>
-#else
 #include <Bytes.h>
-#endif
-#endif
 
 #include "TFAsroFile.h"
 
@@ -60,6 +57,21 @@ static Bool_t Uncompress(UChar_t* in, char* out, UInt_t outLength);
 // TFAsroKey and TFAsroValue, respectively.
 // Therefore it is important: Never delete a name in fClassNames and fNames!
 // even if the component is deleted in the file.
+//
+// Elements are read from the file mapped read only and shared into memory
+// (see SetMemoryMap()). Uncompressed elements are streamed directly from
+// the mapped pages and compressed elements are uncompressed from them.
+// All processes reading the same file share these pages in the page cache
+// of the kernel.
+//
+// There are two formats of ASRO files. Files of the format ASRO0001 store
+// positions and lengths as 32 bit words and are limited to 4 GB. Files of
+// the format ASRO0002 store them as 64 bit words. New files are always
+// created as ASRO0002, existing ASRO0001 files are read and updated in
+// their format. The descriptor of an ASRO0001 file is the streamed
+// TFAsroFile, the one of an ASRO0002 file is written by StreamDescriptor().
+
+Bool_t TFAsroFile::fgMemoryMap = kTRUE;
 
 TFAsroKey::TFAsroKey(const TFAsroKey& key) {
   fElName = key.fElName;
@@ -94,6 +106,9 @@ TFAsroValue::TFAsroValue() {
   fFileLength = 0;
   fDataLength = 0;
   fClassName = 0;
+  fPosHigh = 0;
+  fFileLengthHigh = 0;
+  fDataLengthHigh = 0;
 }
 //_____________________________________________________________________________
 TFAsroValue::TFAsroValue(const TFAsroValue& value) {
@@ -101,6 +116,9 @@ TFAsroValue::TFAsroValue(const TFAsroValue& value) {
   fFileLength = value.fFileLength;
   fDataLength = value.fDataLength;
   fClassName = value.fClassName;
+  fPosHigh = value.fPosHigh;
+  fFileLengthHigh = value.fFileLengthHigh;
+  fDataLengthHigh = value.fDataLengthHigh;
 }
 //_____________________________________________________________________________
 TFAsroValue& TFAsroValue::operator=(const TFAsroValue& value) {
@@ -109,6 +127,9 @@ TFAsroValue& TFAsroValue::operator=(const TFAsroValue& value) {
     fFileLength = value.fFileLength;
     fDataLength = value.fDataLength;
     fClassName = value.fClassName;
+    fPosHigh = value.fPosHigh;
+    fFileLengthHigh = value.fFileLengthHigh;
+    fDataLengthHigh = value.fDataLengthHigh;
   }
   return *this;
 }
@@ -138,10 +159,13 @@ Bool_t TFAsroElementIter::Next() {
 //_____________________________________________________________________________
 //_____________________________________________________________________________
 TFAsroFile::TFAsroFile() {
-  fDes[0] = fDes[1] = fDes[2] = 0;
+  fFormat = 2;
+  fDes[0] = fDes[1] = fDes[2] = fDes[3] = 0;
   fFreeReserve = 0;
   fFree = NULL;
   fFile = -1;
+  fMap = NULL;
+  fMapSize = 0;
 }
 //_____________________________________________________________________________
 TFAsroFile::TFAsroFile(const char* fileName, Bool_t* readOnly) {
@@ -159,10 +183,17 @@ TFAsroFile::TFAsroFile(const char* fileName, Bool_t* readOnly) {
   //  If anything went wrong the file descriptor fFile is set to a value
   //  less than 0. If fFile >= 0 the calling function can assume that
   //  the file is successfully open and can be used.
+  //
+  //  A new file is created in the format ASRO0002.
 
   bool ok = true;  // will be set to false if anything goes wrong
 
+  fFormat = 2;
+  fDes[0] = fDes[1] = fDes[2] = fDes[3] = 0;
+  fFreeReserve = 0;
   fFree = NULL;
+  fMap = NULL;
+  fMapSize = 0;
 
   fFile = open(fileName, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 
@@ -183,83 +214,50 @@ TFAsroFile::TFAsroFile(const char* fileName, Bool_t* readOnly) {
     // the file exist already
     char id[8] = "";
     ok &= read(fFile, id, 8) == 8;
-    if (!ok || strncmp(id, "ASRO0001", 8) != 0) {
+    if (ok && strncmp(id, "ASRO0001", 8) == 0)
+      fFormat = 1;
+    else if (ok && strncmp(id, "ASRO0002", 8) == 0)
+      fFormat = 2;
+    else {
       // it is not an ASRO - file
       close(fFile);
       fFile = -2;
       return;
     }
 
-#ifdef R__BYTESWAP
-    UInt_t des[4];
-    ok &= read(fFile, des, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-
-#ifdef USE_BSWAPCPY
-    bswapcpy32(fDes, des, 4);
-#else
-    for (int i = 0; i < 4; i++)
-      frombuf(reinterpret_cast<char*&>(des), &fDes[i]);
-#endif
-#else
-    ok &= read(fFile, fDes, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-#endif
+    ok &= ReadWords(fDes, 4, 8);
 
     // read and create the descriptor
-    lseek(fFile, fDes[0], SEEK_SET);
-    if (fDes[1] > 0) {
-      MyBuffer buffer(TBuffer::kRead, fDes[1]);
-      ok &= read(fFile, buffer.Buffer(), fDes[1]) == fDes[1];
-      Streamer(buffer);
+    if (ok && fDes[1] > 0) {
+      MyBuffer buffer(TBuffer::kRead, (Int_t)fDes[1]);
+      ok &= pread(fFile, buffer.Buffer(), fDes[1], fDes[0]) == (ssize_t)fDes[1];
+      if (ok)
+        StreamDescriptor(buffer);
     }
 
     // read the free mem info
-    fFreeReserve = fDes[2];
-    fFree = new UInt_t[fFreeReserve / sizeof(UInt_t)];
-#ifdef R__BYTESWAP
-    UInt_t* freeSwap = new UInt_t[fFreeReserve / sizeof(UInt_t)];
-    ok &= read(fFile, freeSwap, fDes[2]) == fDes[2];
-#ifdef USE_BSWAPCPY
-    bswapcpy32(fFree, freeSwap, fFreeReserve / sizeof(UInt_t));
-#else
-    for (int i = 0; i < fFreeReserve / sizeof(UInt_t); i++)
-      frombuf(reinterpret_cast<char*&>(freeSwap), &fFree[i]);
-#endif
-    delete[] freeSwap;
-#else
-    ok &= read(fFile, fFree, fDes[2]) == fDes[2];
-#endif
+    if (ok) {
+      fFreeReserve = fDes[2] / (2 * GetWordSize());
+      fFree = new ULong64_t[2 * fFreeReserve];
+      ok &= ReadWords(fFree, 2 * fFreeReserve, fDes[0] + fDes[1]);
+    }
   } else {
     // we create a new ASRO - file
-    ok &= write(fFile, "ASRO0001", 8) == 8;
+    fFormat = 2;
+    ok &= write(fFile, "ASRO0002", 8) == 8;
 
-    fDes[0] = 8 + 4 * sizeof(UInt_t);
+    fDes[0] = 8 + 4 * GetWordSize();
     fDes[1] = 0;
-    fDes[2] = 2 * sizeof(UInt_t);
+    fDes[2] = 2 * GetWordSize();
     fDes[3] = 0;
 
-    fFreeReserve = fDes[2];
-    fFree = new UInt_t[fFreeReserve / sizeof(UInt_t)];
-    fFree[0] = 8 + 6 * sizeof(UInt_t);
-    fFree[1] = 0xFFFFFFFFU - (8 + 6 * sizeof(UInt_t));
-
-#ifdef R__BYTESWAP
-    UInt_t desSwap[4];
-    UInt_t freeSwap[2];
-#ifdef USE_BSWAPCPY
-    bswapcpy32(desSwap, fDes, 4);
-    bswapcpy32(freeSwap, fFree, 2);
-#else
-    for (int i = 0; i < 4; i++)
-      frombuf(reinterpret_cast<char*&>(fDes), &desSwap[i]);
-    for (int i = 0; i < 2; i++)
-      frombuf(reinterpret_cast<char*&>(fFree), &freeSwap[i]);
-#endif
-    ok &= write(fFile, desSwap, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-    ok &= write(fFile, freeSwap, fDes[2]) == fDes[2];
-#else
-    ok &= write(fFile, fDes, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-    ok &= write(fFile, fFree, fDes[2]) == fDes[2];
-#endif
+    fFreeReserve = 1;
+    fFree = new ULong64_t[2 * fFreeReserve];
+    fFree[0] = fDes[0] + fDes[2];
+    fFree[1] = 0x7FFFFFFFFFFFFFFFULL - fFree[0];
+
+    ok &= WriteWords(fDes, 4, 8);
+    ok &= WriteWords(fFree, 2, fDes[0]);
   }
 
   if (ok)
@@ -271,6 +269,10 @@ TFAsroFile::TFAsroFile(const char* fileName, Bool_t* readOnly) {
 }
 //_____________________________________________________________________________
 TFAsroFile::~TFAsroFile() {
+  std::map<char*, std::pair<size_t, UInt_t> >::iterator i_map;
+  for (i_map = fMapUsers.begin(); i_map != fMapUsers.end(); i_map++)
+    munmap(i_map->first, i_map->second.first);
+
   if (fFile >= 0)
     close(fFile);
 
@@ -287,15 +289,18 @@ TObject* TFAsroFile::Read(const char* name, const char* subName, Int_t cycle) {
 
   // find the nameIndex in names
   UInt_t nameIndex;
-  int numNames = fNames.size();
-  if (numNames == 0)
-    return NULL;
-
-  for (nameIndex = 0; nameIndex < numNames; nameIndex++)
-    if (fNames[nameIndex] == name)
-      break;
-  if (nameIndex == numNames)
-    return NULL;
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    int numNames = fNames.size();
+    if (numNames == 0)
+      return NULL;
+
+    for (nameIndex = 0; nameIndex < numNames; nameIndex++)
+      if (fNames[nameIndex] == name)
+        break;
+    if (nameIndex == numNames)
+      return NULL;
+  }
 
   return Read(TFAsroKey(nameIndex, subName, cycle));
 }
@@ -304,36 +309,69 @@ TObject* TFAsroFile::Read(const TFAsroKey& key) {
   // Returns the requested object, read from the file.
   // If the retunr value is not NULL the calling function can assume that
   // everything is OK.
+  // Several threads can read elements of the same file at the same time:
+  // only the look up of the key in the descriptor is serialized, the
+  // data are read with positional I/O (pread) or from the memory mapped
+  // file and are uncompressed and streamed in the calling thread.
 
   if (fFile < 0)
     return NULL;
 
   // look for the key in this file
-  std::map<TFAsroKey, TFAsroValue>::iterator i_entry;
-  i_entry = fEntries.find(key);
-  if (i_entry == fEntries.end())
-    // this key does not exist in the file
-    return NULL;
+  TFAsroValue value;
+  TString className;
+  const char* mapped;
+  char* map = NULL;
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    std::map<TFAsroKey, TFAsroValue>::iterator i_entry;
+    i_entry = fEntries.find(key);
+    if (i_entry == fEntries.end())
+      // this key does not exist in the file
+      return NULL;
+
+    value = i_entry->second;
+    className = fClassNames[value.GetClassName()];
+    mapped = MapRegion(value.GetPos(), value.GetFileLength(), map);
+  }
+
+  if (mapped && value.GetDataLength() == value.GetFileLength()) {
+    // stream the object directly from the mapped pages
+    TObject* obj;
+    {
+      MyBuffer buffer(TBuffer::kRead, (Int_t)value.GetDataLength(), const_cast<char*>(mapped), kFALSE);
+      obj = NewObject(className, buffer);
+    }
+    ReleaseMap(map);
+    return obj;
+  }
 
   // read the buffer
   bool ok;
-  lseek(fFile, i_entry->second.GetPos(), SEEK_SET);
-  MyBuffer buffer(TBuffer::kRead, i_entry->second.GetDataLength());
-  if (i_entry->second.GetDataLength() == i_entry->second.GetFileLength())
-    ok = read(fFile, buffer.Buffer(), i_entry->second.GetDataLength()) == i_entry->second.GetDataLength();
+  MyBuffer buffer(TBuffer::kRead, (Int_t)value.GetDataLength());
+  if (mapped) {
+    ok = Uncompress((UChar_t*)mapped, buffer.Buffer(), value.GetDataLength());
+    ReleaseMap(map);
+  } else if (value.GetDataLength() == value.GetFileLength())
+    ok = pread(fFile, buffer.Buffer(), value.GetDataLength(), value.GetPos()) == value.GetDataLength();
   else {
-    UChar_t* fileBuffer = new UChar_t[i_entry->second.GetFileLength()];
-    ok = read(fFile, fileBuffer, i_entry->second.GetFileLength()) == i_entry->second.GetFileLength();
-    Uncompress(fileBuffer, buffer.Buffer(), i_entry->second.GetDataLength());
+    UChar_t* fileBuffer = new UChar_t[value.GetFileLength()];
+    ok = pread(fFile, fileBuffer, value.GetFileLength(), value.GetPos()) == value.GetFileLength();
+    ok = ok && Uncompress(fileBuffer, buffer.Buffer(), value.GetDataLength());
     delete[] fileBuffer;
   }
 
   if (!ok)
     return NULL;
 
-  // create a new object and stream it
-  TClass cl(fClassNames[i_entry->second.GetClassName()].Data());
-  TObject* obj = (TObject*)cl.New();
+  return NewObject(className, buffer);
+}
+//_____________________________________________________________________________
+TObject* TFAsroFile::NewObject(const char* className, TBuffer& buffer) {
+  // Creates a new object of the class className and streams it from buffer.
+
+  TClass* cl = TClass::GetClass(className);
+  TObject* obj = cl ? (TObject*)cl->New() : NULL;
 
   if (obj)
     obj->Streamer(buffer);
@@ -341,23 +379,85 @@ TObject* TFAsroFile::Read(const TFAsroKey& key) {
   return obj;
 }
 //_____________________________________________________________________________
+const char* TFAsroFile::MapRegion(ULong64_t pos, ULong64_t length, char*& map) {
+  // Returns the address of the bytes pos to pos + length of the file in
+  // the memory mapped file or NULL if the file is not mapped. map is set
+  // to the mapping of the returned region; the caller must release it
+  // with ReleaseMap() when it does not read from the region any more.
+  // The whole file is mapped read only and shared. The file is mapped
+  // again if the region is behind the end of the mapped file, for example
+  // after an element was written at the end of the file. Elements written
+  // into the mapped region are seen by the mapping, as it shares the
+  // pages of the page cache with write().
+  // A previous mapping is kept as long as other threads still stream
+  // objects from it and unmapped by the last of them. fMutex must be locked.
+
+  if (!fgMemoryMap || fFile < 0)
+    return NULL;
+
+  if (fMap == NULL || pos + length > fMapSize) {
+    struct stat buf;
+    if (fstat(fFile, &buf) != 0 || pos + length > (ULong64_t)buf.st_size)
+      return NULL;
+
+    if (fMap && fMapUsers[fMap].second == 0) {
+      // nobody reads from the previous mapping
+      munmap(fMap, fMapSize);
+      fMapUsers.erase(fMap);
+    }
+
+    fMap = (char*)mmap(NULL, buf.st_size, PROT_READ, MAP_SHARED, fFile, 0);
+    if (fMap == MAP_FAILED) {
+      fMap = NULL;
+      fMapSize = 0;
+      return NULL;
+    }
+    fMapSize = buf.st_size;
+    fMapUsers[fMap] = std::make_pair(fMapSize, 0U);
+  }
+
+  map = fMap;
+  fMapUsers[fMap].second++;
+  return fMap + pos;
+}
+//_____________________________________________________________________________
+void TFAsroFile::ReleaseMap(char* map) {
+  // Releases the mapping map, returned by MapRegion(). A previous mapping
+  // of the file is unmapped when its last reader releases it.
+
+  std::lock_guard<std::mutex> lock(fMutex);
+
+  std::map<char*, std::pair<size_t, UInt_t> >::iterator i_map = fMapUsers.find(map);
+  if (i_map == fMapUsers.end())
+    return;
+
+  i_map->second.second--;
+  if (i_map->second.second == 0 && map != fMap) {
+    munmap(map, i_map->second.first);
+    fMapUsers.erase(i_map);
+  }
+}
+//_____________________________________________________________________________
 bool TFAsroFile::InitWrite() {
   if (fFile < 0)
     return false;
 
+  std::lock_guard<std::mutex> lock(fMutex);
+
   // free space for old description
   MakeFree(fDes[0], fDes[1] + fDes[2] + fDes[3]);
 
-  // write 0 to first byte
-  lseek(fFile, 8, SEEK_SET);
-  UInt_t zero = 0;
-  return write(fFile, &zero, sizeof(UInt_t)) == sizeof(UInt_t);
+  // write 0 to the position of the descriptor
+  ULong64_t zero = 0;
+  return WriteWords(&zero, 1, 8);
 }
 //_____________________________________________________________________________
 bool TFAsroFile::Write(TObject* obj, int compLevel, const char* name, const char* subName, Int_t cycle) {
   if (fFile < 0)
     return false;
 
+  std::lock_guard<std::mutex> lock(fMutex);
+
   // find the nameIndex in names or add it to names
   UInt_t nameIndex;
   int numNames = fNames.size();
@@ -398,7 +498,7 @@ bool TFAsroFile::Write(TObject* obj, int compLevel, const char* name, const char
     }
   }
 
-  fDes[3] = 2 * sizeof(UInt_t);
+  fDes[3] = 2 * GetWordSize();
 
   // find the classNameIndex in ClassNames or add it to names
   UInt_t classNameIndex;
@@ -416,11 +516,15 @@ bool TFAsroFile::Write(TObject* obj, int compLevel, const char* name, const char
   asroValue.SetClassName(classNameIndex);
 
   // save new obj to file
-  lseek(fFile, asroValue.GetPos(), SEEK_SET);
-  bool ok = write(fFile, dataBuffer, asroValue.GetFileLength()) == asroValue.GetFileLength();
+  bool ok = asroValue.GetPos() > 0 &&
+            pwrite(fFile, dataBuffer, asroValue.GetFileLength(), asroValue.GetPos()) == (ssize_t)asroValue.GetFileLength();
   if (dataBuffer != buffer.Buffer())
     delete[] dataBuffer;
 
+  if (asroValue.GetPos() == 0)
+    // the file is full, only possible for ASRO0001 files
+    fEntries.erase(key);
+
   return ok;
 }
 //_____________________________________________________________________________
@@ -428,59 +532,144 @@ bool TFAsroFile::FinishWrite() {
   if (fFile < 0)
     return false;
 
-  bool ok = true;
+  std::lock_guard<std::mutex> lock(fMutex);
+
+  fDes[3] = 2 * GetWordSize();
+  return WriteDescriptor();
+}
+//_____________________________________________________________________________
+bool TFAsroFile::WriteDescriptor() {
+  // Writes the descriptor and the free list into free space of the file
+  // and their position and lengths into the first bytes of the file.
+  // fDes[3] are the bytes reserved behind the free list, as the free
+  // list can grow while the space for the descriptor is allocated.
 
   // create and fill buffer for the descriptor
   MyBuffer desBuffer(TBuffer::kWrite);
-  Streamer(desBuffer);
+  StreamDescriptor(desBuffer);
   fDes[1] = desBuffer.Length();
 
-  fDes[3] = 2 * sizeof(UInt_t);
   // get new position for descriptor
   fDes[0] = GetFree(fDes[1] + fDes[2] + fDes[3]);
+  if (fDes[0] == 0)
+    return false;
 
-  // save descriptor to file
-  lseek(fFile, fDes[0], SEEK_SET);
-  ok &= write(fFile, desBuffer.Buffer(), fDes[1]) == fDes[1];
-
-#ifdef R__BYTESWAP
-  // save free space to file
-  UInt_t* freeSwap = new UInt_t[fDes[2] / sizeof(UInt_t)];
-#ifdef USE_BSWAPCPY
-  bswapcpy32(freeSwap, fFree, fDes[2] / sizeof(UInt_t));
-#else
-  for (int i = 0; i < fDes[2] / sizeof(UInt_t); i++)
-    frombuf(reinterpret_cast<char*&>(fFree), &freeSwap[i]);
-#endif
-  ok &= write(fFile, freeSwap, fDes[2]) == fDes[2];
-  delete[] freeSwap;
-
-  // save first bytes to file
-  UInt_t desSwap[4];
-#ifdef USE_BSWAPCPY
-  bswapcpy32(desSwap, fDes, 4);
-#else
-  for (int i = 0; i < 4; i++)
-    frombuf(reinterpret_cast<char*&>(fDes), &desSwap[i]);
-#endif
-  lseek(fFile, 8, SEEK_SET);
-  ok &= write(fFile, desSwap, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-#else
-  // save free space to file
-  ok &= write(fFile, fFree, fDes[2]) == fDes[2];
+  // save descriptor and free space to file
+  bool ok = pwrite(fFile, desBuffer.Buffer(), fDes[1], fDes[0]) == (ssize_t)fDes[1];
+  ok &= WriteWords(fFree, fDes[2] / GetWordSize(), fDes[0] + fDes[1]);
 
   // save first bytes to file
-  lseek(fFile, 8, SEEK_SET);
-  ok &= write(fFile, fDes, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-#endif
+  ok &= WriteWords(fDes, 4, 8);
 
   return ok;
 }
 //_____________________________________________________________________________
+void TFAsroFile::StreamDescriptor(TBuffer& buffer) {
+  // Reads or writes the descriptor: the element names, the class names
+  // and all entries of the file. In ASRO0001 files it is the streamed
+  // TFAsroFile with 32 bit positions and lengths. In ASRO0002 files
+  // the positions and lengths are written as 64 bit values.
+
+  if (fFormat == 1) {
+    Streamer(buffer);
+    return;
+  }
+
+  if (buffer.IsReading()) {
+    UInt_t num;
+    buffer >> num;
+    fNames.resize(num);
+    for (UInt_t index = 0; index < num; index++)
+      fNames[index].Streamer(buffer);
+
+    buffer >> num;
+    fClassNames.resize(num);
+    for (UInt_t index = 0; index < num; index++)
+      fClassNames[index].Streamer(buffer);
+
+    buffer >> num;
+    fEntries.clear();
+    for (UInt_t index = 0; index < num; index++) {
+      UInt_t elName, className;
+      TString subName;
+      Int_t cycle;
+      ULong64_t pos, fileLength, dataLength;
+      buffer >> elName;
+      subName.Streamer(buffer);
+      buffer >> cycle >> pos >> fileLength >> dataLength >> className;
+
+      TFAsroValue& value = fEntries[TFAsroKey(elName, subName.Data(), cycle)];
+      value.SetPos(pos);
+      value.SetFileLength(fileLength);
+      value.SetDataLength(dataLength);
+      value.SetClassName(className);
+    }
+  } else {
+    buffer << (UInt_t)fNames.size();
+    for (UInt_t index = 0; index < fNames.size(); index++)
+      fNames[index].Streamer(buffer);
+
+    buffer << (UInt_t)fClassNames.size();
+    for (UInt_t index = 0; index < fClassNames.size(); index++)
+      fClassNames[index].Streamer(buffer);
+
+    buffer << (UInt_t)fEntries.size();
+    std::map<TFAsroKey, TFAsroValue>::iterator i_entry;
+    for (i_entry = fEntries.begin(); i_entry != fEntries.end(); i_entry++) {
+      TString subName = i_entry->first.GetSubName();
+      buffer << i_entry->first.GetElName();
+      subName.Streamer(buffer);
+      buffer << i_entry->first.GetCycle() << i_entry->second.GetPos() << i_entry->second.GetFileLength()
+             << i_entry->second.GetDataLength() << i_entry->second.GetClassName();
+    }
+  }
+}
+//_____________________________________________________________________________
+bool TFAsroFile::ReadWords(ULong64_t* words, UInt_t num, ULong64_t pos) {
+  // Reads num words at position pos of the file. A word has 4 bytes in
+  // ASRO0001 files and 8 bytes in ASRO0002 files, stored in big endian
+  // byte order.
+
+  UInt_t wordSize = GetWordSize();
+  std::vector<char> buffer((size_t)num * wordSize);
+  if (pread(fFile, buffer.data(), buffer.size(), pos) != (ssize_t)buffer.size())
+    return false;
+
+  char* in = buffer.data();
+  for (UInt_t index = 0; index < num; index++) {
+    if (wordSize == sizeof(UInt_t)) {
+      UInt_t word;
+      frombuf(in, &word);
+      words[index] = word;
+    } else
+      frombuf(in, &words[index]);
+  }
+  return true;
+}
+//_____________________________________________________________________________
+bool TFAsroFile::WriteWords(const ULong64_t* words, UInt_t num, ULong64_t pos) {
+  // Writes num words at position pos into the file. See ReadWords().
+
+  UInt_t wordSize = GetWordSize();
+  std::vector<char> buffer((size_t)num * wordSize);
+
+  char* out = buffer.data();
+  for (UInt_t index = 0; index < num; index++) {
+    if (wordSize == sizeof(UInt_t))
+      tobuf(out, (UInt_t)words[index]);
+    else
+      tobuf(out, words[index]);
+  }
+
+  return pwrite(fFile, buffer.data(), buffer.size(), pos) == (ssize_t)buffer.size();
+}
+//_____________________________________________________________________________
 bool TFAsroFile::Delete(const char* name, const char* subName, Int_t cycle) {
   if (fFile < 0)
     return false;
 
+  std::lock_guard<std::mutex> lock(fMutex);
+
   // find the nameIndex in names
   UInt_t nameIndex;
   int numNames = fNames.size();
@@ -526,73 +715,37 @@ bool TFAsroFile::Delete(const char* name, const char* subName, Int_t cycle) {
     fEntries.erase(i_begin, i_end);
   }
 
-  bool ok = true;
-
-  // create and fill buffer
-  MyBuffer buffer(TBuffer::kWrite);
-  Streamer(buffer);
-  fDes[1] = buffer.Length();
-
-  // get new position for descriptor
-  fDes[3] = 2 * 2 * sizeof(UInt_t);
-  fDes[0] = GetFree(fDes[1] + fDes[2] + fDes[3]);
-
-  // save descriptor to file
-  lseek(fFile, fDes[0], SEEK_SET);
-  ok &= write(fFile, buffer.Buffer(), fDes[1]) == fDes[1];
-
-#ifdef R__BYTESWAP
-  // save free space to file
-  UInt_t* freeSwap = new UInt_t[fDes[2] / sizeof(UInt_t)];
-#ifdef USE_BSWAPCPY
-  bswapcpy32(freeSwap, fFree, fDes[2] / sizeof(UInt_t));
-#else
-  for (int i = 0; i < fDes[2] / sizeof(UInt_t); i++)
-    frombuf(reinterpret_cast<char*&>(fFree), &freeSwap[i]);
-#endif
-  ok &= write(fFile, freeSwap, fDes[2]) == fDes[2];
-  delete[] freeSwap;
-
-  // save first bytes to file
-  UInt_t desSwap[4];
-#ifdef USE_BSWAPCPY
-  bswapcpy32(desSwap, fDes, 4);
-#else
-  for (int i = 0; i < 4; i++)
-    frombuf(reinterpret_cast<char*&>(fDes), &desSwap[i]);
-#endif
-  lseek(fFile, 8, SEEK_SET);
-  ok &= write(fFile, desSwap, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-#else
-  // save free space to file
-  ok &= write(fFile, fFree, fDes[2]) == fDes[2];
-
-  // save first bytes to file
-  lseek(fFile, 8, SEEK_SET);
-  ok &= write(fFile, fDes, 4 * sizeof(UInt_t)) == 4 * sizeof(UInt_t);
-#endif
-
-  return ok;
+  fDes[3] = 2 * 2 * GetWordSize();
+  return WriteDescriptor();
 }
 //_____________________________________________________________________________
-UInt_t TFAsroFile::GetFree(UInt_t size) {
-  UInt_t bestFit = 0;
-  UInt_t bestSize = 0xFFFFFFFFU;
+ULong64_t TFAsroFile::GetFree(ULong64_t size) {
+  // Returns the position of free space of size bytes in the file and
+  // removes it from the free list. Returns 0 if no free space is large
+  // enough, this is only possible for ASRO0001 files.
+
+  UInt_t item = 2 * GetWordSize();
+  UInt_t numFree = fDes[2] / item;
+  UInt_t bestFit = numFree;
+  ULong64_t bestSize = 0;
 
   // look for the smallest hole, but at least the size of "size"
-  for (UInt_t index = 0; index < fDes[2] / (2 * sizeof(UInt_t)); index++)
-    if (size <= fFree[index * 2 + 1] && bestSize > fFree[index * 2 + 1]) {
+  for (UInt_t index = 0; index < numFree; index++)
+    if (size <= fFree[index * 2 + 1] && (bestFit == numFree || bestSize > fFree[index * 2 + 1])) {
       bestFit = index;
       bestSize = fFree[index * 2 + 1];
     }
 
-  UInt_t pos = fFree[bestFit * 2];
+  if (bestFit == numFree)
+    return 0;
+
+  ULong64_t pos = fFree[bestFit * 2];
   if (size == fFree[bestFit * 2 + 1]) {
     // the new fits perfect in this free space
     // remove the hole
-    memmove(fFree + 2 * bestFit, fFree + 2 * (bestFit + 1), fDes[2] - (bestFit + 1) * 2 * sizeof(UInt_t));
-    fDes[2] -= 2 * sizeof(UInt_t);
-    fDes[3] += 2 * sizeof(UInt_t);
+    memmove(fFree + 2 * bestFit, fFree + 2 * (bestFit + 1), (numFree - bestFit - 1) * 2 * sizeof(ULong64_t));
+    fDes[2] -= item;
+    fDes[3] += item;
   } else {
     // resize the hole
     fFree[bestFit * 2] += size;      // shift the start pos
@@ -601,11 +754,14 @@ UInt_t TFAsroFile::GetFree(UInt_t size) {
   return pos;
 }
 //_____________________________________________________________________________
-void TFAsroFile::MakeFree(UInt_t pos, UInt_t size) {
+void TFAsroFile::MakeFree(ULong64_t pos, ULong64_t size) {
+  UInt_t item = 2 * GetWordSize();
+  UInt_t numFree = fDes[2] / item;
+
   // find first free behind pos
   UInt_t index = 0;
 
-  while (index < fDes[2] / (2 * sizeof(UInt_t)) && pos > fFree[index * 2])
+  while (index < numFree && pos > fFree[index * 2])
     index++;
 
   if (index == 0) {
@@ -616,20 +772,20 @@ void TFAsroFile::MakeFree(UInt_t pos, UInt_t size) {
       fFree[1] += size;
     } else {
       // insert a new free item at index 0
-      if (fDes[2] == fFreeReserve) {
-        // increase allocated memory for 100 entries
-        fFreeReserve += 100 * sizeof(UInt_t);
-        UInt_t* tmp = new UInt_t[fFreeReserve / sizeof(UInt_t)];
-        memcpy(tmp + 2, fFree, fDes[2]);
+      if (numFree == fFreeReserve) {
+        // increase allocated memory for 50 entries
+        fFreeReserve += 50;
+        ULong64_t* tmp = new ULong64_t[2 * fFreeReserve];
+        memcpy(tmp + 2, fFree, numFree * 2 * sizeof(ULong64_t));
 
         delete[] fFree;
         fFree = tmp;
       } else {
         // make space for the new entry
-        memmove(fFree + 2, fFree, fDes[2]);
+        memmove(fFree + 2, fFree, numFree * 2 * sizeof(ULong64_t));
       }
-      fDes[2] += 2 * sizeof(UInt_t);
-      fDes[3] -= 2 * sizeof(UInt_t);
+      fDes[2] += item;
+      fDes[3] -= item;
       fFree[0] = pos;
       fFree[1] = size;
     }
@@ -637,7 +793,7 @@ void TFAsroFile::MakeFree(UInt_t pos, UInt_t size) {
   }
 
   bool before = fFree[(index - 1) * 2] + fFree[(index - 1) * 2 + 1] == pos;
-  bool after = pos + size == fFree[index * 2];
+  bool after = index < numFree && pos + size == fFree[index * 2];
 
   if (before && !after)
     // there is a free space just before but allocated space after
@@ -657,30 +813,30 @@ void TFAsroFile::MakeFree(UInt_t pos, UInt_t size) {
   // increase the space of the one before and remove the one behind
   {
     fFree[(index - 1) * 2 + 1] += size + fFree[index * 2 + 1];
-    memmove(fFree + 2 * index, fFree + 2 * (index + 1), fDes[2] - (index + 1) * 2 * sizeof(UInt_t));
-    fDes[2] -= 2 * sizeof(UInt_t);
-    fDes[3] += 2 * sizeof(UInt_t);
+    memmove(fFree + 2 * index, fFree + 2 * (index + 1), (numFree - index - 1) * 2 * sizeof(ULong64_t));
+    fDes[2] -= item;
+    fDes[3] += item;
   }
 
   else if (!before && !after)
   // there is no free space just before an no just behind
   // create a new free space
   {
-    if (fDes[2] == fFreeReserve) {
-      // increase allocated memory for 100 entries
-      fFreeReserve += 100 * sizeof(UInt_t);
-      UInt_t* tmp = new UInt_t[fFreeReserve / sizeof(UInt_t)];
-      memcpy(tmp, fFree, index * 2 * sizeof(UInt_t));
-      memcpy(tmp + (index + 1) * 2, fFree + index * 2, fDes[2] - index * 2 * sizeof(UInt_t));
+    if (numFree == fFreeReserve) {
+      // increase allocated memory for 50 entries
+      fFreeReserve += 50;
+      ULong64_t* tmp = new ULong64_t[2 * fFreeReserve];
+      memcpy(tmp, fFree, index * 2 * sizeof(ULong64_t));
+      memcpy(tmp + (index + 1) * 2, fFree + index * 2, (numFree - index) * 2 * sizeof(ULong64_t));
 
       delete[] fFree;
       fFree = tmp;
     } else {
       // make space for the new entry
-      memmove(fFree + 2 * (index + 1), fFree + 2 * index, fDes[2] - index * 2 * sizeof(UInt_t));
+      memmove(fFree + 2 * (index + 1), fFree + 2 * index, (numFree - index) * 2 * sizeof(ULong64_t));
     }
-    fDes[2] += 2 * sizeof(UInt_t);
-    fDes[3] -= 2 * sizeof(UInt_t);
+    fDes[2] += item;
+    fDes[3] -= item;
     fFree[index * 2] = pos;
     fFree[index * 2 + 1] = size;
   }
@@ -22,6 +22,9 @@
 
 #include <map>
 #include <vector>
+#include <mutex>
+
+class TBuffer;
  
 
 //_____________________________________________________________________________
@@ -56,10 +59,13 @@ public:
 class TFAsroValue : public TObject
 {
 protected:
-   UInt_t      fPos;          // position in asro - file
-   UInt_t      fFileLength;   // length in bytes in file (compressed);
-   UInt_t      fDataLength;   // length in bytes of data (uncompressed);
+   UInt_t      fPos;          // position in asro - file (lower 32 bits)
+   UInt_t      fFileLength;   // length in bytes in file (compressed, lower 32 bits);
+   UInt_t      fDataLength;   // length in bytes of data (uncompressed, lower 32 bits);
    UInt_t      fClassName;    // class name of this element
+   UInt_t      fPosHigh;        //! upper 32 bits of the position
+   UInt_t      fFileLengthHigh; //! upper 32 bits of the length in file
+   UInt_t      fDataLengthHigh; //! upper 32 bits of the length of data
 
 public:
    TFAsroValue();
@@ -68,16 +74,18 @@ public:
    TFAsroValue & operator = (const TFAsroValue & value);
 
    bool     operator < (const TFAsroValue & value) const
-               {return fPos < value.fPos;}
+               {return GetPos() < value.GetPos();}
 
-   UInt_t      GetPos()        const {return fPos;}
-   UInt_t      GetFileLength() const {return fFileLength;}
-   UInt_t      GetDataLength() const {return fDataLength;}
+   ULong64_t   GetPos()        const {return (ULong64_t)fPosHigh << 32 | fPos;}
+   ULong64_t   GetFileLength() const {return (ULong64_t)fFileLengthHigh << 32 | fFileLength;}
+   ULong64_t   GetDataLength() const {return (ULong64_t)fDataLengthHigh << 32 | fDataLength;}
    UInt_t      GetClassName()  const {return fClassName;}
 
-   void        SetPos(UInt_t pos)             {fPos = pos;}
-   void        SetFileLength(UInt_t length)   {fFileLength = length;}
-   void        SetDataLength(UInt_t length)   {fDataLength = length;}
+   void        SetPos(ULong64_t pos)          {fPos = (UInt_t)pos; fPosHigh = (UInt_t)(pos >> 32);}
+   void        SetFileLength(ULong64_t length)   
+                  {fFileLength = (UInt_t)length; fFileLengthHigh = (UInt_t)(length >> 32);}
+   void        SetDataLength(ULong64_t length)   
+                  {fDataLength = (UInt_t)length; fDataLengthHigh = (UInt_t)(length >> 32);}
    void        SetClassName(UInt_t className) {fClassName = className;}
 
 
@@ -134,13 +142,22 @@ protected:
    std::vector<TString>               fClassNames;
    std::vector<TString>               fNames;
 
-   UInt_t      fDes[4];       //! position, length of fEntries,
+   Int_t       fFormat;       //! format of the file: 1 (ASRO0001) or 2 (ASRO0002)
+   ULong64_t   fDes[4];       //! position, length of fEntries,
                               //! length of fFree and not used mem
-   UInt_t      fFreeReserve;  //! allocated memory for fFree;
-   UInt_t      * fFree;       //! array of (pos, length) of free mem in file
+   UInt_t      fFreeReserve;  //! allocated number of (pos, length) pairs in fFree
+   ULong64_t   * fFree;       //! array of (pos, length) of free mem in file
 
    int         fFile;         //! file handler;
    TString     fFileName;     //! file name of this file
+
+   char        * fMap;        //! memory mapped file, NULL if not mapped
+   size_t      fMapSize;      //! size of the mapped region
+   std::map<char *, std::pair<size_t, UInt_t> > fMapUsers; //! size and number of readers
+                              //! of the current and of older mappings in use
+   std::mutex  fMutex;        //! protects fEntries, the names and the mapping
+
+   static Bool_t fgMemoryMap; // kTRUE: elements are read from the mapped file
 public:
    TFAsroFile();
    TFAsroFile(const char * fileName, Bool_t * readOnly);
@@ -156,6 +173,7 @@ public:
    void         Map();
 
    Bool_t       IsOpen()      {return fFile >= 0;}
+   Int_t        GetFormat()   {return fFormat;}
    const char * GetFileName() {return fFileName.Data();}
 
    UInt_t       GetNumItems() {return fEntries.size();}
@@ -167,9 +185,20 @@ public:
    TFAsroElementIter *  MakeElementIter() 
                              {return new TFAsroElementIter(&fEntries);}
 
+   static void          SetMemoryMap(Bool_t map)  {fgMemoryMap = map;}
+   static Bool_t        GetMemoryMap()            {return fgMemoryMap;}
+
 protected:
-   UInt_t       GetFree(UInt_t size);
-   void         MakeFree(UInt_t pos, UInt_t size);
+   UInt_t       GetWordSize() const  {return fFormat == 1 ? sizeof(UInt_t) : sizeof(ULong64_t);}
+   ULong64_t    GetFree(ULong64_t size);
+   void         MakeFree(ULong64_t pos, ULong64_t size);
+   bool         ReadWords(ULong64_t * words, UInt_t num, ULong64_t pos);
+   bool         WriteWords(const ULong64_t * words, UInt_t num, ULong64_t pos);
+   bool         WriteDescriptor();
+   void         StreamDescriptor(TBuffer & buffer);
+   const char * MapRegion(ULong64_t pos, ULong64_t length, char *& map);
+   void         ReleaseMap(char * map);
+   TObject *    NewObject(const char * className, TBuffer & buffer);
 
    ClassDef(TFAsroFile, 1)      // internal class to store data in an ASRO file
 
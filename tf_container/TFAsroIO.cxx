@@ -18,6 +18,7 @@
 #include "TFTable.h"
 #include "TFColumn.h"
 #include "TFError.h"
+#include "TFParallel.h"
 
 // should be the same value as in TFAsrofile.cxx file
 #define MAX_UNIQUE_NAMES    0x7fffffff
@@ -310,21 +311,33 @@ TFBaseCol * TFAsroIO::ReadCol(const char * name)
 //_____________________________________________________________________________
 void TFAsroIO::ReadAllCol(ColList & columns)
 {
+// Reads all columns of the table which are not yet in columns. With the
+// implicit multi-threading of ROOT enabled the columns are read,
+// uncompressed and streamed in parallel, one task per column.
+
    if (fFile)
       {
+      // names of the columns to read
+      std::vector<TString> colNames;
       TFAsroColIter * i_col = fFile->MakeColIter(fElement->GetName(), fCycle);
       while(i_col->Next())
          {
          const char * colName = i_col->GetColName();
          TNamed name(colName, "");
          if (columns.find(TFColWrapper(name)) == columns.end())
-            {
-            TFBaseCol * col = (TFBaseCol*)fFile->Read(fElement->GetName(), colName, fCycle);
-            if (col)
-               columns.insert(TFColWrapper(*col));
-            }
+            colNames.push_back(colName);
          }
       delete i_col;
+
+      std::vector<TFBaseCol *> cols(colNames.size(), (TFBaseCol*)NULL);
+      TFParallel::Foreach(colNames.size(), colNames.size(),
+                          [&](UInt_t col, UInt_t, UInt_t)
+                             {cols[col] = (TFBaseCol*)fFile->Read(fElement->GetName(), 
+                                                                  colNames[col].Data(), fCycle);});
+
+      for (UInt_t col = 0; col < cols.size(); col++)
+         if (cols[col])
+            columns.insert(TFColWrapper(*cols[col]));
       }
 }
 //_____________________________________________________________________________
@@ -12,14 +12,14 @@
 #include "TFAsroFile.h"
 
 //_____________________________________________________________________________
-void MemTest(UInt_t prev, UInt_t pos)
+void MemTest(ULong64_t prev, ULong64_t pos)
 {
    if (prev < pos)
-      printf(" ===== lost memory from %u to %u  =====\n", 
+      printf(" ===== lost memory from %llu to %llu  =====\n", 
              prev, pos - 1);
 
    if (prev > pos)
-      printf(" +++++ memory used twice: from %u to %u +++++\n",
+      printf(" +++++ memory used twice: from %llu to %llu +++++\n",
               pos, prev -1);
 }
 //_____________________________________________________________________________
@@ -69,15 +69,15 @@ void TFAsroFile::Map()
    std::map<TFAsroValue,TFAsroKey>::iterator i_pos = posEntry.begin();
 
    UInt_t memIndex = 0;
-   UInt_t prevEnd  = 24;
-   UInt_t totalFree = 0;
+   ULong64_t prevEnd  = 8 + 4 * GetWordSize();
+   ULong64_t totalFree = 0;
    while (i_pos != posEntry.end())
       {
-      while (memIndex < fDes[2] / (2 * sizeof(UInt_t)) &&
+      while (memIndex < fDes[2] / (2 * GetWordSize()) &&
              fFree[memIndex * 2] < i_pos->first.GetPos())
          {
          MemTest(prevEnd, fFree[memIndex * 2]);
-         printf("%10u %10u %20s\n", 
+         printf("%10llu %10llu %20s\n", 
                 fFree[memIndex * 2], fFree[memIndex* 2 + 1],
                 "***  free  ***");
          prevEnd = fFree[memIndex * 2] + fFree[memIndex* 2 + 1];
@@ -104,7 +104,7 @@ void TFAsroFile::Map()
       else
          elName = fNames[i_pos->second.GetElName()].Data();
 
-      printf("%10u %10u %4.1f %20s %20s %3u %s\n",
+      printf("%10llu %10llu %4.1f %20s %20s %3u %s\n",
              i_pos->first.GetPos(), i_pos->first.GetFileLength(),
              (double)i_pos->first.GetDataLength() / i_pos->first.GetFileLength(),
              elName, i_pos->second.GetSubName(),
@@ -113,10 +113,10 @@ void TFAsroFile::Map()
       i_pos++;
       }
 
-   while (memIndex < fDes[2] / (2 * sizeof(UInt_t)))
+   while (memIndex < fDes[2] / (2 * GetWordSize()))
       {
       MemTest(prevEnd, fFree[memIndex * 2]);
-      printf("%10u %10u %20s\n", 
+      printf("%10llu %10llu %20s\n", 
                fFree[memIndex * 2], fFree[memIndex* 2 + 1],
                "***  free  ***");
       prevEnd = fFree[memIndex * 2] + fFree[memIndex* 2 + 1];
@@ -125,7 +125,7 @@ void TFAsroFile::Map()
 
    printf("\n\n number of classNames:  %d   number of element names: %d\n",
           fClassNames.size(), fNames.size());
-   printf("free memory in file: %u : %5.2f%%\n",
+   printf("free memory in file: %llu : %5.2f%%\n",
           totalFree,  double(totalFree) / fFree[(memIndex -1) * 2] * 100);
 
 
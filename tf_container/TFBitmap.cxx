@@ -0,0 +1,339 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFBitmap.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <iterator>
+#include <bitset>
+
+#include "TFBitmap.h"
+
+//_____________________________________________________________________________
+// TFBitmap:
+//    A compressed set of row numbers, organized like a Roaring bitmap:
+//    The rows are split into containers of 65536 rows by their upper
+//    16 bits. A container with up to kMaxArray rows stores the lower 16
+//    bits of its rows as a sorted array, a container with more rows as a
+//    bitmap of 65536 bits. The intersection And() and the union Or() of
+//    two bitmaps process one pair of containers after the other.
+//    It is used for the bitmap index of a column ( see
+//    TFBaseCol::BuildBitmapIndex() ) and by the filter of TFRowIter to
+//    combine the rows found with the indexes of several columns.
+
+static const UInt_t kWords = 65536 / 64;   // number of words of a bitmap container
+
+//_____________________________________________________________________________
+TFBitmap::Container & TFBitmap::GetContainer(UShort_t key)
+{
+// returns the container of key, creates a new one if it does not exist.
+// Rows are usually added in ascending order, check the last one first.
+
+   if (!fContainers.empty() && fContainers.back().fKey == key)
+      return fContainers.back();
+
+   std::vector<Container>::iterator i_cont = fContainers.begin();
+   if (!fContainers.empty() && fContainers.back().fKey < key)
+      i_cont = fContainers.end();
+   else
+      {
+      Container tmp;
+      tmp.fKey = key;
+      i_cont = std::lower_bound(fContainers.begin(), fContainers.end(), tmp,
+                                [](const Container & c1, const Container & c2)
+                                {return c1.fKey < c2.fKey;});
+      if (i_cont != fContainers.end() && i_cont->fKey == key)
+         return *i_cont;
+      }
+
+   Container cont;
+   cont.fKey  = key;
+   cont.fCard = 0;
+   return *fContainers.insert(i_cont, cont);
+}
+//_____________________________________________________________________________
+void TFBitmap::ToBits(Container & cont)
+{
+// converts an array container into a bitmap container
+
+   if (!cont.fBits.empty())
+      return;
+
+   cont.fBits.assign(kWords, 0);
+   for (size_t i = 0; i < cont.fArray.size(); i++)
+      cont.fBits[cont.fArray[i] >> 6] |= 1ULL << (cont.fArray[i] & 63);
+   std::vector<UShort_t>().swap(cont.fArray);
+}
+//_____________________________________________________________________________
+void TFBitmap::ToArray(Container & cont)
+{
+// converts a bitmap container into an array container
+
+   if (cont.fBits.empty())
+      return;
+
+   cont.fArray.clear();
+   cont.fArray.reserve(cont.fCard);
+   for (UInt_t word = 0; word < kWords; word++)
+      for (ULong64_t bits = cont.fBits[word]; bits != 0; bits &= bits - 1)
+         cont.fArray.push_back((UShort_t)(word * 64 +
+                               std::bitset<64>((bits & -bits) - 1).count()));
+   std::vector<ULong64_t>().swap(cont.fBits);
+}
+//_____________________________________________________________________________
+void TFBitmap::Add(UInt_t row)
+{
+// Adds one row. Adding the rows in ascending order is fastest.
+
+   Container & cont = GetContainer((UShort_t)(row >> 16));
+   UShort_t    low  = (UShort_t)row;
+
+   if (!cont.fBits.empty())
+      {
+      ULong64_t & word = cont.fBits[low >> 6];
+      ULong64_t   bit  = 1ULL << (low & 63);
+      cont.fCard += (word & bit) == 0;
+      word |= bit;
+      return;
+      }
+
+   if (cont.fArray.empty() || cont.fArray.back() < low)
+      cont.fArray.push_back(low);
+   else
+      {
+      std::vector<UShort_t>::iterator i_low =
+            std::lower_bound(cont.fArray.begin(), cont.fArray.end(), low);
+      if (*i_low == low)
+         return;
+      cont.fArray.insert(i_low, low);
+      }
+
+   cont.fCard++;
+   if (cont.fCard > kMaxArray)
+      ToBits(cont);
+}
+//_____________________________________________________________________________
+void TFBitmap::AddRange(UInt_t first, UInt_t last)
+{
+// Adds all rows from first to last, including both.
+
+   for (ULong64_t start = first; start <= last; start = (start | 0xffff) + 1)
+      {
+      UInt_t end = (UInt_t)std::min<ULong64_t>(start | 0xffff, last);
+
+      if (end - start + 1 <= kMaxArray)
+         {
+         for (ULong64_t row = start; row <= end; row++)
+            Add((UInt_t)row);
+         continue;
+         }
+
+      Container & cont = GetContainer((UShort_t)(start >> 16));
+      ToBits(cont);
+      for (UInt_t low = start & 0xffff; low <= (end & 0xffff); low++)
+         cont.fBits[low >> 6] |= 1ULL << (low & 63);
+
+      cont.fCard = 0;
+      for (UInt_t word = 0; word < kWords; word++)
+         cont.fCard += std::bitset<64>(cont.fBits[word]).count();
+      }
+}
+//_____________________________________________________________________________
+void TFBitmap::And(const TFBitmap & bitmap)
+{
+// Keeps only the rows which are also in bitmap.
+
+   std::vector<Container> result;
+
+   std::vector<Container>::iterator       i1 = fContainers.begin();
+   std::vector<Container>::const_iterator i2 = bitmap.fContainers.begin();
+   while (i1 != fContainers.end() && i2 != bitmap.fContainers.end())
+      {
+      if (i1->fKey < i2->fKey)
+         {
+         ++i1;
+         continue;
+         }
+      if (i2->fKey < i1->fKey)
+         {
+         ++i2;
+         continue;
+         }
+
+      Container & cont = *i1;
+      if (cont.fBits.empty() && i2->fBits.empty())
+         {
+         std::vector<UShort_t> array;
+         std::set_intersection(cont.fArray.begin(), cont.fArray.end(),
+                               i2->fArray.begin(), i2->fArray.end(),
+                               std::back_inserter(array));
+         cont.fArray.swap(array);
+         cont.fCard = cont.fArray.size();
+         }
+      else if (cont.fBits.empty())
+         {
+         // array and bitmap: keep the array entries with a set bit
+         std::vector<UShort_t>::iterator to = cont.fArray.begin();
+         for (size_t i = 0; i < cont.fArray.size(); i++)
+            if (i2->fBits[cont.fArray[i] >> 6] & (1ULL << (cont.fArray[i] & 63)))
+               *to++ = cont.fArray[i];
+         cont.fArray.erase(to, cont.fArray.end());
+         cont.fCard = cont.fArray.size();
+         }
+      else if (i2->fBits.empty())
+         {
+         std::vector<UShort_t> array;
+         for (size_t i = 0; i < i2->fArray.size(); i++)
+            if (cont.fBits[i2->fArray[i] >> 6] & (1ULL << (i2->fArray[i] & 63)))
+               array.push_back(i2->fArray[i]);
+         std::vector<ULong64_t>().swap(cont.fBits);
+         cont.fArray.swap(array);
+         cont.fCard = cont.fArray.size();
+         }
+      else
+         {
+         cont.fCard = 0;
+         for (UInt_t word = 0; word < kWords; word++)
+            {
+            cont.fBits[word] &= i2->fBits[word];
+            cont.fCard += std::bitset<64>(cont.fBits[word]).count();
+            }
+         if (cont.fCard <= kMaxArray)
+            ToArray(cont);
+         }
+
+      if (cont.fCard > 0)
+         {
+         result.push_back(Container());
+         std::swap(result.back(), cont);
+         }
+      ++i1;
+      ++i2;
+      }
+
+   fContainers.swap(result);
+}
+//_____________________________________________________________________________
+void TFBitmap::Or(const TFBitmap & bitmap)
+{
+// Adds all rows of bitmap.
+
+   std::vector<Container> result;
+   result.reserve(fContainers.size() + bitmap.fContainers.size());
+
+   std::vector<Container>::iterator       i1 = fContainers.begin();
+   std::vector<Container>::const_iterator i2 = bitmap.fContainers.begin();
+   while (i1 != fContainers.end() || i2 != bitmap.fContainers.end())
+      {
+      if (i2 == bitmap.fContainers.end() ||
+          (i1 != fContainers.end() && i1->fKey < i2->fKey))
+         {
+         result.push_back(Container());
+         std::swap(result.back(), *i1++);
+         continue;
+         }
+      if (i1 == fContainers.end() || i2->fKey < i1->fKey)
+         {
+         result.push_back(*i2++);
+         continue;
+         }
+
+      result.push_back(Container());
+      Container & cont = result.back();
+      std::swap(cont, *i1);
+
+      if (cont.fBits.empty() && i2->fBits.empty() &&
+          cont.fCard + i2->fCard <= kMaxArray)
+         {
+         std::vector<UShort_t> array;
+         std::set_union(cont.fArray.begin(), cont.fArray.end(),
+                        i2->fArray.begin(), i2->fArray.end(),
+                        std::back_inserter(array));
+         cont.fArray.swap(array);
+         cont.fCard = cont.fArray.size();
+         }
+      else
+         {
+         ToBits(cont);
+         if (i2->fBits.empty())
+            for (size_t i = 0; i < i2->fArray.size(); i++)
+               cont.fBits[i2->fArray[i] >> 6] |= 1ULL << (i2->fArray[i] & 63);
+         else
+            for (UInt_t word = 0; word < kWords; word++)
+               cont.fBits[word] |= i2->fBits[word];
+
+         cont.fCard = 0;
+         for (UInt_t word = 0; word < kWords; word++)
+            cont.fCard += std::bitset<64>(cont.fBits[word]).count();
+         if (cont.fCard <= kMaxArray)
+            ToArray(cont);
+         }
+      ++i1;
+      ++i2;
+      }
+
+   fContainers.swap(result);
+}
+//_____________________________________________________________________________
+Bool_t TFBitmap::Contains(UInt_t row) const
+{
+// Returns kTRUE if row is in this bitmap.
+
+   UShort_t key = (UShort_t)(row >> 16);
+   UShort_t low = (UShort_t)row;
+
+   for (std::vector<Container>::const_iterator i_cont = fContainers.begin();
+        i_cont != fContainers.end() && i_cont->fKey <= key; ++i_cont)
+      if (i_cont->fKey == key)
+         return i_cont->fBits.empty() ?
+                std::binary_search(i_cont->fArray.begin(), i_cont->fArray.end(), low) :
+                (i_cont->fBits[low >> 6] & (1ULL << (low & 63))) != 0;
+
+   return kFALSE;
+}
+//_____________________________________________________________________________
+ULong64_t TFBitmap::GetNumRows() const
+{
+// Returns the number of rows in this bitmap.
+
+   ULong64_t num = 0;
+   for (size_t i = 0; i < fContainers.size(); i++)
+      num += fContainers[i].fCard;
+   return num;
+}
+//_____________________________________________________________________________
+UInt_t TFBitmap::GetRows(UInt_t * rows) const
+{
+// Writes all rows in ascending order into rows, which must have space for
+// GetNumRows() rows. Returns the number of rows.
+
+   UInt_t num = 0;
+   for (size_t i = 0; i < fContainers.size(); i++)
+      {
+      const Container & cont = fContainers[i];
+      UInt_t high = (UInt_t)cont.fKey << 16;
+
+      if (cont.fBits.empty())
+         for (size_t n = 0; n < cont.fArray.size(); n++)
+            rows[num++] = high | cont.fArray[n];
+      else
+         for (UInt_t word = 0; word < kWords; word++)
+            for (ULong64_t bits = cont.fBits[word]; bits != 0; bits &= bits - 1)
+               rows[num++] = high | (word * 64 +
+                             (UInt_t)std::bitset<64>((bits & -bits) - 1).count());
+      }
+   return num;
+}
+//_____________________________________________________________________________
+void TFBitmap::GetRows(std::vector<UInt_t> & rows) const
+{
+// Sets rows to all rows of this bitmap in ascending order.
+
+   rows.resize(GetNumRows());
+   if (!rows.empty())
+      GetRows(&rows[0]);
+}
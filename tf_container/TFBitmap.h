@@ -0,0 +1,58 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFBitmap.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFBitmap
+#define ROOT_TFBitmap
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <vector>
+
+
+//_____________________________________________________________________________
+
+class TFBitmap
+{
+public:
+   enum {kMaxArray = 4096};   // max. number of rows of a container stored as array
+
+private:
+   struct Container
+      {
+      UShort_t                fKey;    // the upper 16 bits of the rows
+      UInt_t                  fCard;   // number of rows in this container
+      std::vector<UShort_t>   fArray;  // sorted lower 16 bits of the rows if fBits is empty
+      std::vector<ULong64_t>  fBits;   // bitmap of the lower 16 bits, 1024 words, or empty
+      };
+
+   std::vector<Container>  fContainers;   // the containers in ascending order of fKey
+
+   Container &  GetContainer(UShort_t key);
+   static void  ToBits(Container & cont);
+   static void  ToArray(Container & cont);
+
+public:
+   TFBitmap()     {}
+
+   void        Clear()                 {fContainers.clear();}
+   void        Add(UInt_t row);
+   void        AddRange(UInt_t first, UInt_t last);
+   void        And(const TFBitmap & bitmap);
+   void        Or(const TFBitmap & bitmap);
+
+   Bool_t      Contains(UInt_t row) const;
+   Bool_t      IsEmpty() const         {return fContainers.empty();}
+   ULong64_t   GetNumRows() const;
+   UInt_t      GetRows(UInt_t * rows) const;
+   void        GetRows(std::vector<UInt_t> & rows) const;
+};
+
+#endif
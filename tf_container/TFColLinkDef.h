@@ -16,7 +16,7 @@
 #pragma link off all functions;
 
 #pragma link C++ class TFSetDbl;
-#pragma link C++ class TFBaseCol+;
+#pragma link C++ class TFBaseCol-;
 #pragma link C++ class TFColumn<Char_t, BoolCharFormat>+;
 #pragma link C++ class TFColumn<Char_t, CharFormat>+;
 #pragma link C++ class TFColumn<UChar_t, UCharFormat>+;
@@ -28,7 +28,10 @@
 #pragma link C++ class TFColumn<Double_t, DoubleFormat>+;
 #pragma link C++ class TFColumn<TString, StringFormat>+;
 #pragma link C++ class TFColumn<TFElementPtr, ElementPtrFormat>+;
-#pragma link C++ class TFStringCol+;
+#pragma link C++ class TFConstStringRef;
+#pragma link C++ class TFStringRef;
+#pragma link C++ class TFStringCol-;
+#pragma link C++ class TFDictStringCol-;
 
 #pragma link C++ class TFBinVector<Char_t>+;
 #pragma link C++ class TFBinVector<UChar_t>+;
@@ -39,15 +42,42 @@
 #pragma link C++ class TFBinVector<Float_t>+;
 #pragma link C++ class TFBinVector<Double_t>+;
 
-#pragma link C++ class TFArrColumn<Char_t,   BoolCharFormat>+;
-#pragma link C++ class TFArrColumn<Char_t,   CharFormat>+;
-#pragma link C++ class TFArrColumn<UChar_t,  UCharFormat>+;
-#pragma link C++ class TFArrColumn<Short_t,  ShortFormat>+;
-#pragma link C++ class TFArrColumn<UShort_t, UShortFormat>+;
-#pragma link C++ class TFArrColumn<Int_t,    IntFormat>+;
-#pragma link C++ class TFArrColumn<UInt_t,   UIntFormat>+;
-#pragma link C++ class TFArrColumn<Float_t,  FloatFormat>+;
-#pragma link C++ class TFArrColumn<Double_t, DoubleFormat>+;
+#pragma link C++ class TFArrRow<Char_t>;
+#pragma link C++ class TFArrRow<UChar_t>;
+#pragma link C++ class TFArrRow<Short_t>;
+#pragma link C++ class TFArrRow<UShort_t>;
+#pragma link C++ class TFArrRow<Int_t>;
+#pragma link C++ class TFArrRow<UInt_t>;
+#pragma link C++ class TFArrRow<Float_t>;
+#pragma link C++ class TFArrRow<Double_t>;
+#pragma link C++ class TFArrRow<const Char_t>;
+#pragma link C++ class TFArrRow<const UChar_t>;
+#pragma link C++ class TFArrRow<const Short_t>;
+#pragma link C++ class TFArrRow<const UShort_t>;
+#pragma link C++ class TFArrRow<const Int_t>;
+#pragma link C++ class TFArrRow<const UInt_t>;
+#pragma link C++ class TFArrRow<const Float_t>;
+#pragma link C++ class TFArrRow<const Double_t>;
+
+#pragma link C++ class TFArrColumn<Char_t,   BoolCharFormat>-;
+#pragma link C++ class TFArrColumn<Char_t,   CharFormat>-;
+#pragma link C++ class TFArrColumn<UChar_t,  UCharFormat>-;
+#pragma link C++ class TFArrColumn<Short_t,  ShortFormat>-;
+#pragma link C++ class TFArrColumn<UShort_t, UShortFormat>-;
+#pragma link C++ class TFArrColumn<Int_t,    IntFormat>-;
+#pragma link C++ class TFArrColumn<UInt_t,   UIntFormat>-;
+#pragma link C++ class TFArrColumn<Float_t,  FloatFormat>-;
+#pragma link C++ class TFArrColumn<Double_t, DoubleFormat>-;
+
+#pragma link C++ class TFVarArrColumn<Char_t,   BoolCharFormat>-;
+#pragma link C++ class TFVarArrColumn<Char_t,   CharFormat>-;
+#pragma link C++ class TFVarArrColumn<UChar_t,  UCharFormat>-;
+#pragma link C++ class TFVarArrColumn<Short_t,  ShortFormat>-;
+#pragma link C++ class TFVarArrColumn<UShort_t, UShortFormat>-;
+#pragma link C++ class TFVarArrColumn<Int_t,    IntFormat>-;
+#pragma link C++ class TFVarArrColumn<UInt_t,   UIntFormat>-;
+#pragma link C++ class TFVarArrColumn<Float_t,  FloatFormat>-;
+#pragma link C++ class TFVarArrColumn<Double_t, DoubleFormat>-;
 
 
 //#pragma link C++ typedef TFBoolCol;  
@@ -70,5 +100,15 @@
 #pragma link C++ typedef TFFloatArrCol; 
 #pragma link C++ typedef TFDoubleArrCol;
 
+#pragma link C++ typedef TFBoolVarArrCol;  
+#pragma link C++ typedef TFCharVarArrCol;  
+#pragma link C++ typedef TFUCharVarArrCol; 
+#pragma link C++ typedef TFShortVarArrCol; 
+#pragma link C++ typedef TFUShortVarArrCol;
+#pragma link C++ typedef TFIntVarArrCol;   
+#pragma link C++ typedef TFUIntVarArrCol;  
+#pragma link C++ typedef TFFloatVarArrCol; 
+#pragma link C++ typedef TFDoubleVarArrCol;
+
 
 #endif
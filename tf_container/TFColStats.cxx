@@ -0,0 +1,77 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFColStats.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+
+#include "TFColStats.h"
+
+//_____________________________________________________________________________
+// TFColStats:
+//    The statistics of all not NULL values of a column: the number of
+//    values and of NULL values, minimum, maximum, sum, mean, variance and
+//    optionally a histogram with equidistant bins.
+//    It is computed by TFBaseCol::GetStats() and cached by the column
+//    until the column is modified.
+//    Partial results of several chunks of a column can be computed in
+//    parallel and merged with Add().
+
+//_____________________________________________________________________________
+void TFColStats::Reset(UInt_t numHistBins, Double_t histMin, Double_t histMax)
+{
+// removes all values and defines the histogram. There is no histogram
+// if numHistBins is 0.
+
+   fCount   = 0;
+   fNumNull = 0;
+   fNumNaN  = 0;
+   fMin     = 0;
+   fMax     = 0;
+   fSum     = 0;
+   fM2      = 0;
+
+   fHisto.assign(numHistBins, 0);
+   fHistMin = histMin;
+   fHistMax = histMax;
+}
+//_____________________________________________________________________________
+void TFColStats::Add(const TFColStats & stats)
+{
+// Merges the statistics stats into this statistics. The variances are
+// combined with the formula of Chan et al., the histograms are added if
+// both have the same binning.
+
+   if (stats.fCount > 0)
+      {
+      if (fCount == 0)
+         {
+         fMin = stats.fMin;
+         fMax = stats.fMax;
+         fM2  = stats.fM2;
+         }
+      else
+         {
+         fMin = std::min(fMin, stats.fMin);
+         fMax = std::max(fMax, stats.fMax);
+
+         Double_t n1    = fCount;
+         Double_t n2    = stats.fCount;
+         Double_t delta = stats.fSum / n2 - fSum / n1;
+         fM2 += stats.fM2 + delta * delta * n1 * n2 / (n1 + n2);
+         }
+      fCount += stats.fCount;
+      fSum   += stats.fSum;
+      }
+
+   fNumNull += stats.fNumNull;
+   fNumNaN  += stats.fNumNaN;
+
+   if (!fHisto.empty() && stats.HasHisto(fHisto.size(), fHistMin, fHistMax))
+      for (size_t bin = 0; bin < fHisto.size(); bin++)
+         fHisto[bin] += stats.fHisto[bin];
+}
@@ -0,0 +1,134 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFColStats.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFColStats
+#define ROOT_TFColStats
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <cmath>
+#include <vector>
+
+
+//_____________________________________________________________________________
+
+class TFColStats
+{
+   ULong64_t   fCount;        // number of not NULL and not NaN values
+   ULong64_t   fNumNull;      // number of NULL values
+   ULong64_t   fNumNaN;       // number of NaN values
+   Double_t    fMin;          // minimum of all counted values
+   Double_t    fMax;          // maximum of all counted values
+   Double_t    fSum;          // sum of all counted values
+   Double_t    fM2;           // sum of the squared differences to the mean
+
+   std::vector<ULong64_t>  fHisto;    // the histogram, empty if not requested
+   Double_t    fHistMin;      // lower edge of the first histogram bin
+   Double_t    fHistMax;      // upper edge of the last histogram bin
+
+public:
+   TFColStats()      {Reset(0, 0, 0);}
+
+   void        Reset(UInt_t numHistBins, Double_t histMin, Double_t histMax);
+   void        Add(const TFColStats & stats);
+   void        SetNumNull(ULong64_t numNull)     {fNumNull = numNull;}
+
+   template <class T>
+   void        Fill(const T * values, ULong64_t num);
+
+   ULong64_t   GetCount() const      {return fCount;}
+   ULong64_t   GetNumNull() const    {return fNumNull;}
+   ULong64_t   GetNumNaN() const     {return fNumNaN;}
+   Double_t    GetMin() const        {return fMin;}
+   Double_t    GetMax() const        {return fMax;}
+   Double_t    GetSum() const        {return fSum;}
+   Double_t    GetMean() const       {return fCount > 0 ? fSum / fCount : 0;}
+   Double_t    GetVariance() const   {return fCount > 1 ? fM2 / (fCount - 1) : 0;}
+
+   Bool_t      HasHisto(UInt_t numBins, Double_t min, Double_t max) const
+                        {return fHisto.size() == numBins && fHistMin == min && fHistMax == max;}
+   const std::vector<ULong64_t> & GetHisto() const  {return fHisto;}
+   Double_t    GetHistMin() const    {return fHistMin;}
+   Double_t    GetHistMax() const    {return fHistMax;}
+};
+
+//_____________________________________________________________________________
+template <class T>
+void TFColStats::Fill(const T * values, ULong64_t num)
+{
+// Adds num values to the statistics. Every quantity is computed by its
+// own simple loop, which the compiler can vectorize. The variance is
+// computed with the mean of these values and merged with Add().
+// NaN values are not counted as values, but in GetNumNaN().
+
+   if (num == 0)
+      return;
+
+   // min and max start with the first value, which is not NaN
+   ULong64_t first = 0;
+   while (first < num && std::isnan((Double_t)values[first]))
+      first++;
+
+   TFColStats part;
+   if (first == num)
+      {
+      part.fNumNaN = num;
+      Add(part);
+      return;
+      }
+
+   ULong64_t count = 0;
+   Double_t  sum   = 0;
+   Double_t  min   = (Double_t)values[first];
+   Double_t  max   = (Double_t)values[first];
+   for (ULong64_t i = first; i < num; i++)
+      {
+      Double_t val = (Double_t)values[i];
+      Bool_t   isNum = !std::isnan(val);
+      count += isNum;
+      sum   += isNum ? val : 0;
+      min = isNum && val < min ? val : min;
+      max = isNum && val > max ? val : max;
+      }
+   part.fCount  = count;
+   part.fNumNaN = num - count;
+   part.fSum = sum;
+   part.fMin = min;
+   part.fMax = max;
+
+   Double_t mean = sum / count;
+   Double_t m2   = 0;
+   for (ULong64_t i = first; i < num; i++)
+      {
+      Double_t diff = (Double_t)values[i] - mean;
+      m2 += std::isnan(diff) ? 0 : diff * diff;
+      }
+   part.fM2 = m2;
+
+   Add(part);
+
+   if (!fHisto.empty() && fHistMax > fHistMin)
+      {
+      Double_t scale = fHisto.size() / (fHistMax - fHistMin);
+      for (ULong64_t i = 0; i < num; i++)
+         {
+         // a NaN value fails both comparisons
+         Double_t val = (Double_t)values[i];
+         if (val >= fHistMin && val < fHistMax)
+            {
+            ULong64_t bin = (ULong64_t)((val - fHistMin) * scale);
+            fHisto[bin < fHisto.size() ? bin : fHisto.size() - 1]++;
+            }
+         }
+      }
+}
+
+#endif
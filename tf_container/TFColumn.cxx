@@ -9,10 +9,17 @@
 //  History:   1.0   18.07.03  first released version
 //
 // ////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include <math.h>
 #include <algorithm>
+#include <limits>
+#include <bitset>
+#include "TBuffer.h"
 #include "TFError.h"
 #include "TFTable.h"
 #include "TFColumn.h"
+#include "TFParallel.h"
+#include "TFSort.h"
 
 #ifndef TF_CLASS_IMP
 #define TF_CLASS_IMP
@@ -21,8 +28,13 @@ ClassImp(TFNullIter)
 
 ClassImp2T(TFColumn, T, F)
 ClassImpT(TFBinVector, T)
+ClassImpT(TFArrRow, T)
 ClassImp2T(TFArrColumn, T, F)
+ClassImp2T(TFVarArrColumn, T, F)
+ClassImp(TFConstStringRef)
+ClassImp(TFStringRef)
 ClassImp(TFStringCol)
+ClassImp(TFDictStringCol)
 #endif    // TF_CLASS_IMP
 
 //_____________________________________________________________________________
@@ -30,12 +42,18 @@ ClassImp(TFStringCol)
 //    TFBaseCol is the abstract base class of all columns of the TFTable.
 //
 //    A column can have any number of rows. A cell per row can be a 
-//    vector of any number of elements (see TF*ArrCol). Variable bin size
-//    is implemented. All values of a column have the same data type. 
+//    vector of any number of elements (see TF*ArrCol). All rows of an
+//    array column have the same number of bins, the values of all rows
+//    are stored in one buffer (see TFArrColumn::GetDataArray() ).
+//    The rows of a variable length array column (see TF*VarArrCol) can 
+//    have different numbers of bins, all values are stored in one buffer 
+//    together with the offset of each row into this buffer.
+//    All values of a column have the same data type. 
 //    There are several derived template classes for different data types.
 // 
 //    A column has a name TNamed::fName and a unit TNamed::fTitle.
-//    Each cell can be a NULL value.
+//    Each cell can be a NULL value. The NULL values are kept in a bitmap
+//    with one bit per cell, they are streamed as a set of (row, bin) pairs.
 //    TFBaseCol is derived from TFHeader and therefor a column can 
 //    have attributes.
 //
@@ -44,6 +62,14 @@ ClassImp(TFStringCol)
 //    rows of all inserted columns can be changed. This ensured that all
 //    columns of a table have the same number of rows.  
 //
+//    operator[] of a non const column returns a proxy of the value (see
+//    TFValueRef), which invalidates the cached statistics and indexes of
+//    the column when the value is changed. Several threads can change 
+//    different rows of one column at the same time. The proxy must be
+//    cast to the type of the value when it is passed to a function with
+//    a variable number of arguments, for example 
+//    printf("%d", (Int_t)col[row]).
+//
 //
 // TFNullIter:
 //    TFNullIter is an iterator to retrieve all rows of a column which
@@ -53,18 +79,123 @@ ClassImp(TFStringCol)
 // TFStringCol:
 //    A "specialisation" of the template class TFColumn for TStrings
 //    This column can be used like all other columns.
+//    All characters of all strings are kept in one arena, each string
+//    is terminated by a 0. An offset and a length per row locates the
+//    string of the row. operator[] returns a TFStringRef, which can be
+//    assigned like a TString and converted to a TString or to a 
+//    std::string_view. operator[] of a const column returns a 
+//    TFConstStringRef, which cannot be assigned. A string which gets longer is appended to the
+//    arena, the arena is compacted when more than half of it is unused.
+//
+// TFDictStringCol:
+//    A string column for strings with only a few different values. Each
+//    string is stored once in a dictionary, a row keeps only the code of
+//    its string, the index into the dictionary. Comparisons with a
+//    constant in a filter and sorts are done with the codes. The column is 
+//    written as a string column into FITS files and TTrees. A TFStringCol
+//    can be converted with the constructor 
+//    TFDictStringCol(const TFStringCol &) and replaced in its table with
+//    TFTable::AddColumn(newColumn, kTRUE).
+
+//_____________________________________________________________________________
+// helper functions for the bitmap of the NULL values
+
+static inline ULong64_t GetBits64(const std::vector<ULong64_t> & bits, ULong64_t pos)
+{
+// returns the 64 bits of bits starting at bit pos. Bits behind the end
+// of bits are 0.
+
+   ULong64_t word  = pos >> 6;
+   UInt_t    shift = pos & 63;
+
+   ULong64_t val = word < bits.size() ? bits[word] >> shift : 0;
+   if (shift > 0 && word + 1 < bits.size())
+      val |= bits[word + 1] << (64 - shift);
+   return val;
+}
+//_____________________________________________________________________________
+static void CopyBits(std::vector<ULong64_t> & to, ULong64_t toPos,
+                     const std::vector<ULong64_t> & from, ULong64_t fromPos,
+                     ULong64_t num)
+{
+// ORs num bits of from, starting at bit fromPos, into to at bit toPos.
+// to has to be large enough.
+
+   while (num > 0)
+      {
+      UInt_t    n     = num < 64 ? num : 64;
+      ULong64_t val   = GetBits64(from, fromPos);
+      if (n < 64)
+         val &= (1ULL << n) - 1;
 
+      ULong64_t word  = toPos >> 6;
+      UInt_t    shift = toPos & 63;
+      to[word] |= val << shift;
+      if (shift > 0 && shift + n > 64)
+         to[word + 1] |= val >> (64 - shift);
+
+      toPos   += n;
+      fromPos += n;
+      num     -= n;
+      }
+}
+//_____________________________________________________________________________
+static ULong64_t CountBits(const std::vector<ULong64_t> & bits, ULong64_t from, ULong64_t to)
+{
+// returns the number of bits set in the range [from, to) of bits
+
+   ULong64_t num = 0;
+   for (ULong64_t pos = from; pos < to; pos += 64)
+      {
+      ULong64_t val = GetBits64(bits, pos);
+      if (to - pos < 64)
+         val &= (1ULL << (to - pos)) - 1;
+      num += std::bitset<64>(val).count();
+      }
+   return num;
+}
+//_____________________________________________________________________________
+static ULong64_t CountBits(const std::vector<ULong64_t> & bits)
+{
+   ULong64_t num = 0;
+   for (size_t word = 0; word < bits.size(); word++)
+      num += std::bitset<64>(bits[word]).count();
+   return num;
+}
+
+//_____________________________________________________________________________
+// the serial number of the last created column, see TFBaseCol::GetSerial()
+
+static std::atomic<ULong64_t> gColSerial(0);
+
+//_____________________________________________________________________________
 TFBaseCol::TFBaseCol()
 {
 // Don't use this constructor. A column should have a name.
 
+   fNullBins   = 1;
+   fNumNull    = 0;
+   fIndexWanted = kFALSE;
+   fBitmapsWanted = kFALSE;
+   fModCount   = 0;
+   fSerial     = ++gColSerial;
+   fUnsortedRow = 0;
+   InvalidateStats();
 }
 //_____________________________________________________________________________
 TFBaseCol::TFBaseCol (const TFBaseCol & col)
    : TNamed(col), TFHeader(col)
 {
 // Standard copy constructor.
-   fNull = col.fNull;
+   fNullBits   = col.fNullBits;
+   fNullBins   = col.fNullBins;
+   fNumNull    = col.fNumNull;
+   fIndexWanted = kFALSE;
+   fBitmapsWanted = kFALSE;
+   fModCount   = 0;
+   fSerial     = ++gColSerial;
+   fUnsortedRow = 0;
+   InvalidateStats();
 }
 //_____________________________________________________________________________
 TFBaseCol::TFBaseCol(const char * name)
@@ -73,6 +204,14 @@ TFBaseCol::TFBaseCol(const char * name)
 // TFBaseCol constructor. Never change the name after the column is inserted
 // into a table!
 
+   fNullBins   = 1;
+   fNumNull    = 0;
+   fIndexWanted = kFALSE;
+   fBitmapsWanted = kFALSE;
+   fModCount   = 0;
+   fSerial     = ++gColSerial;
+   fUnsortedRow = 0;
+   InvalidateStats();
 }
 //_____________________________________________________________________________
 TFBaseCol::TFBaseCol(const TString &name)
@@ -81,6 +220,14 @@ TFBaseCol::TFBaseCol(const TString &name)
 // TFBaseCol constructor. Never change the name after the column is inserted
 // into a table!
 
+   fNullBins   = 1;
+   fNumNull    = 0;
+   fIndexWanted = kFALSE;
+   fBitmapsWanted = kFALSE;
+   fModCount   = 0;
+   fSerial     = ++gColSerial;
+   fUnsortedRow = 0;
+   InvalidateStats();
 }
 //_____________________________________________________________________________
 TFBaseCol & TFBaseCol::operator = (const TFBaseCol & col)
@@ -91,17 +238,722 @@ TFBaseCol & TFBaseCol::operator = (const TFBaseCol & col)
       {
       TNamed::operator=(col);
       TFHeader::operator=(col);
-      fNull = col.fNull;
+      fNullBits   = col.fNullBits;
+      fNullBins   = col.fNullBins;
+      fNumNull    = col.fNumNull;
+      InvalidateStats();
       }
    return *this;
 }
 //_____________________________________________________________________________
 bool TFBaseCol::operator == (const TFHeader & col) const
 {
-   return IsA() == col.IsA()                 &&
-          fName == ((TFBaseCol&)col).fName   &&
-          TFHeader::operator==(col)          &&
-          fNull == ((TFBaseCol&)col).fNull;
+   if (IsA() != col.IsA()                 ||
+       fName != ((TFBaseCol&)col).fName   ||
+       !TFHeader::operator==(col)         ||
+       fNumNull != ((TFBaseCol&)col).fNumNull)
+      return false;
+
+   // the bitmaps of both columns may have a different layout,
+   // compare the positions of the NULL values
+   TFNullIter i1 = MakeNullIterator();
+   TFNullIter i2 = ((TFBaseCol&)col).MakeNullIterator();
+   while (i1.Next())
+      if (!i2.Next() || i1->Row() != i2->Row() || i1->Bin() != i2->Bin())
+         return false;
+
+   return true;
+}
+//_____________________________________________________________________________
+void TFBaseCol::ToDoubles(UInt_t begin, UInt_t end, Double_t * out) const
+{
+// Converts the values of the rows begin to end - 1 into doubles and
+// writes them into out. NULL values are converted like any other value.
+// TFColumn overwrites this function with a loop without a virtual 
+// function call per row.
+
+   for (UInt_t row = begin; row < end; row++)
+      *out++ = ToDouble(row);
+}
+//_____________________________________________________________________________
+const TFColStats & TFBaseCol::GetStats(UInt_t numHistBins, Double_t histMin,
+                                      Double_t histMax) const
+{
+// Returns the statistics of all not NULL values of this column: number of
+// values and NULL values, minimum, maximum, sum, mean and variance. 
+// If numHistBins is not 0 the statistics includes a histogram of numHistBins
+// bins between histMin and histMax.
+// The statistics is computed in parallel by the threads of the ROOT thread
+// pool and kept until the column is modified, further calls return the
+// cached result. The assignment of a value via operator[] invalidates the
+// statistics, values which are changed via the pointer of GetDataArray()
+// are not detected, call InvalidateStats() in this case.
+// Numbers are converted into Double_t, array columns use all bins of all 
+// rows, string columns use the value of ToDouble() of the strings.
+// The function can be called by several threads at the same time, as long
+// as no thread modifies the column.
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (fStatsValid && (numHistBins == 0 || fStats.HasHisto(numHistBins, histMin, histMax)))
+      return fStats;
+
+   UInt_t numRows   = GetNumRows();
+   UInt_t numChunks = TFParallel::GetNumChunks(numRows);
+
+   std::vector<TFColStats> parts(numChunks > 0 ? numChunks : 1);
+   TFParallel::Foreach(numRows, numChunks,
+         [&](UInt_t chunk, UInt_t begin, UInt_t end)
+         {
+            parts[chunk].Reset(numHistBins, histMin, histMax);
+            FillStats(parts[chunk], begin, end - begin);
+         });
+
+   fStats.Reset(numHistBins, histMin, histMax);
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      fStats.Add(parts[chunk]);
+   fStats.SetNumNull(fNumNull);
+   fStatsValid = kTRUE;
+
+   return fStats;
+}
+//_____________________________________________________________________________
+const std::vector<TFColStats> & TFBaseCol::GetZones() const
+{
+// Returns the zone map of this column: the statistics of every block of
+// kZoneRows rows, the last block may have less rows. The number of NULL
+// values of a block is the number of all NULL bins of its rows.
+// The filter of TFRowIter uses the minimum and maximum of the blocks to
+// skip blocks which cannot pass the filter. 
+// The zone map is computed in parallel the first time it is needed and
+// kept until the column is modified, like the statistics of GetStats().
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (fZonesValid)
+      return fZones;
+
+   UInt_t numRows   = GetNumRows();
+   UInt_t numBlocks = (numRows + kZoneRows - 1) / kZoneRows;
+   fZones.assign(numBlocks, TFColStats());
+
+   TFParallel::Foreach(numBlocks, TFParallel::GetNumChunks(numBlocks, 1),
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {
+            for (UInt_t block = begin; block < end; block++)
+               {
+               UInt_t firstRow = block * kZoneRows;
+               UInt_t num      = std::min((UInt_t)kZoneRows, numRows - firstRow);
+               FillStats(fZones[block], firstRow, num);
+               if (fNumNull > 0)
+                  fZones[block].SetNumNull(CountBits(fNullBits, 
+                                           (ULong64_t)firstRow * fNullBins,
+                                           (ULong64_t)(firstRow + num) * fNullBins));
+               }
+         });
+
+   fZonesValid = kTRUE;
+   return fZones;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::HasIndex() const
+{
+// Returns kTRUE if the rows of this column can be found with a binary
+// search by FindRows(). This is the case if the values of the column are
+// in ascending order without NaN values or if an index was requested 
+// with BuildIndex(). Only numerical columns with one value per row can
+// have an index.
+// Both, the test of the order and the index, are done the first time
+// they are needed and are kept until the column is modified, like the
+// statistics of GetStats().
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (fIndexState != kIndexUnknown)
+      return fIndexState == kIndexSorted || fIndexState == kIndexRows;
+
+   UInt_t numRows = GetNumRows();
+   fIndexState = kIndexNone;
+   if (!IsNumeric() || GetNumBins() != 1)
+      return kFALSE;
+
+   // test if the column is already sorted, this needs no extra memory.
+   // A column which was not sorted at the last test is usually still not
+   // sorted at the same row, this is tested first. NaN values fail the
+   // tests.
+   Bool_t sorted = !(fUnsortedRow > 0 && fUnsortedRow < numRows &&
+                     !(ToDouble(fUnsortedRow) >= ToDouble(fUnsortedRow - 1)));
+   if (sorted)
+      {
+      // every chunk stops at its first row which is not sorted
+      UInt_t numChunks = TFParallel::GetNumChunks(numRows);
+      std::vector<UInt_t> unsorted(numChunks > 0 ? numChunks : 1, numRows);
+      TFParallel::Foreach(numRows, numChunks,
+            [&](UInt_t chunk, UInt_t begin, UInt_t end)
+            {
+               Double_t prev = begin > 0 ? ToDouble(begin - 1) 
+                                         : -std::numeric_limits<Double_t>::infinity();
+               Double_t buffer[1024];
+               for (UInt_t row = begin; row < end; row += 1024)
+                  {
+                  UInt_t num = std::min(1024u, end - row);
+                  ToDoubles(row, row + num, buffer);
+                  for (UInt_t i = 0; i < num; i++)
+                     {
+                     if (!(buffer[i] >= prev))
+                        {
+                        unsorted[chunk] = row + i;
+                        return;
+                        }
+                     prev = buffer[i];
+                     }
+                  }
+            });
+
+      for (UInt_t chunk = 0; chunk < unsorted.size() && sorted; chunk++)
+         if (unsorted[chunk] < numRows)
+            {
+            fUnsortedRow = unsorted[chunk];
+            sorted = kFALSE;
+            }
+      }
+
+   if (sorted)
+      {
+      std::vector<UInt_t>().swap(fIndex);
+      fIndexState = kIndexSorted;
+      fIndexBegin = 0;
+      fIndexEnd   = numRows;
+      return kTRUE;
+      }
+
+   if (!fIndexWanted)
+      return kFALSE;
+
+   // the permutation of the rows, NaN values are sorted to both ends
+   fIndex.resize(numRows);
+   for (UInt_t row = 0; row < numRows; row++)
+      fIndex[row] = row;
+   TFSort::SortRows(*this, 0, kTRUE, numRows > 0 ? &fIndex[0] : NULL, numRows);
+
+   fIndexBegin = 0;
+   fIndexEnd   = numRows;
+   while (fIndexBegin < fIndexEnd && std::isnan(ToDouble(fIndex[fIndexBegin])))
+      fIndexBegin++;
+   while (fIndexEnd > fIndexBegin && std::isnan(ToDouble(fIndex[fIndexEnd - 1])))
+      fIndexEnd--;
+
+   fIndexState = kIndexRows;
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::IsSorted() const
+{
+// Returns kTRUE if the values of this column are in ascending order. 
+// NaN values are not sorted.
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   return HasIndex() && fIndexState == kIndexSorted;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::BuildIndex() const
+{
+// Requests a sorted index of the rows of this column. The index is a 
+// permutation of the row numbers in ascending order of the values. It is
+// not needed, and not built, if the column is already sorted. 
+// The filter of TFRowIter and TFRowIter::Sort() use the index 
+// automatically. A modification of the column invalidates the index, it
+// is built again the next time it is needed until DropIndex() is called.
+// Returns kFALSE if this column cannot have an index, see HasIndex().
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   fIndexWanted = kTRUE;
+   if (fIndexState == kIndexNone)
+      fIndexState = kIndexUnknown;
+
+   return HasIndex();
+}
+//_____________________________________________________________________________
+void TFBaseCol::DropIndex() const
+{
+// Deletes the index of BuildIndex() and releases its memory.
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   fIndexWanted = kFALSE;
+   std::vector<UInt_t>().swap(fIndex);
+   if (fIndexState == kIndexRows)
+      fIndexState = kIndexUnknown;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::GetIndexRows(UInt_t * rows) const
+{
+// Copies all row numbers in ascending order of their values into rows,
+// which must have space for GetNumRows() rows. The order is the same as
+// the order of TFRowIter::Sort(): NaN values with the sign bit are the 
+// first rows, other NaN values the last rows. 
+// Returns kFALSE and does not change rows if the column has no index.
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (!HasIndex())
+      return kFALSE;
+
+   if (fIndexState == kIndexSorted)
+      for (UInt_t row = 0; row < fIndexEnd; row++)
+         rows[row] = row;
+   else if (!fIndex.empty())
+      memcpy(rows, &fIndex[0], fIndex.size() * sizeof(UInt_t));
+
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::FindRows(Double_t min, Double_t max, std::vector<UInt_t> & rows) const
+{
+// Sets rows to all rows with a value between min and max, including
+// both limits, in ascending order of the row numbers. The rows are found
+// with a binary search in O(log(n)) steps if the column HasIndex().
+// NULL values are not skipped, they are found with the value of the 
+// column.
+// Returns kFALSE and does not change rows if the column has no index.
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (!HasIndex())
+      return kFALSE;
+
+   UInt_t begin, end;
+   FindIndexRange(min, max, begin, end);
+
+   rows.clear();
+   if (fIndexState == kIndexSorted)
+      {
+      rows.resize(end - begin);
+      for (UInt_t i = begin; i < end; i++)
+         rows[i - begin] = i;
+      }
+   else
+      {
+      rows.assign(fIndex.begin() + begin, fIndex.begin() + end);
+      std::sort(rows.begin(), rows.end());
+      }
+
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::FindRowRange(Double_t min, Double_t max, UInt_t & begin, UInt_t & end) const
+{
+// Sets begin to the first row and end to the last row + 1 with a value 
+// between min and max, including both limits, if the values of the column 
+// are in ascending order (IsSorted()). begin and end are equal if no row 
+// has such a value. The rows are found with a binary search, without 
+// allocating a list of the rows like FindRows().
+// Returns kFALSE and does not change begin and end if the column is not
+// sorted.
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (!IsSorted())
+      return kFALSE;
+
+   FindIndexRange(min, max, begin, end);
+   return kTRUE;
+}
+//_____________________________________________________________________________
+void TFBaseCol::FindIndexRange(Double_t min, Double_t max, UInt_t & begin, UInt_t & end) const
+{
+// sets begin to the first and end to the last + 1 entry of the index with 
+// a value between min and max. The column must have an index and 
+// fCacheMutex must be locked.
+
+   // the value of entry i of the index
+   auto value = [this](UInt_t i) -> Double_t
+                {return ToDouble(fIndexState == kIndexSorted ? i : fIndex[i]);};
+
+   // first entry with a value >= min
+   UInt_t lo = fIndexBegin, hi = fIndexEnd;
+   while (lo < hi)
+      {
+      UInt_t mid = lo + (hi - lo) / 2;
+      if (value(mid) < min)
+         lo = mid + 1;
+      else
+         hi = mid;
+      }
+   begin = lo;
+
+   // first entry with a value > max
+   hi = fIndexEnd;
+   while (lo < hi)
+      {
+      UInt_t mid = lo + (hi - lo) / 2;
+      if (value(mid) <= max)
+         lo = mid + 1;
+      else
+         hi = mid;
+      }
+   end = lo;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::HasBitmapIndex() const
+{
+// Returns kTRUE if this column has a bitmap index, see BuildBitmapIndex().
+// The bitmaps are built the first time they are needed after a 
+// modification of the column, like the statistics of GetStats().
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (!fBitmapsWanted)
+      return kFALSE;
+   if (fBitmapsValid)
+      return kTRUE;
+
+   fBitmaps.clear();
+
+   UInt_t     numRows = GetNumRows();
+   Double_t   buffer[1024];
+   TFBitmap * bitmap  = NULL;
+   Long64_t   value   = 0;
+   for (UInt_t row = 0; row < numRows; row += 1024)
+      {
+      UInt_t num = std::min(1024u, numRows - row);
+      ToDoubles(row, row + num, buffer);
+      for (UInt_t i = 0; i < num; i++)
+         {
+         // flag columns have long runs of the same value
+         if (bitmap == NULL || (Long64_t)buffer[i] != value)
+            {
+            value  = (Long64_t)buffer[i];
+            bitmap = &fBitmaps[value];
+            }
+         bitmap->Add(row + i);
+         }
+
+      if (fBitmaps.size() > kMaxBitmaps)
+         {
+         // too many different values for a bitmap index
+         fBitmaps.clear();
+         fBitmapsWanted = kFALSE;
+         return kFALSE;
+         }
+      }
+
+   fBitmapsValid = kTRUE;
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::BuildBitmapIndex() const
+{
+// Requests a bitmap index of this column: a compressed bitmap ( see 
+// TFBitmap ) of the rows of every value of the column. It is intended for
+// columns with a few different values, like flag, status or CCD columns.
+// The filter of TFRowIter combines the bitmaps of comparisons of several
+// columns with bitmap AND and OR operations before the remaining rows 
+// are evaluated. 
+// The bitmaps are rebuilt the next time they are needed after the 
+// column was modified, until DropBitmapIndex() is called.
+// Returns kFALSE if the column is not an integer column or if it has more
+// than kMaxBitmaps different values.
+
+   if (!IsInteger() || GetNumBins() != 1)
+      return kFALSE;
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   fBitmapsWanted = kTRUE;
+   return HasBitmapIndex();
+}
+//_____________________________________________________________________________
+void TFBaseCol::DropBitmapIndex() const
+{
+// Deletes the bitmap index of BuildBitmapIndex().
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   fBitmapsWanted = kFALSE;
+   fBitmapsValid  = kFALSE;
+   fBitmaps.clear();
+}
+//_____________________________________________________________________________
+Bool_t TFBaseCol::FindBitmap(Double_t min, Double_t max, TFBitmap & rows) const
+{
+// Sets rows to all rows with a value between min and max, including both
+// limits. NULL values are not skipped, they are found with the value of 
+// the column.
+// Returns kFALSE and does not change rows if the column has no bitmap index.
+
+   std::lock_guard<std::recursive_mutex> lock(fCacheMutex);
+   if (!HasBitmapIndex())
+      return kFALSE;
+
+   rows.Clear();
+   if (!(ceil(min) <= floor(max)))
+      return kTRUE;
+
+   // the limits as integer values, the range may be larger than Long64_t
+   std::map<Long64_t, TFBitmap>::const_iterator i_begin = fBitmaps.begin();
+   std::map<Long64_t, TFBitmap>::const_iterator i_end   = fBitmaps.end();
+   if (min > -9.2e18)
+      i_begin = fBitmaps.lower_bound((Long64_t)ceil(min));
+   if (max <  9.2e18)
+      i_end   = fBitmaps.upper_bound((Long64_t)floor(max));
+
+   for (; i_begin != i_end; ++i_begin)
+      rows.Or(i_begin->second);
+
+   return kTRUE;
+}
+//_____________________________________________________________________________
+void TFBaseCol::CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows)
+{
+// Replaces all rows of this column by the rows of col: row i of this 
+// column gets the value of row rows[i] of col. A row can be copied 
+// several times. col must be a column of the same class as this column.
+// A row number not smaller than col.GetNumRows(), for example 
+// TF_MAX_ROWS, creates a row with the default value and with NULL values.
+// The header and the unit of col are copied, too. 
+// This function is used to create the columns of TFTable::Join(). The
+// derived columns copy their values and call this function to copy the 
+// NULL values.
+
+   TFHeader::operator=(col);
+   SetUnit(col.GetUnit());
+
+   ClearNulls();
+   UInt_t bins = GetNumBins() > 0 ? GetNumBins() : 1;
+   SetNullBins(std::max(bins, col.fNullBins));
+   for (UInt_t row = 0; row < numRows; row++)
+      {
+      if (rows[row] >= col.GetNumRows())
+         for (UInt_t bin = 0; bin < bins; bin++)
+            SetNull(row, bin);
+      else if (col.fNumNull > 0)
+         for (UInt_t bin = 0; bin < col.fNullBins; bin++)
+            if (col.IsNull(rows[row], bin))
+               SetNull(row, bin);
+      }
+
+   InvalidateStats();
+}
+//_____________________________________________________________________________
+void TFBaseCol::FillStats(TFColStats & stats, UInt_t firstRow, UInt_t numRows) const
+{
+// Adds the not NULL values of numRows rows starting at firstRow to stats.
+// This default converts the values with ToDoubles(), derived columns 
+// overwrite it to use their values directly.
+
+   Double_t buffer[1024];
+   for (UInt_t row = firstRow; row < firstRow + numRows; row += 1024)
+      {
+      UInt_t num = std::min(1024u, firstRow + numRows - row);
+      ToDoubles(row, row + num, buffer);
+      FillCells(stats, buffer, row, num, 1);
+      }
+}
+//_____________________________________________________________________________
+void TFBaseCol::Streamer(TBuffer & b)
+{
+// Stream an object of class TFBaseCol. The NULL values are written as the
+// set fNull of (row << 32) + bin, the same format as before the bitmap
+// of NULL values was introduced.
+
+   if (b.IsReading())
+      {
+      b.ReadClassBuffer(TFBaseCol::Class(), this);
+      InvalidateStats();
+
+      ClearNulls();
+      if (!fNull.empty())
+         SetNullBins((UInt_t)(*fNull.rbegin()) + 1);
+      for (std::set<ULong64_t>::const_iterator i_n = fNull.begin();
+           i_n != fNull.end(); i_n++)
+         SetNull((UInt_t)(*i_n >> 32), (UInt_t)(*i_n));
+      fNull.clear();
+      }
+   else
+      {
+      TFNullIter i_null = MakeNullIterator();
+      while (i_null.Next())
+         fNull.insert(fNull.end(), ((ULong64_t)i_null->Row() << 32) + i_null->Bin());
+
+      b.WriteClassBuffer(TFBaseCol::Class(), this);
+      fNull.clear();
+      }
+}
+//_____________________________________________________________________________
+void TFBaseCol::SetNullBins(UInt_t bins)
+{
+// Changes the layout of the NULL bitmap to bins bits per row.
+// The NULL values are not changed.
+
+   if (bins <= fNullBins)
+      return;
+
+   std::vector<ULong64_t> bits;
+   if (fNumNull > 0)
+      {
+      ULong64_t numRows = ((ULong64_t)fNullBits.size() * 64 + fNullBins - 1) / fNullBins;
+      bits.resize((numRows * bins + 63) / 64);
+
+      TFNullIter i_null = MakeNullIterator();
+      while (i_null.Next())
+         {
+         ULong64_t index = (ULong64_t)i_null->Row() * bins + i_null->Bin();
+         bits[index >> 6] |= 1ULL << (index & 63);
+         }
+      }
+
+   fNullBits.swap(bits);
+   fNullBins = bins;
+}
+//_____________________________________________________________________________
+void TFBaseCol::SetNull(UInt_t row, UInt_t bin)
+{
+// Marks the value of row and bin as NULL value.
+
+   if (bin >= fNullBins)
+      SetNullBins(std::max((Int_t)bin + 1, GetNumBins()));
+
+   ULong64_t index = (ULong64_t)row * fNullBins + bin;
+   if ((index >> 6) >= fNullBits.size())
+      fNullBits.resize((index >> 6) + 1);
+
+   ULong64_t & word = fNullBits[index >> 6];
+   ULong64_t   mask = 1ULL << (index & 63);
+   if ((word & mask) == 0)
+      {
+      word |= mask;
+      fNumNull++;
+      InvalidateStats();
+      }
+}
+//_____________________________________________________________________________
+void TFBaseCol::ClearNull(UInt_t row, UInt_t bin)
+{
+// The value of row and bin is not anymore a NULL value.
+
+   if (bin >= fNullBins)
+      return;
+
+   ULong64_t index = (ULong64_t)row * fNullBins + bin;
+   if ((index >> 6) >= fNullBits.size())
+      return;
+
+   ULong64_t & word = fNullBits[index >> 6];
+   ULong64_t   mask = 1ULL << (index & 63);
+   if (word & mask)
+      {
+      word &= ~mask;
+      fNumNull--;
+      InvalidateStats();
+      }
+}
+//_____________________________________________________________________________
+void TFBaseCol::ClearNulls()
+{
+// Removes all NULL values of this column.
+
+   if (fNumNull > 0)
+      InvalidateStats();
+   fNullBits.clear();
+   fNullBins = 1;
+   fNumNull  = 0;
+}
+//_____________________________________________________________________________
+void TFBaseCol::SetNulls(const char * mask, UInt_t firstRow, UInt_t numRows)
+{
+// Sets or clears the NULL values of numRows rows starting at firstRow.
+// mask has numRows * GetNumBins() entries, bin after bin of row after row.
+// A value is set to NULL if its entry in mask is not 0, otherwise it is
+// not anymore a NULL value.
+// This function is much faster than calling SetNull() for every value.
+// The column is only invalidated if a value is changed.
+
+   UInt_t bins = GetNumBins() > 0 ? GetNumBins() : 1;
+   ULong64_t num = (ULong64_t)numRows * bins;
+   if (num == 0)
+      return;
+
+   if (bins > fNullBins)
+      SetNullBins(bins);
+
+   if (bins == fNullBins)
+      {
+      // the mask has the layout of the bitmap: pack it word by word
+      ULong64_t pos = (ULong64_t)firstRow * bins;
+      ULong64_t end = pos + num;
+      if (((end - 1) >> 6) >= fNullBits.size())
+         {
+         // do not enlarge the bitmap if only not NULL values are set
+         ULong64_t index = num;
+         while (index > 0 && mask[index - 1] == 0)
+            index--;
+         if (index == 0)
+            {
+            ULong64_t numNull = fNumNull;
+            for (ULong64_t word = pos >> 6; word < fNullBits.size(); word++)
+               {
+               ULong64_t first = std::max(pos, word << 6) - (word << 6);
+               ULong64_t last  = std::min(end, (word + 1) << 6) - (word << 6);
+               ULong64_t bits  = (last - first == 64) ? ~0ULL :
+                                 (((1ULL << (last - first)) - 1) << first);
+               fNumNull -= std::bitset<64>(fNullBits[word] & bits).count();
+               fNullBits[word] &= ~bits;
+               }
+            if (fNumNull != numNull)
+               InvalidateStats();
+            return;
+            }
+         fNullBits.resize(std::max((ULong64_t)fNullBits.size(), ((end - 1) >> 6) + 1));
+         }
+
+      const char * m       = mask;
+      Bool_t       changed = kFALSE;
+      while (pos < end)
+         {
+         ULong64_t word  = pos >> 6;
+         UInt_t    first = pos & 63;
+         UInt_t    n     = (UInt_t)std::min((ULong64_t)(64 - first), end - pos);
+
+         ULong64_t val = 0;
+         for (UInt_t bit = 0; bit < n; bit++)
+            if (m[bit])
+               val |= 1ULL << (first + bit);
+         ULong64_t bits = (n == 64) ? ~0ULL : (((1ULL << n) - 1) << first);
+
+         fNumNull -= std::bitset<64>(fNullBits[word] & bits).count();
+         fNumNull += std::bitset<64>(val).count();
+         changed  |= (fNullBits[word] & bits) != val;
+         fNullBits[word] = (fNullBits[word] & ~bits) | val;
+
+         m   += n;
+         pos += n;
+         }
+      if (changed)
+         InvalidateStats();
+      }
+   else
+      {
+      // the column has less bins than the bitmap, the bins of the bitmap
+      // which the column does not have are not NULL values
+      for (UInt_t row = 0; row < numRows; row++)
+         {
+         for (UInt_t bin = 0; bin < bins; bin++)
+            if (mask[(ULong64_t)row * bins + bin])
+               SetNull(firstRow + row, bin);
+            else
+               ClearNull(firstRow + row, bin);
+         for (UInt_t bin = bins; bin < fNullBins; bin++)
+            ClearNull(firstRow + row, bin);
+         }
+      }
+}
+//_____________________________________________________________________________
+void TFBaseCol::GetNulls(char * mask, UInt_t firstRow, UInt_t numRows) const
+{
+// Fills mask with the NULL values of numRows rows starting at firstRow.
+// mask must have space for numRows * GetNumBins() entries, bin after bin
+// of row after row. An entry is 1 for a NULL value, otherwise 0.
+
+   UInt_t bins = GetNumBins() > 0 ? GetNumBins() : 1;
+   ULong64_t num = (ULong64_t)numRows * bins;
+   memset(mask, 0, num);
+   if (fNumNull == 0)
+      return;
+
+   for (UInt_t row = 0; row < numRows; row++)
+      for (UInt_t bin = 0; bin < bins && bin < fNullBins; bin++)
+         mask[(ULong64_t)row * bins + bin] = IsNull(firstRow + row, bin);
 }
 //_____________________________________________________________________________
 void TFBaseCol::InsertRows(UInt_t numRows, UInt_t pos)
@@ -110,18 +962,20 @@ void TFBaseCol::InsertRows(UInt_t numRows, UInt_t pos)
 // number of rows. Insert rows into a table while this column is part
 // of the table to insert rows into a column.
 
-   std::set <ULong64_t> tmp;
-   std::set <ULong64_t>::iterator i_n1, i_n2;
+   InvalidateStats();
+
+   ULong64_t posBit = (ULong64_t)pos * fNullBins;
+   if (fNumNull == 0 || posBit >= (ULong64_t)fNullBits.size() * 64)
+      return;
 
-   i_n1 = i_n2 = fNull.lower_bound((ULong64_t)pos << 32);
-   // copy all values >= pos into tmp and increase the value by numRows
-   for ( ;i_n1 != fNull.end(); i_n1++)
-      tmp.insert((*i_n1) + ((ULong64_t)numRows << 32));
-   
-   // delete all values >= pos and replace them by the increased values in tmp
-   fNull.erase(i_n2, fNull.end());
-   fNull.insert(tmp.begin(), tmp.end());
+   // move all bits of rows >= pos by numRows rows
+   ULong64_t numBits = (ULong64_t)fNullBits.size() * 64;
+   ULong64_t shift   = (ULong64_t)numRows * fNullBins;
+   std::vector<ULong64_t> bits((numBits + shift + 63) / 64);
+   CopyBits(bits, 0, fNullBits, 0, posBit);
+   CopyBits(bits, posBit + shift, fNullBits, posBit, numBits - posBit);
 
+   fNullBits.swap(bits);
 }
 //_____________________________________________________________________________
 void TFBaseCol::DeleteRows(UInt_t numRows, UInt_t pos)
@@ -130,21 +984,308 @@ void TFBaseCol::DeleteRows(UInt_t numRows, UInt_t pos)
 // number of rows. Delete rows of a table while this column is part
 // of the table to delete rows of a column.
 
-   std::set <ULong64_t> tmp;
-   std::set <ULong64_t>::iterator i_n1;
+   InvalidateStats();
+
+   ULong64_t posBit = (ULong64_t)pos * fNullBins;
+   ULong64_t numBits = (ULong64_t)fNullBits.size() * 64;
+   if (fNumNull == 0 || posBit >= numBits)
+      return;
+
+   // remove the bits of the deleted rows and move the bits behind them
+   ULong64_t endBit = std::min(posBit + (ULong64_t)numRows * fNullBins, numBits);
+   std::vector<ULong64_t> bits((numBits - (endBit - posBit) + 63) / 64);
+   CopyBits(bits, 0, fNullBits, 0, posBit);
+   CopyBits(bits, posBit, fNullBits, endBit, numBits - endBit);
+
+   fNullBits.swap(bits);
+   fNumNull = CountBits(fNullBits);
+}
+
+//_____________________________________________________________________________
+//_____________________________________________________________________________
+void TFStringCol::InitArena(UInt_t numRows)
+{
+// Removes all strings and sets numRows empty rows. The first character of
+// the arena is the 0 of all empty strings.
+
+   fChars.assign(1, 0);
+   fOffsets.assign(numRows, 0);
+   fLengths.assign(numRows, 0);
+   fUnused = 0;
+}
+//_____________________________________________________________________________
+TFStringCol & TFStringCol::operator = (const TFStringCol & col)
+{
+   if (&col != this)
+      {
+      TFBaseCol::operator=(col);
+      fChars   = col.fChars;
+      fOffsets = col.fOffsets;
+      fLengths = col.fLengths;
+      fUnused  = col.fUnused;
+      }
+   return *this;
+}
+//_____________________________________________________________________________
+bool TFStringCol::operator == (const TFHeader & col) const
+{
+// Two string columns are equal if they have the same strings, independent
+// of the layout of the strings in the arena.
+
+   if (!TFBaseCol::operator==(col) || IsA() != col.IsA())
+      return false;
+
+   const TFStringCol & strCol = (const TFStringCol &)col;
+   if (GetNumRows() != strCol.GetNumRows())
+      return false;
+
+   for (UInt_t row = 0; row < GetNumRows(); row++)
+      if (GetView(row) != strCol.GetView(row))
+         return false;
+
+   return true;
+}
+//_____________________________________________________________________________
+UInt_t TFStringCol::GetMaxLength() const
+{
+// returns the length of the longest string of this column
+
+   UInt_t maxLen = 0;
+   for (UInt_t row = 0; row < fLengths.size(); row++)
+      if (fLengths[row] > maxLen)
+         maxLen = fLengths[row];
+   return maxLen;
+}
+//_____________________________________________________________________________
+void TFStringCol::CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows)
+{
+// Replaces all rows of this column by the rows of col, see 
+// TFBaseCol::CopyRows(). The copied strings are stored without gaps.
+
+   const TFStringCol & strCol = (const TFStringCol &)col;
+
+   InitArena(numRows);
+   ULong64_t size = 1;
+   for (UInt_t row = 0; row < numRows; row++)
+      if (rows[row] < strCol.GetNumRows() && strCol.fLengths[rows[row]] > 0)
+         size += strCol.fLengths[rows[row]] + 1;
+   fChars.reserve(size);
+
+   for (UInt_t row = 0; row < numRows; row++)
+      {
+      if (rows[row] >= strCol.GetNumRows() || strCol.fLengths[rows[row]] == 0)
+         continue;
+      const char * str = strCol.GetData(rows[row]);
+      fOffsets[row] = fChars.size();
+      fLengths[row] = strCol.fLengths[rows[row]];
+      fChars.insert(fChars.end(), str, str + fLengths[row] + 1);
+      }
+
+   TFBaseCol::CopyRows(col, rows, numRows);
+}
+//_____________________________________________________________________________
+void TFStringCol::SetRow(UInt_t row, const char * str, UInt_t len)
+{
+// Sets the string of row to the first len characters of str, str does not
+// have to be 0 terminated. A string which is not longer than the previous
+// string of this row overwrites it, a longer string is appended to the 
+// arena. The arena is compacted if more than half of it is not used any
+// more.
+
+   InvalidateStats();
 
-   // copy all values >= (pos + numRows) into tmp and decrease the value
-   // by numRows
-   for (i_n1 = fNull.lower_bound((ULong64_t)(pos + numRows) << 32); 
-        i_n1 != fNull.end(); i_n1++)
-      tmp.insert((*i_n1) - ((ULong64_t)numRows << 32));
+   UInt_t oldLen = fLengths[row];
+
+   if (len == 0)
+      {
+      if (oldLen > 0)
+         fUnused += oldLen + 1;
+      fOffsets[row] = 0;
+      fLengths[row] = 0;
+      return;
+      }
+
+   if (len <= oldLen)
+      {
+      char * pos = &fChars[fOffsets[row]];
+      memmove(pos, str, len);
+      pos[len] = 0;
+      fUnused += oldLen - len;
+      fLengths[row] = len;
+      return;
+      }
 
-   // delete all values >= pos  and insert the decreased values of tmp
-   fNull.erase(fNull.lower_bound(pos), fNull.end());
-   fNull.insert(tmp.begin(), tmp.end());
+   // str may be a string of this column
+   Bool_t    inArena = str >= &fChars[0] && str < &fChars[0] + fChars.size();
+   ULong64_t from    = inArena ? str - &fChars[0] : 0;
+
+   if (!inArena && fUnused > 4096 && fUnused > fChars.size() / 2)
+      Compact();
+
+   if (oldLen > 0)
+      fUnused += oldLen + 1;
+
+   ULong64_t pos = fChars.size();
+   fChars.resize(pos + len + 1);
+   memcpy(&fChars[pos], inArena ? &fChars[from] : str, len);
+   fChars[pos + len] = 0;
+
+   fOffsets[row] = pos;
+   fLengths[row] = len;
 }
+//_____________________________________________________________________________
+char * TFStringCol::AllocStrings(UInt_t firstRow, UInt_t numRows, UInt_t size)
+{
+// Appends numRows fields of size characters, all 0, to the arena and
+// assigns them to the rows firstRow to firstRow + numRows - 1. Returns the
+// first field. This allows to read strings directly into the arena, for
+// example from a FITS file: The caller writes one 0 terminated string of
+// at most size - 1 characters into each field and has to call 
+// UpdateLengths() before the column is used again.
+
+   InvalidateStats();
+
+   for (UInt_t row = firstRow; row < firstRow + numRows; row++)
+      if (fLengths[row] > 0)
+         fUnused += fLengths[row] + 1;
+
+   ULong64_t pos = fChars.size();
+   fChars.resize(pos + (ULong64_t)numRows * size);
+   fUnused += (ULong64_t)numRows * size;
+
+   for (UInt_t row = 0; row < numRows; row++)
+      {
+      fOffsets[firstRow + row] = pos + (ULong64_t)row * size;
+      fLengths[firstRow + row] = 0;
+      }
 
+   return &fChars[pos];
+}
+//_____________________________________________________________________________
+void TFStringCol::UpdateLengths(UInt_t firstRow, UInt_t numRows)
+{
+// Sets the lengths of the strings written into the fields returned by
+// AllocStrings(). Trailing blanks are removed.
+
+   for (UInt_t row = firstRow; row < firstRow + numRows; row++)
+      {
+      char * str = &fChars[fOffsets[row]];
+      UInt_t len = strlen(str);
+      while (len > 0 && str[len - 1] == ' ')
+         str[--len] = 0;
+
+      if (len == 0)
+         fOffsets[row] = 0;
+      else
+         fUnused -= len + 1;
+      fLengths[row] = len;
+      }
+}
+//_____________________________________________________________________________
+void TFStringCol::Compact()
+{
+// Copies all strings row after row into a new arena without unused
+// characters. Pointers to strings and string_views of this column
+// are not valid any more.
+
+   if (fUnused == 0)
+      return;
+
+   std::vector<char> chars(fChars.size() - fUnused);
+   chars[0] = 0;
+   ULong64_t pos = 1;
+   for (UInt_t row = 0; row < fLengths.size(); row++)
+      if (fLengths[row] > 0)
+         {
+         memcpy(&chars[pos], &fChars[fOffsets[row]], fLengths[row] + 1);
+         fOffsets[row] = pos;
+         pos += fLengths[row] + 1;
+         }
+
+   fChars.swap(chars);
+   fUnused = 0;
+}
+//_____________________________________________________________________________
+char * TFStringCol::GetStringValue(UInt_t row, Int_t, char * str, Int_t width, 
+                                   const char * format) const
+{
+   if (width == 0)
+      sprintf(str, (format == NULL) ? "%s" : format, GetData(row));
+   else
+      sprintf(str, (format == NULL) ? "%*s" : format, width, GetData(row));
+   return str;
+}
 //_____________________________________________________________________________
+void TFStringCol::InsertRows(UInt_t numRows, UInt_t pos)
+{
+   fOffsets.insert(fOffsets.begin() + pos, numRows, 0);
+   fLengths.insert(fLengths.begin() + pos, numRows, 0);
+   TFBaseCol::InsertRows(numRows, pos);
+}
+//_____________________________________________________________________________
+void TFStringCol::DeleteRows(UInt_t numRows, UInt_t pos)
+{
+// The characters of the deleted strings stay in the arena until the next
+// Compact().
+
+   for (UInt_t row = pos; row < pos + numRows; row++)
+      if (fLengths[row] > 0)
+         fUnused += fLengths[row] + 1;
+
+   fOffsets.erase(fOffsets.begin() + pos, fOffsets.begin() + pos + numRows);
+   fLengths.erase(fLengths.begin() + pos, fLengths.begin() + pos + numRows);
+   TFBaseCol::DeleteRows(numRows, pos);
+
+   if (fLengths.empty())
+      InitArena(0);
+}
+//_____________________________________________________________________________
+Double_t TFStringCol::ToDouble(UInt_t row) const
+{
+   double d = 0;
+   const char * str = GetData(row);
+   if (str)
+      sscanf(str, "%lf", &d);
+   return d;
+}
+//_____________________________________________________________________________
+void TFStringCol::SetDouble(Double_t val, UInt_t row)
+{
+   TString str;
+   StringFormat::SetDouble(val, str);
+   SetRow(row, str.Data(), str.Length());
+}
+//_____________________________________________________________________________
+void TFStringCol::Streamer(TBuffer & b)
+{
+// Stream an object of class TFStringCol. The strings are streamed as 
+// vector of TString, the format of the first version of this class. In
+// memory all characters are kept in one arena.
+
+   if (b.IsReading())
+      {
+      b.ReadClassBuffer(TFStringCol::Class(), this);
+
+      ULong64_t numChars = 1;
+      for (UInt_t row = 0; row < fData.size(); row++)
+         numChars += fData[row].Length() + 1;
+
+      InitArena(fData.size());
+      fChars.reserve(numChars);
+      for (UInt_t row = 0; row < fData.size(); row++)
+         SetRow(row, fData[row].Data(), fData[row].Length());
+      std::vector<TString>().swap(fData);
+      }
+   else
+      {
+      fData.resize(GetNumRows());
+      for (UInt_t row = 0; row < GetNumRows(); row++)
+         fData[row] = TString(GetData(row), GetLength(row));
+
+      b.WriteClassBuffer(TFStringCol::Class(), this);
+      std::vector<TString>().swap(fData);
+      }
+}
 //_____________________________________________________________________________
 void TFStringCol::MakeBranch(TTree* tree, TFNameConvert * nameConvert) const
 {
@@ -161,10 +1302,7 @@ void TFStringCol::MakeBranch(TTree* tree, TFNameConvert * nameConvert) const
       }
    catch (TFException) {
       // we have to find the maximum size of the strings
-      fLength = 0;
-      for (UInt_t row = 0; row < fData.size(); row++)
-         if (fLength < fData[row].Length())
-            fLength = fData[row].Length();
+      fLength = GetMaxLength();
       }
 
    TFError::SetErrorType(errT);
@@ -185,16 +1323,192 @@ void * TFStringCol::GetStringBranchBuffer(UInt_t lenght)
 
    fLength = lenght;
    fCharBuffer = new char [fLength + 1];
+   fCharBuffer[0] = 0;
    return fCharBuffer;
 }
 //_____________________________________________________________________________
 void TFStringCol::FillBranchBuffer(UInt_t row) const
 {
-// Copies one string into the buffer to be filled into a tree.
+// Copies one string from the arena into the buffer to be filled into a
+// tree. This function  is called by TFTable::MakeTree() and is not designed
+// to be used directly by an application.
+
+   UInt_t len = GetLength(row) < fLength ? GetLength(row) : fLength;
+   memcpy(fCharBuffer, GetData(row), len);
+   fCharBuffer[len] = 0;
+}
+//_____________________________________________________________________________
+void TFDictStringCol::Streamer(TBuffer & b)
+{
+// Stream an object of class TFDictStringCol. The hash index of the 
+// dictionary is built after the column is read.
+
+   if (b.IsReading())
+      {
+      b.ReadClassBuffer(TFDictStringCol::Class(), this);
+      if (fDict.empty())
+         fDict.resize(1);
+      BuildCodeIndex();
+      }
+   else
+      b.WriteClassBuffer(TFDictStringCol::Class(), this);
+}
+//_____________________________________________________________________________
+TFDictStringCol::TFDictStringCol(const TFStringCol & column)
+   : TFBaseCol(column), fCodes(column.GetNumRows()), fDict(1)
+{
+// Creates a dictionary encoded copy of the string column column, including
+// the name, the unit, the attributes and the NULL values of column.
+
+   fCharBuffer = NULL;
+   BuildCodeIndex();
+   for (UInt_t row = 0; row < column.GetNumRows(); row++)
+      fCodes[row] = AddString(column.GetData(row));
+}
+//_____________________________________________________________________________
+TFDictStringCol & TFDictStringCol::operator = (const TFDictStringCol & col)
+{
+   if (&col != this)
+      {
+      TFBaseCol::operator=(col);
+      fCodes = col.fCodes;
+      fDict  = col.fDict;
+      fCodeIndex = col.fCodeIndex;
+      }
+   return *this;
+}
+//_____________________________________________________________________________
+bool TFDictStringCol::operator == (const TFHeader & col) const
+{
+// Two dictionary encoded columns are equal if they have the same strings,
+// independent of the codes of the strings.
+
+   if (!TFBaseCol::operator==(col) || IsA() != col.IsA())
+      return false;
+
+   const TFDictStringCol & dictCol = (const TFDictStringCol &)col;
+   if (GetNumRows() != dictCol.GetNumRows())
+      return false;
+
+   if (fDict == dictCol.fDict)
+      return fCodes == dictCol.fCodes;
+
+   for (UInt_t row = 0; row < GetNumRows(); row++)
+      if (GetView(row) != dictCol.GetView(row))
+         return false;
+
+   return true;
+}
+//_____________________________________________________________________________
+void TFDictStringCol::BuildCodeIndex()
+{
+// (Re)builds the hash index of the dictionary, for example after the
+// column was read from a file. The index is always up to date, therefore
+// FindCode() can be called at the same time from different threads.
+
+   fCodeIndex.clear();
+   fCodeIndex.reserve(fDict.size());
+   for (UInt_t code = 0; code < fDict.size(); code++)
+      fCodeIndex.insert(std::make_pair(std::string(fDict[code].Data(), fDict[code].Length()), code));
+}
+//_____________________________________________________________________________
+Int_t TFDictStringCol::FindCode(const char * str) const
+{
+// returns the code of str or -1 if str is not in the dictionary
+
+   std::unordered_map<std::string, UInt_t>::const_iterator i_code = fCodeIndex.find(str);
+   return i_code == fCodeIndex.end() ? -1 : (Int_t)i_code->second;
+}
+//_____________________________________________________________________________
+UInt_t TFDictStringCol::AddString(const char * str)
+{
+// returns the code of str. str is added to the dictionary if it is not
+// yet in it.
+
+   Int_t code = FindCode(str);
+   if (code >= 0)
+      return code;
+
+   fDict.push_back(str);
+   fCodeIndex.insert(std::make_pair(std::string(str), (UInt_t)fDict.size() - 1));
+   return fDict.size() - 1;
+}
+//_____________________________________________________________________________
+UInt_t TFDictStringCol::GetMaxLength() const
+{
+// returns the length of the longest string of the dictionary
+
+   UInt_t maxLen = 0;
+   for (UInt_t code = 0; code < fDict.size(); code++)
+      if ((UInt_t)fDict[code].Length() > maxLen)
+         maxLen = fDict[code].Length();
+   return maxLen;
+}
+//_____________________________________________________________________________
+void TFDictStringCol::CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows)
+{
+// Replaces all rows of this column by the rows of col, see 
+// TFBaseCol::CopyRows(). The dictionary of col is copied.
+
+   const TFDictStringCol & dictCol = (const TFDictStringCol &)col;
+
+   fDict  = dictCol.fDict;
+   fCodeIndex = dictCol.fCodeIndex;
+   fCodes.resize(numRows);
+   for (UInt_t row = 0; row < numRows; row++)
+      fCodes[row] = rows[row] < dictCol.fCodes.size() ? dictCol.fCodes[rows[row]] : 0;
+
+   TFBaseCol::CopyRows(col, rows, numRows);
+}
+//_____________________________________________________________________________
+void TFDictStringCol::InsertRows(UInt_t numRows, UInt_t pos)
+{
+// new rows have the empty string
+
+   fCodes.insert(fCodes.begin() + pos, numRows, AddString(""));
+   TFBaseCol::InsertRows(numRows, pos);
+}
+//_____________________________________________________________________________
+void TFDictStringCol::DeleteRows(UInt_t numRows, UInt_t pos)
+{
+   fCodes.erase(fCodes.begin() + pos, fCodes.begin() + pos + numRows);
+   TFBaseCol::DeleteRows(numRows, pos);
+}
+//_____________________________________________________________________________
+void TFDictStringCol::MakeBranch(TTree* tree, TFNameConvert * nameConvert) const
+{
+// Adds one string - branch to the tree, the same branch as of a 
+// TFStringCol.
 // This function  is called by TFTable::MakeTree() and is not designed to be
 // used directly by an application.
 
-   strncpy(fCharBuffer, fData[row].Data(), fLength);
-   fCharBuffer[fLength] = 0;
+   fLength = GetMaxLength();
+   fCharBuffer = new char [fLength + 1];
+
+   char branch[80];                                          
+   sprintf(branch, "%s[%d]/C", nameConvert->Conv(GetName()), fLength + 1);
+   tree->Branch(nameConvert->Conv(GetName()), fCharBuffer, (const char*)branch);
+}
+//_____________________________________________________________________________
+void * TFDictStringCol::GetStringBranchBuffer(UInt_t lenght)
+{  
+// allocates memory for the branch buffer depending on the maximum lenght
+// of a string = lenght and returens this buffer
+
+   fLength = lenght;
+   fCharBuffer = new char [fLength + 1];
+   fCharBuffer[0] = 0;
+   return fCharBuffer;
 }
+//_____________________________________________________________________________
+void TFDictStringCol::FillBranchBuffer(UInt_t row) const
+{
+// Copies one string of the dictionary into the buffer to be filled into a
+// tree. This function  is called by TFTable::MakeTree() and is not designed
+// to be used directly by an application.
 
+   const TString & str = fDict[fCodes[row]];
+   UInt_t len = (UInt_t)str.Length() < fLength ? str.Length() : fLength;
+   memcpy(fCharBuffer, str.Data(), len);
+   fCharBuffer[len] = 0;
+}
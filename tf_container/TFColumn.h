@@ -16,10 +16,20 @@
 #include "TTree.h"
 #endif
 
+#ifndef ROOT_TBuffer
+#include "TBuffer.h"
+#endif
+
+#ifndef ROOT_TLeaf
+#include "TLeaf.h"
+#endif
+
 #ifndef ROOT_TFHeader
 #include "TFHeader.h"
 #endif
 
+#include "ROOT/RVec.hxx"
+
 #ifndef ROOT_TFColWrapper
 #include "TFColWrapper.h"
 #endif
@@ -32,9 +42,28 @@
 #include "TFNameConvert.h"
 #endif
 
+#ifndef ROOT_TFColStats
+#include "TFColStats.h"
+#endif
+
+#ifndef ROOT_TFBitmap
+#include "TFBitmap.h"
+#endif
+
 
+#include <string.h>
 #include <vector>
 #include <set>
+#include <map>
+#include <string_view>
+#include <string>
+#include <unordered_map>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
 using namespace std;
 
@@ -44,6 +73,7 @@ class TFTable;
 template <class T, class F > class TFColumn;
 template <class T, class F > class TFArrColumn;
 class TFStringCol;
+class TFDictStringCol;
 
 //_____________________________________________________________________________
 
@@ -65,9 +95,41 @@ public:
 
 class TFBaseCol : public TNamed, public TFHeader
 {
+public:
+   enum {kZoneRows = 65536};       // number of rows of one block of the zone map
+   enum {kIndexUnknown, kIndexNone, kIndexSorted, kIndexRows};   // states of the index
+   enum {kMaxBitmaps = 1024};      // max. number of different values of a bitmap index
+
 protected:
-   set    <ULong64_t> fNull;   // set of (row,bins) which are NULL values
-   
+   set    <ULong64_t> fNull;       // set of (row,bins) which are NULL values, only used to stream the column
+   vector <ULong64_t> fNullBits;   //! bitmap of the NULL values, bit (row * fNullBins + bin)
+   UInt_t             fNullBins;   //! number of bins per row in fNullBits
+   ULong64_t          fNumNull;    //! number of NULL values in fNullBits
+   mutable TFColStats fStats;      //! cached statistics of the column
+   mutable std::atomic<Bool_t> fStatsValid; //! kTRUE if fStats is up to date
+   mutable std::vector<TFColStats> fZones;  //! statistics of each block of kZoneRows rows
+   mutable std::atomic<Bool_t> fZonesValid; //! kTRUE if fZones is up to date
+   mutable std::vector<UInt_t> fIndex;  //! rows in ascending order of their values
+   mutable std::atomic<Int_t> fIndexState; //! kIndexUnknown, kIndexNone, kIndexSorted or kIndexRows
+   mutable Bool_t     fIndexWanted;//! kTRUE if BuildIndex() was called
+   mutable UInt_t     fIndexBegin; //! first entry of the index which is not NaN
+   mutable UInt_t     fIndexEnd;   //! last entry + 1 of the index which is not NaN
+   mutable UInt_t     fUnsortedRow;//! row with a smaller value than its previous row at the last test
+   mutable std::map<Long64_t, TFBitmap> fBitmaps;  //! the rows of each value of the column
+   mutable std::atomic<Bool_t> fBitmapsValid;  //! kTRUE if fBitmaps is up to date
+   mutable Bool_t     fBitmapsWanted; //! kTRUE if BuildBitmapIndex() was called
+   std::atomic<ULong64_t> fModCount;   //! incremented at every modification of the column, not at reads
+           ULong64_t  fSerial;     //! unique number of this column object
+   mutable std::recursive_mutex fCacheMutex; //! protects the lazy computation of the statistics and indexes
+
+           void         SetNullBins(UInt_t bins);
+           void         FindIndexRange(Double_t min, Double_t max, UInt_t & begin, UInt_t & end) const;
+
+   virtual void         FillStats(TFColStats & stats, UInt_t firstRow, UInt_t numRows) const;
+   template <class T>
+           void         FillCells(TFColStats & stats, const T * values, UInt_t firstRow,
+                                  UInt_t numRows, UInt_t bins) const;
+
 public:
    TFBaseCol();
    TFBaseCol(const TFBaseCol & col);
@@ -81,12 +143,46 @@ public:
    virtual TFBaseCol    & operator = (const TFBaseCol & col);
    virtual bool         operator == (const TFHeader & col) const;
 
-   virtual Bool_t       IsNull(UInt_t row, UInt_t bin = 0) const   {return fNull.find(((ULong64_t)row << 32) + bin) != fNull.end();}
-   virtual void         SetNull(UInt_t row, UInt_t bin = 0)        {fNull.insert(((ULong64_t)row << 32) + bin);}
-   virtual void         ClearNull(UInt_t row, UInt_t bin = 0)      {fNull.erase(((ULong64_t)row << 32) + bin);}
-   virtual Bool_t       HasNull() const                            {return !fNull.empty();}
+   virtual Bool_t       IsNull(UInt_t row, UInt_t bin = 0) const;
+   virtual void         SetNull(UInt_t row, UInt_t bin = 0);
+   virtual void         ClearNull(UInt_t row, UInt_t bin = 0);
+   virtual Bool_t       HasNull() const                            {return fNumNull > 0;}
+           ULong64_t    GetNumNull() const                         {return fNumNull;}
+           void         SetNulls(const char * mask, UInt_t firstRow, UInt_t numRows);
+           void         GetNulls(char * mask, UInt_t firstRow, UInt_t numRows) const;
+           void         ClearNulls();
            TFNullIter   MakeNullIterator() const;
 
+   const TFColStats &   GetStats(UInt_t numHistBins = 0, Double_t histMin = 0,
+                                 Double_t histMax = 0) const;
+           void         InvalidateStats()
+                           {
+                              // several threads may write different rows at the same time
+                              fStatsValid.store(kFALSE, std::memory_order_relaxed);
+                              fZonesValid.store(kFALSE, std::memory_order_relaxed);
+                              fIndexState.store(kIndexUnknown, std::memory_order_relaxed);
+                              fBitmapsValid.store(kFALSE, std::memory_order_relaxed);
+                              fModCount.fetch_add(1, std::memory_order_relaxed);
+                           }
+           ULong64_t    GetModCount() const        {return fModCount.load(std::memory_order_relaxed);}
+           ULong64_t    GetSerial() const          {return fSerial;}
+   const std::vector<TFColStats> & GetZones() const;
+
+   virtual Bool_t       IsNumeric() const   {return kFALSE;}
+   virtual Bool_t       IsInteger() const   {return kFALSE;}
+           Bool_t       IsSorted() const;
+           Bool_t       BuildIndex() const;
+           void         DropIndex() const;
+           Bool_t       HasIndex() const;
+           Bool_t       FindRows(Double_t min, Double_t max, std::vector<UInt_t> & rows) const;
+           Bool_t       FindRowRange(Double_t min, Double_t max, UInt_t & begin, UInt_t & end) const;
+           Bool_t       GetIndexRows(UInt_t * rows) const;
+
+           Bool_t       BuildBitmapIndex() const;
+           void         DropBitmapIndex() const;
+           Bool_t       HasBitmapIndex() const;
+           Bool_t       FindBitmap(Double_t min, Double_t max, TFBitmap & rows) const;
+
    virtual int          CompareRows(UInt_t row1, UInt_t row2) const = 0;
    virtual Int_t        GetNumBins() const  {return 1;}
    virtual void         SetNumBins(UInt_t bins)             {}      // default does nothing
@@ -106,7 +202,12 @@ public:
    virtual void         FillBranchBuffer(UInt_t row) const = 0;
    virtual void         CopyBranchBuffer(UInt_t row) = 0;
    virtual void         ClearBranchBuffer() const = 0;
+   virtual void *       GetVarBranchBuffer(TLeaf * leaf)    {return NULL;}
+   virtual const void * GetBranchRows(void *& buffer, size_t & rowSize) const {return NULL;}
+
 
+   virtual void         ToDoubles(UInt_t begin, UInt_t end, Double_t * out) const;
+   virtual void         CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows);
 
            Double_t     operator[](UInt_t row) const      {return ToDouble(row);}
            TFSetDbl     operator[](UInt_t row)            {return TFSetDbl(this, row);}
@@ -121,6 +222,7 @@ public:
            operator     TFColumn<Float_t, FloatFormat>      & ();
            operator     TFColumn<Double_t, DoubleFormat>    & ();
            operator     TFStringCol                         & ();
+           operator     TFDictStringCol                     & ();
            operator     TFArrColumn<Char_t, BoolCharFormat> & ();
            operator     TFArrColumn<Char_t, CharFormat>     & ();
            operator     TFArrColumn<UChar_t, UCharFormat>   & ();
@@ -174,27 +276,30 @@ public:
 
 class TFNullIter
 {
-   std::set<ULong64_t>::const_iterator fIter;   // next NULL iterator of a column
-   std::set<ULong64_t>::const_iterator fBegin;  // first NULL iterator of a column
-   std::set<ULong64_t>::const_iterator fEnd;    // last NULL iterator of a column
-   TFNullIndex                    fNull;        // the actual row index of this iterator
+   const ULong64_t   * fBits;      // the NULL bitmap of a column
+   UInt_t            fNumWords;    // number of words in fBits
+   UInt_t            fBins;        // number of bins per row in fBits
+   UInt_t            fWord;        // index of the actual word in fBits
+   ULong64_t         fRest;        // not yet returned NULL bits of the actual word
+   TFNullIndex       fNull;        // the actual row index of this iterator
+
+   TFNullIter(const ULong64_t * bits, UInt_t numWords, UInt_t bins)
+         {fBits = bits; fNumWords = numWords; fBins = bins; Reset();}
+
+   static UInt_t  LowestBit(ULong64_t word);
 
-   TFNullIter(std::set<ULong64_t>::const_iterator begin,
-              std::set<ULong64_t>::const_iterator end) 
-         {fBegin = fIter = begin; fEnd = end;}
-                   
 public:
    TFNullIter(const TFNullIter & nullIter)
-      { fIter = nullIter.fIter;     fBegin = nullIter.fBegin;
-        fEnd  = nullIter.fEnd;      fNull  = nullIter.fNull; }
+      { fBits = nullIter.fBits;     fNumWords = nullIter.fNumWords;
+        fBins = nullIter.fBins;     fWord     = nullIter.fWord;
+        fRest = nullIter.fRest;     fNull     = nullIter.fNull; }
 
    TFNullIter & operator = (const TFNullIter & nullIter);
 
-   Bool_t         Next()         {if (fIter == fEnd) return kFALSE;
-                                  fNull = *fIter; ++fIter; return kTRUE;}
+   Bool_t         Next();
    TFNullIndex &  operator * ()  {return fNull;}
    TFNullIndex *  operator -> () {return &fNull;}
-   void           Reset()        {fIter = fBegin;}
+   void           Reset()        {fWord = 0; fRest = fNumWords > 0 ? fBits[0] : 0;}
 
 friend TFNullIter TFBaseCol::MakeNullIterator() const;
 
@@ -202,6 +307,71 @@ friend TFNullIter TFBaseCol::MakeNullIterator() const;
 
 };
 
+//_____________________________________________________________________________
+// a view of all values of a column, returned by GetSpan(). It is a 
+// std::span with C++20, a minimal span of a pointer and a size before.
+
+#if __cplusplus >= 202002L
+template <class T>
+   using TFSpan = std::span<T>;
+#else
+template <class T>
+   class TFSpan
+{
+   T         * fData;   // the first value
+   size_t      fSize;   // number of values
+
+public:
+   typedef T      element_type;
+   typedef T *    iterator;
+
+   TFSpan(T * data, size_t size) : fData(data), fSize(size) {}
+
+   T *      data() const                  {return fData;}
+   size_t   size() const                  {return fSize;}
+   bool     empty() const                 {return fSize == 0;}
+   T &      operator[](size_t i) const    {return fData[i];}
+   T *      begin() const                 {return fData;}
+   T *      end() const                   {return fData + fSize;}
+};
+#endif
+
+//_____________________________________________________________________________
+// one value of a non const column. It is read like a const T &, an
+// assignment of a different value invalidates the statistics and the
+// indexes of the column. Cast it to T when it is passed to a function
+// with a variable number of arguments like printf().
+
+template <class T>
+   class TFValueRef
+{
+   T           * fValue;   // the value in the column
+   TFBaseCol   * fCol;     // the column of the value
+
+public:
+   TFValueRef(T * value, TFBaseCol * col) : fValue(value), fCol(col) {}
+
+   operator const T & () const                        {return *fValue;}
+
+   TFValueRef & operator = (const T & val)            {Bool_t changed = !(*fValue == val); *fValue = val;
+                                                       if (changed) fCol->InvalidateStats();
+                                                       return *this;}
+   TFValueRef & operator = (const TFValueRef & ref)   {return *this = (const T &)ref;}
+   TFValueRef & operator += (const T & val)           {*fValue += val; fCol->InvalidateStats(); return *this;}
+   TFValueRef & operator -= (const T & val)           {*fValue -= val; fCol->InvalidateStats(); return *this;}
+   TFValueRef & operator *= (const T & val)           {*fValue *= val; fCol->InvalidateStats(); return *this;}
+   TFValueRef & operator /= (const T & val)           {*fValue /= val; fCol->InvalidateStats(); return *this;}
+   TFValueRef & operator ++ ()                        {++*fValue; fCol->InvalidateStats(); return *this;}
+   TFValueRef & operator -- ()                        {--*fValue; fCol->InvalidateStats(); return *this;}
+   T            operator ++ (int)                     {T val = (*fValue)++; fCol->InvalidateStats(); return val;}
+   T            operator -- (int)                     {T val = (*fValue)--; fCol->InvalidateStats(); return val;}
+
+   template <class U>
+   bool         operator == (const U & val) const     {return *fValue == val;}
+   template <class U>
+   bool         operator != (const U & val) const     {return !(*fValue == val);}
+};
+
 //_____________________________________________________________________________
 
 template <class T, class F = DefaultFormat<T> >
@@ -243,7 +413,40 @@ public:
 
 
    typename std::vector<T>::const_reference operator[](UInt_t row) const {return fData[row];}
-   typename std::vector<T>::reference       operator[](UInt_t row)       {return fData[row];}
+   TFValueRef<T>                            operator[](UInt_t row)       
+                                          {return TFValueRef<T>(&fData[row], this);}
+
+   // all values of the column, row after row. The pointer, the span and 
+   // the RVec use the memory of the column, they are valid until the 
+   // number of rows of the column is changed. A RVec cannot use the 
+   // memory of a const column without allowing to change it, the RVec of
+   // a const column is a copy of the values.
+   // Changes of the values through the pointer, the span or the RVec are
+   // not detected by the column, call InvalidateStats() after them.
+   T *          GetDataArray()            {return fData.empty() ? NULL : &fData[0];}
+   const T *    GetDataArray() const      {return fData.empty() ? NULL : &fData[0];}
+   TFSpan<T>            GetSpan()         {return TFSpan<T>(fData.data(), fData.size());}
+   TFSpan<const T>      GetSpan() const   {return TFSpan<const T>(fData.data(), fData.size());}
+   ROOT::RVec<T>        GetRVec()         {return ROOT::RVec<T>(fData.data(), fData.size());}
+   ROOT::RVec<T>        GetRVec() const   {return ROOT::RVec<T>(fData.begin(), fData.end());}
+
+   void    ToDoubles(UInt_t begin, UInt_t end, Double_t * out) const
+                  {
+                     const T * data = GetDataArray();
+                     for (UInt_t row = begin; row < end; row++)
+                        *out++ = F::ToDouble(data[row]);
+                  }
+   Bool_t  IsNumeric() const      {return std::is_arithmetic<T>::value;}
+   Bool_t  IsInteger() const      {return std::is_integral<T>::value;}
+
+   void    CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows)
+                  {
+                     const std::vector<T> & data = ((const TFColumn<T, F> &)col).fData;
+                     fData.resize(numRows);
+                     for (UInt_t row = 0; row < numRows; row++)
+                        fData[row] = rows[row] < data.size() ? data[rows[row]] : T();
+                     TFBaseCol::CopyRows(col, rows, numRows);
+                  }
 
 
    UInt_t  GetNumRows() const     {return fData.size();} 
@@ -254,7 +457,7 @@ public:
                                     const char * format = NULL) const
                            {return F::Format(str, width, format, fData[row]);}
    void    SetString(UInt_t row, Int_t bin, const char * str)
-                           {F::SetString(str, fData[row]); }
+                           {F::SetString(str, fData[row]); InvalidateStats();}
    const char * GetTypeName()  const   {return F::GetTypeName();}
    const char * GetColTypeName() const {return Class_Name();}
 
@@ -270,8 +473,17 @@ public:
 
    void *  GetBranchBuffer()                   {return &treeBuffer;}
    void    FillBranchBuffer(UInt_t row) const  {treeBuffer = fData[row];}
-   void    CopyBranchBuffer(UInt_t row)        {fData[row] = treeBuffer;}
+   void    CopyBranchBuffer(UInt_t row)        {fData[row] = treeBuffer; InvalidateStats();}
    void    ClearBranchBuffer() const {};
+   const void * GetBranchRows(void *& buffer, size_t & rowSize) const
+                  {
+                     // the rows can be copied with memcpy into the branch buffer
+                     if (!std::is_arithmetic<T>::value || !F::GetBranchType()[0] || fData.empty())
+                        return NULL;
+                     buffer  = &treeBuffer;
+                     rowSize = sizeof(T);
+                     return &fData[0];
+                  }
 
 
 protected:
@@ -286,42 +498,251 @@ protected:
                         }
 
    virtual Double_t     ToDouble(UInt_t row) const {return F::ToDouble(fData[row]);}
+   virtual void         FillStats(TFColStats & stats, UInt_t firstRow, UInt_t numRows) const
+                           {if constexpr (std::is_arithmetic<T>::value)
+                               FillCells(stats, GetDataArray() + firstRow, firstRow, numRows, 1);
+                            else
+                               TFBaseCol::FillStats(stats, firstRow, numRows);}
    virtual void         SetDouble(Double_t val, UInt_t row) {
-                                          T b; F::SetDouble(val, b); fData[row]= b;}
+                                          T b; F::SetDouble(val, b); fData[row]= b;
+                                          InvalidateStats();}
 
    ClassDef(TFColumn, 1) // A column of TFTable
 };
 
 
+//_____________________________________________________________________________
+
+class TFConstStringRef
+{
+protected:
+   const TFStringCol * fCol;     // the column of the string
+   UInt_t              fRow;     // the row of the string
+
+public:
+   TFConstStringRef(const TFStringCol * col, UInt_t row) : fCol(col), fRow(row) {}
+
+   const char *      Data() const;
+   Ssiz_t            Length() const;
+   std::string_view  View() const              {return std::string_view(Data(), Length());}
+
+   operator          std::string_view() const  {return View();}
+   operator          TString() const           {return TString(Data(), Length());}
+
+   Int_t             CompareTo(std::string_view str) const;
+   Int_t             CompareTo(const char * str) const     {return CompareTo(std::string_view(str));}
+   Int_t             CompareTo(const TString & str) const  
+                                       {return CompareTo(std::string_view(str.Data(), str.Length()));}
+   Int_t             CompareTo(const TFConstStringRef & str) const {return CompareTo(str.View());}
+
+   bool              operator == (const char * str) const  {return CompareTo(str) == 0;}
+   bool              operator != (const char * str) const  {return CompareTo(str) != 0;}
+
+   ClassDef(TFConstStringRef, 0) // internal class, one string of a const string column
+};
+
+//_____________________________________________________________________________
+
+class TFStringRef : public TFConstStringRef
+{
+   TFStringCol * fSetCol;  // the column of the string, to change the string
+
+public:
+   TFStringRef(TFStringCol * col, UInt_t row) : TFConstStringRef(col, row), fSetCol(col) {}
+
+   TFStringRef &     operator = (const char * str);
+   TFStringRef &     operator = (const TString & str);
+   TFStringRef &     operator = (std::string_view str);
+   TFStringRef &     operator = (const TFConstStringRef & str)  {return *this = str.View();}
+   TFStringRef &     operator = (const TFStringRef & str)       {return *this = str.View();}
+
+   ClassDef(TFStringRef, 0) // internal class, one string of a string column
+};
+
 //_____________________________________________________________________________
 
 class TFStringCol : public TFColumn<TString, StringFormat>
 {
+   std::vector <char>      fChars;      //! all characters of all strings, each string ends with a 0
+   std::vector <ULong64_t> fOffsets;    //! position of the string of each row in fChars
+   std::vector <UInt_t>    fLengths;    //! length of the string of each row
+   ULong64_t               fUnused;     //! number of characters in fChars not used by any row
+
    mutable char   * fCharBuffer;   //! buffer to fill a TTree
-   mutable UInt_t fLength;         //! max length of the TStrings
+   mutable UInt_t fLength;         //! max length of the strings
+
+   void    InitArena(UInt_t numRows);
+
+   // the strings are not kept in the vector of TFColumn
+   using TFColumn<TString, StringFormat>::GetDataArray;
+   using TFColumn<TString, StringFormat>::GetRVec;
+   using TFColumn<TString, StringFormat>::GetSpan;
 
 public:
-   TFStringCol() {}
+   TFStringCol() {fCharBuffer = NULL; InitArena(0);}
    TFStringCol(const char * name, int numRows = 0)
-      : TFColumn<TString, StringFormat>(name, numRows) {fCharBuffer = NULL;}
+      : TFColumn<TString, StringFormat>(name) {fCharBuffer = NULL; InitArena(numRows);}
    TFStringCol(const TString & name, int numRows = 0)
-      : TFColumn<TString, StringFormat>(name, numRows) {fCharBuffer = NULL;}
+      : TFColumn<TString, StringFormat>(name) {fCharBuffer = NULL; InitArena(numRows);}
    TFStringCol(const TFStringCol & column)
-      : TFColumn<TString, StringFormat>(column) {fCharBuffer = NULL;}
+      : TFColumn<TString, StringFormat>(column), 
+        fChars(column.fChars), fOffsets(column.fOffsets), fLengths(column.fLengths)
+      {fUnused = column.fUnused; fCharBuffer = NULL;}
 
+   virtual TObject * Clone(const char * name="") const {return new TFStringCol(*this);}
+
+   virtual TFStringCol & operator = (const TFStringCol & col);
+   virtual bool         operator == (const TFHeader & col) const;
+
+   int CompareRows(UInt_t row1, UInt_t row2) const
+      {return GetView(row1).compare(GetView(row2));}
+
+   TFConstStringRef  operator[](UInt_t row) const {return TFConstStringRef(this, row);}
+   TFStringRef       operator[](UInt_t row)       {return TFStringRef(this, row);}
+
+   // the 0 terminated string of a row. It is valid until the column 
+   // is changed the next time
+   const char *      GetData(UInt_t row) const    {return &fChars[fOffsets[row]];}
+   UInt_t            GetLength(UInt_t row) const  {return fLengths[row];}
+   std::string_view  GetView(UInt_t row) const    
+                              {return std::string_view(GetData(row), GetLength(row));}
+   UInt_t            GetMaxLength() const;
+
+   void              SetRow(UInt_t row, const char * str, UInt_t len);
+   void              ToDoubles(UInt_t begin, UInt_t end, Double_t * out) const
+                           {TFBaseCol::ToDoubles(begin, end, out);}
+   void              FillStats(TFColStats & stats, UInt_t firstRow, UInt_t numRows) const
+                           {TFBaseCol::FillStats(stats, firstRow, numRows);}
+   char *            AllocStrings(UInt_t firstRow, UInt_t numRows, UInt_t size);
+   void              UpdateLengths(UInt_t firstRow, UInt_t numRows);
+   void              Compact();
+   void              CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows);
+
+   UInt_t  GetNumRows() const     {return fLengths.size();} 
+   void    Reserve(UInt_t rows)   {fOffsets.reserve(rows); fLengths.reserve(rows);}
+
+   char *  GetStringValue(UInt_t row, Int_t bin, char * str, Int_t width = 0, 
+                                    const char * format = NULL) const;
+   void    SetString(UInt_t row, Int_t bin, const char * str)
+                           {SetRow(row, str, strlen(str));}
    const char * GetColTypeName() const {return Class_Name();}
+
    void    MakeBranch(TTree* tree, TFNameConvert * nameConvert) const;
-   void    CopyBranchBuffer(UInt_t row)        {fData[row] = fCharBuffer;}
+   void    CopyBranchBuffer(UInt_t row)   {SetRow(row, fCharBuffer, strnlen(fCharBuffer, fLength));}
    void *  GetStringBranchBuffer(UInt_t lenght);
    void    FillBranchBuffer(UInt_t row) const;
 
    void    ClearBranchBuffer() const {delete [] fCharBuffer; fCharBuffer = NULL;};
 
+protected:
+   virtual void     InsertRows(UInt_t numRows, UInt_t pos);
+   virtual void     DeleteRows(UInt_t numRows, UInt_t pos);
+
+   virtual Double_t ToDouble(UInt_t row) const;
+   virtual void     SetDouble(Double_t val, UInt_t row);
+
    ClassDef(TFStringCol, 1) // A column of TFTable for strings
 };
 
 //_____________________________________________________________________________
 
+class TFDictStringCol : public TFBaseCol
+{
+protected:
+   std::vector <UInt_t>    fCodes;      // code of the string of each row
+   std::vector <TString>   fDict;       // all different strings, the index is the code
+
+   std::unordered_map<std::string, UInt_t> fCodeIndex;  //! code of each string of fDict
+   mutable char   * fCharBuffer;   //! buffer to fill a TTree
+   mutable UInt_t fLength;         //! max length of the strings
+
+   void    BuildCodeIndex();
+
+public:
+   TFDictStringCol() : fDict(1) {fCharBuffer = NULL; BuildCodeIndex();}
+   TFDictStringCol(const char * name, int numRows = 0)
+      : TFBaseCol(name), fCodes(numRows), fDict(1) {fCharBuffer = NULL; BuildCodeIndex();}
+   TFDictStringCol(const TString & name, int numRows = 0)
+      : TFBaseCol(name), fCodes(numRows), fDict(1) {fCharBuffer = NULL; BuildCodeIndex();}
+   TFDictStringCol(const TFDictStringCol & column)
+      : TFBaseCol(column), fCodes(column.fCodes), fDict(column.fDict), fCodeIndex(column.fCodeIndex)
+      {fCharBuffer = NULL;}
+   TFDictStringCol(const TFStringCol & column);
+
+   virtual TObject * Clone(const char * name="") const {return new TFDictStringCol(*this);}
+
+   virtual TFDictStringCol & operator = (const TFDictStringCol & col);
+   virtual bool         operator == (const TFHeader & col) const;
+
+   int CompareRows(UInt_t row1, UInt_t row2) const
+      {return fCodes[row1] == fCodes[row2] ? 0 : GetView(row1).compare(GetView(row2));}
+
+   const TString &   operator[](UInt_t row) const {return fDict[fCodes[row]];}
+   const char *      GetData(UInt_t row) const    {return fDict[fCodes[row]].Data();}
+   std::string_view  GetView(UInt_t row) const    
+                           {const TString & str = fDict[fCodes[row]];
+                            return std::string_view(str.Data(), str.Length());}
+   UInt_t            GetMaxLength() const;
+   void              SetRow(UInt_t row, const char * str)  
+                           {fCodes[row] = AddString(str); InvalidateStats();}
+
+   // the codes of the rows and the dictionary of the strings
+   UInt_t            GetCode(UInt_t row) const    {return fCodes[row];}
+   void              SetCode(UInt_t row, UInt_t code)  {fCodes[row] = code; InvalidateStats();}
+   const UInt_t *    GetCodes() const     {return fCodes.empty() ? NULL : &fCodes[0];}
+   UInt_t            GetNumCodes() const          {return fDict.size();}
+   const TString &   GetCodeString(UInt_t code) const  {return fDict[code];}
+   Int_t             FindCode(const char * str) const;
+   UInt_t            AddString(const char * str);
+   void              CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows);
+
+   UInt_t  GetNumRows() const     {return fCodes.size();} 
+   size_t  GetWidth() const       {return sizeof(UInt_t);}
+   void    Reserve(UInt_t rows)   {fCodes.reserve(rows);}
+
+   char *  GetStringValue(UInt_t row, Int_t bin, char * str, Int_t width = 0, 
+                                    const char * format = NULL) const
+                           {return StringFormat::Format(str, width, format, fDict[fCodes[row]]);}
+   void    SetString(UInt_t row, Int_t bin, const char * str)  {SetRow(row, str);}
+   const char * GetTypeName()  const   {return StringFormat::GetTypeName();}
+   const char * GetColTypeName() const {return Class_Name();}
+
+   void    MakeBranch(TTree* tree, TFNameConvert * nameConvert) const;
+   void *  GetBranchBuffer()           {return fCharBuffer;}
+   void *  GetStringBranchBuffer(UInt_t lenght);
+   void    FillBranchBuffer(UInt_t row) const;
+   void    CopyBranchBuffer(UInt_t row)   {SetRow(row, fCharBuffer);}
+   void    ClearBranchBuffer() const {delete [] fCharBuffer; fCharBuffer = NULL;};
+
+protected:
+   virtual void     InsertRows(UInt_t numRows, UInt_t pos);
+   virtual void     DeleteRows(UInt_t numRows, UInt_t pos);
+
+   virtual Double_t ToDouble(UInt_t row) const 
+                           {return StringFormat::ToDouble(fDict[fCodes[row]]);}
+   virtual void     SetDouble(Double_t val, UInt_t row)
+                           {TString str; StringFormat::SetDouble(val, str); SetRow(row, str.Data());}
+
+   ClassDef(TFDictStringCol, 1) // A dictionary encoded column of TFTable for strings
+};
+
+//_____________________________________________________________________________
+
+inline const char * TFConstStringRef::Data() const  {return fCol->GetData(fRow);}
+inline Ssiz_t       TFConstStringRef::Length() const {return fCol->GetLength(fRow);}
+
+inline Int_t TFConstStringRef::CompareTo(std::string_view str) const  
+         {int comp = View().compare(str); return comp < 0 ? -1 : comp > 0 ? 1 : 0;}
+
+inline TFStringRef & TFStringRef::operator = (const char * str)
+         {fSetCol->SetRow(fRow, str, strlen(str)); return *this;}
+inline TFStringRef & TFStringRef::operator = (const TString & str)
+         {fSetCol->SetRow(fRow, str.Data(), str.Length()); return *this;}
+inline TFStringRef & TFStringRef::operator = (std::string_view str)
+         {fSetCol->SetRow(fRow, str.data(), str.size()); return *this;}
+
+//_____________________________________________________________________________
+
 template <class T>
    class TFBinVector
 {
@@ -349,26 +770,64 @@ public:
    ClassDef(TFBinVector, 1) // Internal class of an array column
 };
 
+//_____________________________________________________________________________
+// one row of an array column. The row of a const column is a TFArrRow<const T>,
+// its values cannot be changed. Changes of the values through data() are not
+// detected by the column, call InvalidateStats() of the column after them.
+
+template <class T>
+   class TFArrRow
+{
+   T        * fData;      // first bin of the row
+   Int_t    fBins;        // number of bins of the row
+
+   TFBaseCol * fCol;      // the column of the row, NULL for a TFArrRow<const T>
+
+public:
+   // the type of one value of a row which can be changed
+   typedef typename std::conditional<std::is_const<T>::value, 
+                                     const T &, TFValueRef<T> >::type reference;
+
+   TFArrRow() {fData = NULL; fBins = 0; fCol = NULL;}
+   TFArrRow(T * data, Int_t bins, TFBaseCol * col = NULL) 
+      : fData(data), fBins(bins), fCol(col) {}
+
+   Int_t       size() const                        {return fBins;}
+   T *         data()                              {return fData;}
+   const T *   data() const                        {return fData;}
+
+   reference   operator[](UInt_t bin)              {if constexpr (std::is_const<T>::value)
+                                                       return fData[bin];
+                                                    else
+                                                       return TFValueRef<T>(fData + bin, fCol);}
+   const T &   operator[](UInt_t bin) const        {return fData[bin];}
+
+   ClassDef(TFArrRow, 0) // internal class, one row of an array column
+};
+
 //_____________________________________________________________________________
 
 template <class T, class F = DefaultFormat<T> >
    class TFArrColumn : public TFBaseCol
 {
 protected:
-   std::vector <TFBinVector<T> > fData;  // all Data of this column
+   std::vector <TFBinVector<T> > fData;  // only used to read the version 1 of the column
 
    Int_t           fBins;                // number of bins per row
-                                         // < 0 : variable bin number
+   std::vector <T> fValues;              // all data of this column, row after row
+   UInt_t          fNumRows;             // number of rows
    mutable T *     treeBuffer;           //! buffer to fill a TTree
 
 public:
    typedef T value_type;
 
-   TFArrColumn() {fBins = 0; treeBuffer = NULL;}
+   TFArrColumn() {fBins = 0; fNumRows = 0; treeBuffer = NULL;}
    TFArrColumn(const char * name, int numRows = 0)
-      : TFBaseCol(name), fData(numRows) {fBins = 0; treeBuffer = NULL;}
+      : TFBaseCol(name) {fBins = 0; fNumRows = numRows; treeBuffer = NULL;}
    TFArrColumn(const TFArrColumn<T, F> & column)
-      {fData = column.fData; fBins = column.fBins; treeBuffer = NULL;}
+      : TFBaseCol(column)
+      {fValues = column.fValues; fBins = column.fBins; 
+       fNumRows = column.fNumRows; treeBuffer = NULL;}
 
 
    virtual TObject * Clone(const char * name="") const {return new TFArrColumn<T, F>(*this);}
@@ -376,8 +835,9 @@ public:
    virtual TFArrColumn<T, F> & operator = (const TFArrColumn<T, F> & col) {
                                             if (&col != this) {
                                               TFBaseCol::operator=(col);
-                                              fData = col.fData;
-                                              fBins = col.fBins;
+                                              fValues  = col.fValues;
+                                              fBins    = col.fBins;
+                                              fNumRows = col.fNumRows;
                                               }
                                             return *this;
                                             }
@@ -385,25 +845,46 @@ public:
                                         return TFBaseCol::operator==(col) &&
                                                IsA() == col.IsA() &&
                                                fBins == ((TFArrColumn<T, F>&)col).fBins &&
-                                               fData == ((TFArrColumn<T, F>&)col).fData;}  
+                                               fNumRows == ((TFArrColumn<T, F>&)col).fNumRows &&
+                                               fValues == ((TFArrColumn<T, F>&)col).fValues;}  
 
    int CompareRows(UInt_t row1, UInt_t row2) const
-      {return (fData[row1][0] < fData[row2][0]) ? -1 :
-              (fData[row2][0] < fData[row1][0]) ?  1 : 0;}
+      {if (fBins <= 0) return 0;
+       const T & v1 = fValues[(size_t)row1 * fBins];
+       const T & v2 = fValues[(size_t)row2 * fBins];
+       return (v1 < v2) ? -1 : (v2 < v1) ?  1 : 0;}
 
 
-   typename std::vector<TFBinVector<T> >::const_reference operator[](UInt_t row) const {return fData[row];}
-   typename std::vector<TFBinVector<T> >::reference       operator[](UInt_t row)       {return fData[row];}
+   TFArrRow<const T> operator[](UInt_t row) const 
+                     {return TFArrRow<const T>(GetDataArray() + (size_t)row * fBins, fBins);}
+   TFArrRow<T>       operator[](UInt_t row)
+                     {return TFArrRow<T>(GetDataArray() + (size_t)row * fBins, fBins, this);}
+
+   // all values of the column, bin after bin of row after row. Changes of 
+   // the values through the pointer are not detected by the column, call
+   // InvalidateStats() after them.
+   T *          GetDataArray()            {return fValues.empty() ? NULL : &fValues[0];}
+   const T *    GetDataArray() const      {return fValues.empty() ? NULL : &fValues[0];}
 
    Int_t        GetNumBins() const        {return fBins;}
-   void         SetNumBins(UInt_t bins)   {if (bins > 0) 
-                                             for (int row = 0; row < fData.size(); row++)
-                                                fData[row].resize(bins); 
-                                             fBins = bins;
-                                          }
+   void         SetNumBins(UInt_t bins);
 
-   void         Reserve(UInt_t rows)      {fData.reserve(rows);}
-   UInt_t       GetNumRows() const        {return fData.size();} 
+   void         CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows)
+                  {
+                     const TFArrColumn<T, F> & arr = (const TFArrColumn<T, F> &)col;
+                     fBins    = arr.fBins;
+                     fNumRows = numRows;
+                     fValues.assign((size_t)numRows * fBins, T());
+                     for (UInt_t row = 0; row < numRows; row++)
+                        if (rows[row] < arr.fNumRows)
+                           std::copy(arr.fValues.begin() + (size_t)rows[row] * fBins,
+                                     arr.fValues.begin() + (size_t)(rows[row] + 1) * fBins,
+                                     fValues.begin() + (size_t)row * fBins);
+                     TFBaseCol::CopyRows(col, rows, numRows);
+                  }
+
+   void         Reserve(UInt_t rows)      {fValues.reserve((size_t)rows * fBins);}
+   UInt_t       GetNumRows() const        {return fNumRows;} 
    size_t       GetWidth() const          {return sizeof(T);}
 
    const char * GetTypeName() const       {return F::GetTypeName();}
@@ -425,40 +906,187 @@ public:
    void    FillBranchBuffer(UInt_t row) const
                   {
                      if (F::GetBranchType()[0] && fBins > 0)
-                        {
-                        for (Int_t num = 0; num < fBins; num++)
-                           treeBuffer[num] = fData[row][num];
-                        }
+                        memcpy(treeBuffer, GetDataArray() + (size_t)row * fBins, fBins * sizeof(T));
                   }
    void    CopyBranchBuffer(UInt_t row)        
                   {
-                     for (Int_t num = 0; num < fBins; num++)
-                        fData[row][num] = treeBuffer[num];
+                     if (fBins > 0)
+                        memcpy(GetDataArray() + (size_t)row * fBins, treeBuffer, fBins * sizeof(T));
+                     InvalidateStats();
+                  }
+   const void * GetBranchRows(void *& buffer, size_t & rowSize) const
+                  {
+                     if (treeBuffer == NULL || fValues.empty())
+                        return NULL;
+                     buffer  = treeBuffer;
+                     rowSize = fBins * sizeof(T);
+                     return &fValues[0];
                   }
 
    void    ClearBranchBuffer() const {delete [] treeBuffer; treeBuffer = NULL;};
 
    char *  GetStringValue(UInt_t row, Int_t bin, char * str, Int_t width = 0, 
                                     const char * format = NULL) const
-                           {return F::Format(str, width, format, fData[row][bin]);}
+                           {return F::Format(str, width, format, fValues[(size_t)row * fBins + bin]);}
    void    SetString(UInt_t row, Int_t bin, const char * str)
-                           {F::SetString(str, fData[row][bin]); }
+                           {F::SetString(str, fValues[(size_t)row * fBins + bin]); InvalidateStats();}
 
 protected:
    virtual void     InsertRows(UInt_t numRows, UInt_t pos) {
-                        fData.insert(fData.begin() + pos, numRows, 
-                                     TFBinVector<T>(fBins >= 0 ? fBins : 0));
+                        fValues.insert(fValues.begin() + (size_t)pos * fBins, 
+                                       (size_t)numRows * fBins, T());
+                        fNumRows += numRows;
                         TFBaseCol::InsertRows(numRows, pos);
                         }
    virtual void     DeleteRows(UInt_t numRows, UInt_t pos) {
-                        fData.erase(fData.begin() + pos, fData.begin() + pos + numRows);
+                        fValues.erase(fValues.begin() + (size_t)pos * fBins, 
+                                      fValues.begin() + (size_t)(pos + numRows) * fBins);
+                        fNumRows -= numRows;
                         TFBaseCol::DeleteRows(numRows, pos);
                         }
 
    virtual Double_t     ToDouble(UInt_t row) const {return 0.0;}
    virtual void         SetDouble(Double_t val, UInt_t row)  {};
+   virtual void         FillStats(TFColStats & stats, UInt_t firstRow, UInt_t numRows) const
+                           {if (fBins > 0)
+                               FillCells(stats, GetDataArray() + (size_t)firstRow * fBins,
+                                         firstRow, numRows, fBins);}
+
+   ClassDef(TFArrColumn, 2) // An array column of TFTable (each bin is an array)
+};
+
+//_____________________________________________________________________________
+
+template <class T, class F = DefaultFormat<T> >
+   class TFVarArrColumn : public TFBaseCol
+{
+protected:
+   std::vector <T>          fValues;     // all values of this column, row after row
+   mutable std::vector <ULong64_t>  fOffsets;  // index of the first value of each row in fValues
+                                         // and one after the last value of the last row
+   mutable std::atomic<UInt_t>  fFillRow;  //! row set last by SetRowSize(), all following rows 
+                                         // are empty and their offsets are not yet updated
+   mutable std::mutex       fFillMutex;  //! protects the update of the offsets in UpdateOffsets()
+   mutable T *              treeBuffer;  //! buffer to fill a TTree
+   mutable Int_t            fTreeCount;  //! number of values in treeBuffer
+   TLeaf                    * fLeaf;     //! leaf of a TTree to copy the values from
+
+   ULong64_t    Offset(UInt_t row) const  {return row <= fFillRow ? fOffsets[row] : fValues.size();}
+   void         UpdateOffsets() const;
+
+public:
+   typedef T value_type;
+
+   TFVarArrColumn() : fOffsets(1, 0), fFillRow(0) 
+      {treeBuffer = NULL; fTreeCount = 0; fLeaf = NULL;}
+   TFVarArrColumn(const char * name, int numRows = 0)
+      : TFBaseCol(name), fOffsets(numRows + 1, 0), fFillRow(numRows)
+      {treeBuffer = NULL; fTreeCount = 0; fLeaf = NULL;}
+   TFVarArrColumn(const TFVarArrColumn<T, F> & column)
+      : TFBaseCol(column), fValues(column.fValues), 
+        fOffsets(column.GetOffsets(), column.GetOffsets() + column.GetNumRows() + 1),
+        fFillRow(column.GetNumRows())
+      {treeBuffer = NULL; fTreeCount = 0; fLeaf = NULL;}
+
+
+   virtual TObject * Clone(const char * name="") const {return new TFVarArrColumn<T, F>(*this);}
+
+   virtual TFVarArrColumn<T, F> & operator = (const TFVarArrColumn<T, F> & col) {
+                                            if (&col != this) {
+                                              TFBaseCol::operator=(col);
+                                              fValues  = col.fValues;
+                                              fOffsets.assign(col.GetOffsets(), 
+                                                              col.GetOffsets() + col.GetNumRows() + 1);
+                                              fFillRow = GetNumRows();
+                                              }
+                                            return *this;
+                                            }
+   virtual bool         operator == (const TFHeader & col) const  {
+                                        return TFBaseCol::operator==(col) &&
+                                               IsA() == col.IsA() &&
+                                               fValues == ((TFVarArrColumn<T, F>&)col).fValues &&
+                                               GetNumRows() == ((TFVarArrColumn<T, F>&)col).GetNumRows() &&
+                                               memcmp(GetOffsets(), ((TFVarArrColumn<T, F>&)col).GetOffsets(),
+                                                      (GetNumRows() + 1) * sizeof(ULong64_t)) == 0;}  
+
+   int CompareRows(UInt_t row1, UInt_t row2) const
+      {if (GetRowSize(row1) == 0 || GetRowSize(row2) == 0)
+          return (Int_t)(GetRowSize(row1) > 0) - (Int_t)(GetRowSize(row2) > 0);
+       const T & v1 = fValues[Offset(row1)];
+       const T & v2 = fValues[Offset(row2)];
+       return (v1 < v2) ? -1 : (v2 < v1) ?  1 : 0;}
+
+
+   TFArrRow<const T> operator[](UInt_t row) const 
+                     {return TFArrRow<const T>(GetDataArray() + Offset(row), GetRowSize(row));}
+   TFArrRow<T>       operator[](UInt_t row)
+                     {return TFArrRow<T>(GetDataArray() + Offset(row), GetRowSize(row), this);}
+
+   // all values of the column, row after row. The values of row r start
+   // at GetOffsets()[r], the last value of the column is at GetOffsets()[GetNumRows()] - 1
+   // Changes of the values through the pointer are not detected by the
+   // column, call InvalidateStats() after them.
+   T *          GetDataArray()            {return fValues.empty() ? NULL : &fValues[0];}
+   const T *    GetDataArray() const      {return fValues.empty() ? NULL : &fValues[0];}
+   const ULong64_t * GetOffsets() const   {UpdateOffsets(); return &fOffsets[0];}
+
+   UInt_t       GetRowSize(UInt_t row) const  {return (UInt_t)(Offset(row + 1) - Offset(row));}
+   UInt_t       GetMaxRowSize() const;
+   void         SetRowSize(UInt_t row, UInt_t size);
+   void         SetRowSizes(const Long64_t * sizes);
+   void         SetRow(UInt_t row, const T * values, UInt_t size);
+   void         CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows);
+
+   Int_t        GetNumBins() const        {return -1;}
+
+   void         Reserve(UInt_t rows)      {fOffsets.reserve(rows + 1);}
+   UInt_t       GetNumRows() const        {return fOffsets.size() - 1;} 
+   size_t       GetWidth() const          {return sizeof(T);}
+
+   const char * GetTypeName() const       {return F::GetTypeName();}
+   const char * GetColTypeName() const    {return Class_Name();}
+
+   void    MakeBranch(TTree* tree, TFNameConvert * nameConvert) const;
+   void *  GetBranchBuffer()              {return NULL;}
+   void *  GetVarBranchBuffer(TLeaf * leaf);
+
+   void    FillBranchBuffer(UInt_t row) const
+                  {
+                     fTreeCount = GetRowSize(row);
+                     if (treeBuffer && fTreeCount > 0)
+                        memcpy(treeBuffer, GetDataArray() + Offset(row), fTreeCount * sizeof(T));
+                  }
+   void    CopyBranchBuffer(UInt_t row)        
+                  {
+                     if (fLeaf && treeBuffer)
+                        SetRow(row, treeBuffer, fLeaf->GetLen());
+                  }
+
+   void    ClearBranchBuffer() const {delete [] treeBuffer; treeBuffer = NULL;};
+
+   char *  GetStringValue(UInt_t row, Int_t bin, char * str, Int_t width = 0, 
+                                    const char * format = NULL) const
+                           {if ((UInt_t)bin >= GetRowSize(row)) {str[0] = 0; return str;}
+                            return F::Format(str, width, format, fValues[Offset(row) + bin]);}
+   void    SetString(UInt_t row, Int_t bin, const char * str)
+                           {if ((UInt_t)bin >= GetRowSize(row)) SetRowSize(row, bin + 1);
+                            F::SetString(str, fValues[Offset(row) + bin]); InvalidateStats();}
+
+protected:
+   virtual void     InsertRows(UInt_t numRows, UInt_t pos) {
+                        UpdateOffsets();
+                        ULong64_t offset = fOffsets[pos];
+                        fOffsets.insert(fOffsets.begin() + pos, numRows, offset);
+                        fFillRow = GetNumRows();
+                        TFBaseCol::InsertRows(numRows, pos);
+                        }
+   virtual void     DeleteRows(UInt_t numRows, UInt_t pos);
+
+   virtual Double_t     ToDouble(UInt_t row) const {return 0.0;}
+   virtual void         SetDouble(Double_t val, UInt_t row)  {};
+   virtual void         FillStats(TFColStats & stats, UInt_t firstRow, UInt_t numRows) const;
 
-   ClassDef(TFArrColumn, 1) // An array column of TFTable (each bin is an array)
+   ClassDef(TFVarArrColumn, 1) // A variable length array column of TFTable
 };
 
 
@@ -485,13 +1113,100 @@ typedef    TFArrColumn<UInt_t, UIntFormat>     TFUIntArrCol;
 typedef    TFArrColumn<Float_t, FloatFormat>   TFFloatArrCol;
 typedef    TFArrColumn<Double_t, DoubleFormat> TFDoubleArrCol;
 
+typedef    TFVarArrColumn<Char_t, BoolCharFormat> TFBoolVarArrCol;
+typedef    TFVarArrColumn<Char_t, CharFormat>     TFCharVarArrCol;
+typedef    TFVarArrColumn<UChar_t, UCharFormat>   TFUCharVarArrCol;
+typedef    TFVarArrColumn<Short_t, ShortFormat>   TFShortVarArrCol;
+typedef    TFVarArrColumn<UShort_t, UShortFormat> TFUShortVarArrCol;
+typedef    TFVarArrColumn<Int_t, IntFormat>       TFIntVarArrCol;
+typedef    TFVarArrColumn<UInt_t, UIntFormat>     TFUIntVarArrCol;
+typedef    TFVarArrColumn<Float_t, FloatFormat>   TFFloatVarArrCol;
+typedef    TFVarArrColumn<Double_t, DoubleFormat> TFDoubleVarArrCol;
+
 //_____________________________________________________________________________
 //_____________________________________________________________________________
 
 inline Double_t     TFSetDbl::operator = (Double_t val)  {fCol->SetDouble(val, fRow); return val;}   
 inline              TFSetDbl::operator Double_t () {return fCol->ToDouble(fRow);}
 
-inline TFNullIter   TFBaseCol::MakeNullIterator() const  {return TFNullIter(fNull.begin(), fNull.end());}
+inline Bool_t TFBaseCol::IsNull(UInt_t row, UInt_t bin) const
+{
+   if (bin >= fNullBins)
+      return kFALSE;
+   ULong64_t index = (ULong64_t)row * fNullBins + bin;
+   return (index >> 6) < fNullBits.size() &&
+          ((fNullBits[index >> 6] >> (index & 63)) & 1);
+}
+
+inline TFNullIter   TFBaseCol::MakeNullIterator() const
+   {return TFNullIter(fNullBits.empty() ? NULL : &fNullBits[0], fNullBits.size(), fNullBins);}
+
+//_____________________________________________________________________________
+template <class T>
+void TFBaseCol::FillCells(TFColStats & stats, const T * values, UInt_t firstRow,
+                          UInt_t numRows, UInt_t bins) const
+{
+// Adds the values of numRows rows with bins values per row to stats.
+// values is the first value of row firstRow. NULL values are skipped,
+// the other values are collected in a buffer to keep the loops of
+// TFColStats::Fill() simple.
+
+   if (fNumNull == 0)
+      {
+      stats.Fill(values, (ULong64_t)numRows * bins);
+      return;
+      }
+
+   T      buffer[1024];
+   UInt_t num = 0;
+   for (UInt_t row = 0; row < numRows; row++)
+      for (UInt_t bin = 0; bin < bins; bin++, values++)
+         {
+         if (TFBaseCol::IsNull(firstRow + row, bin))
+            continue;
+         buffer[num++] = *values;
+         if (num == 1024)
+            {
+            stats.Fill(buffer, num);
+            num = 0;
+            }
+         }
+   stats.Fill(buffer, num);
+}
+
+inline UInt_t TFNullIter::LowestBit(ULong64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   return __builtin_ctzll(word);
+#else
+   UInt_t bit = 0;
+   while ((word & 1) == 0)
+      {
+      word >>= 1;
+      bit++;
+      }
+   return bit;
+#endif
+}
+
+inline Bool_t TFNullIter::Next()
+{
+   // skip the words without NULL values
+   while (fRest == 0)
+      {
+      if (++fWord >= fNumWords)
+         {
+         fWord = fNumWords;
+         return kFALSE;
+         }
+      fRest = fBits[fWord];
+      }
+
+   ULong64_t index = ((ULong64_t)fWord << 6) + LowestBit(fRest);
+   fRest &= fRest - 1;
+   fNull = ((index / fBins) << 32) + index % fBins;
+   return kTRUE;
+}
 
 inline TFBaseCol::operator TFColumn<Char_t, BoolCharFormat>    & () {return dynamic_cast <TFColumn<Char_t, BoolCharFormat>    &>(*this);}
 inline TFBaseCol::operator TFColumn<Char_t, CharFormat>        & () {return dynamic_cast <TFColumn<Char_t, CharFormat>        &>(*this);}
@@ -503,6 +1218,7 @@ inline TFBaseCol::operator TFColumn<UInt_t, UIntFormat>        & () {return dyna
 inline TFBaseCol::operator TFColumn<Float_t, FloatFormat>      & () {return dynamic_cast <TFColumn<Float_t, FloatFormat>      &>(*this);}
 inline TFBaseCol::operator TFColumn<Double_t, DoubleFormat>    & () {return dynamic_cast <TFColumn<Double_t, DoubleFormat>    &>(*this);}
 inline TFBaseCol::operator TFStringCol                         & () {return dynamic_cast <TFStringCol                         &>(*this);}
+inline TFBaseCol::operator TFDictStringCol                     & () {return dynamic_cast <TFDictStringCol                     &>(*this);}
 inline TFBaseCol::operator TFArrColumn<Char_t, BoolCharFormat> & () {return dynamic_cast <TFArrColumn<Char_t, BoolCharFormat> &>(*this);}
 inline TFBaseCol::operator TFArrColumn<Char_t, CharFormat>     & () {return dynamic_cast <TFArrColumn<Char_t, CharFormat>     &>(*this);}
 inline TFBaseCol::operator TFArrColumn<UChar_t, UCharFormat>   & () {return dynamic_cast <TFArrColumn<UChar_t, UCharFormat>   &>(*this);}
@@ -515,13 +1231,288 @@ inline TFBaseCol::operator TFArrColumn<Double_t, DoubleFormat> & () {return dyna
 
 inline TFNullIter & TFNullIter::operator = (const TFNullIter & nullIter)
 {
-   fIter   = nullIter.fIter;
-   fBegin  = nullIter.fBegin;
-   fEnd    = nullIter.fEnd;
-   fNull   = nullIter.fNull;      
+   fBits     = nullIter.fBits;
+   fNumWords = nullIter.fNumWords;
+   fBins     = nullIter.fBins;
+   fWord     = nullIter.fWord;
+   fRest     = nullIter.fRest;
+   fNull     = nullIter.fNull;
    return *this;
 }
 
+//_____________________________________________________________________________
+template <class T, class F>
+void TFArrColumn<T, F>::SetNumBins(UInt_t bins)
+{
+// Changes the number of bins of every row. Existing values of the first
+// bins are kept, new bins are 0.
+
+   if ((Int_t)bins == fBins)
+      return;
+
+   if (fNumRows > 0 && fBins > 0 && bins > 0)
+      {
+      std::vector<T> values((size_t)fNumRows * bins);
+      UInt_t numCopy = (UInt_t)fBins < bins ? fBins : bins;
+      for (UInt_t row = 0; row < fNumRows; row++)
+         memcpy(&values[(size_t)row * bins], &fValues[(size_t)row * fBins],
+                numCopy * sizeof(T));
+      fValues.swap(values);
+      }
+   else
+      fValues.assign((size_t)fNumRows * bins, T());
+
+   fBins = bins;
+   InvalidateStats();
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFArrColumn<T, F>::Streamer(TBuffer & b)
+{
+// Stream an object of class TFArrColumn. The values of all rows are
+// streamed as one array. The first version of this class streamed a
+// vector of TFBinVector, one per row, these columns are converted into
+// one buffer for all rows when they are read.
+
+   if (b.IsReading())
+      {
+      std::vector<TFBinVector<T> >().swap(fData);
+      fNumRows = 0;
+      b.ReadClassBuffer(TFArrColumn<T, F>::Class(), this);
+
+      if (fBins < 0)
+         fBins = 0;
+      if (!fData.empty())
+         {
+         // version 1: one TFBinVector per row
+         fNumRows = fData.size();
+         fValues.assign((size_t)fNumRows * fBins, T());
+         for (UInt_t row = 0; row < fNumRows; row++)
+            {
+            Int_t numCopy = fData[row].size() < fBins ? fData[row].size() : fBins;
+            for (Int_t bin = 0; bin < numCopy; bin++)
+               fValues[(size_t)row * fBins + bin] = fData[row][bin];
+            }
+         std::vector<TFBinVector<T> >().swap(fData);
+         }
+      else
+         fValues.resize((size_t)fNumRows * fBins);
+      InvalidateStats();
+      }
+   else
+      b.WriteClassBuffer(TFArrColumn<T, F>::Class(), this);
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::Streamer(TBuffer & b)
+{
+// Stream an object of class TFVarArrColumn. The offsets of all rows are
+// updated before they are written.
+
+   if (b.IsReading())
+      {
+      b.ReadClassBuffer(TFVarArrColumn<T, F>::Class(), this);
+      if (fOffsets.empty())
+         fOffsets.assign(1, 0);
+      fFillRow = GetNumRows();
+      }
+   else
+      {
+      UpdateOffsets();
+      b.WriteClassBuffer(TFVarArrColumn<T, F>::Class(), this);
+      }
+}
+//_____________________________________________________________________________
+template <class T, class F>
+UInt_t TFVarArrColumn<T, F>::GetMaxRowSize() const
+{
+// returns the number of values of the largest row
+
+   UInt_t maxSize = 0;
+   for (UInt_t row = 0; row < GetNumRows(); row++)
+      if (GetRowSize(row) > maxSize)
+         maxSize = GetRowSize(row);
+   return maxSize;
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::UpdateOffsets() const
+{
+// Sets the offsets of the empty rows behind the row set last by 
+// SetRowSize(). The offsets are updated only when they are needed,
+// because SetRowSize() would have to update all of them for each row
+// if the column is filled row by row.
+
+   if (fFillRow >= GetNumRows())
+      return;
+
+   std::lock_guard<std::mutex> lock(fFillMutex);
+   UInt_t numRows = GetNumRows();
+   for (UInt_t row = fFillRow + 1; row <= numRows; row++)
+      fOffsets[row] = fValues.size();
+   fFillRow = numRows;
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::SetRowSize(UInt_t row, UInt_t size)
+{
+// Changes the number of values of one row. Existing values are kept, new
+// values are 0. The values of all following rows have to be moved.
+// If all following rows are empty, for example if the column is filled
+// row by row, only the values of this row are changed and the offsets
+// of the following rows are updated later, once for all rows. 
+// To fill many rows use SetRowSizes() once and copy the values into 
+// GetDataArray().
+
+   UInt_t oldSize = GetRowSize(row);
+   if (size == oldSize)
+      return;
+
+   InvalidateStats();
+   if (fFillRow >= GetNumRows() && fOffsets[row + 1] == fValues.size())
+      fFillRow = row;
+
+   UInt_t fillRow = fFillRow;
+   if (row >= fillRow)
+      {
+      // the values of this row are the last values of the column
+      for (UInt_t r = fillRow + 1; r <= row; r++)
+         fOffsets[r] = fValues.size();
+      fValues.resize(fOffsets[row] + size);
+      fFillRow = row;
+      return;
+      }
+
+   UpdateOffsets();
+   if (size > oldSize)
+      fValues.insert(fValues.begin() + fOffsets[row] + oldSize, size - oldSize, T());
+   else
+      fValues.erase(fValues.begin() + fOffsets[row] + size, 
+                    fValues.begin() + fOffsets[row] + oldSize);
+
+   for (UInt_t r = row + 1; r < fOffsets.size(); r++)
+      fOffsets[r] = fOffsets[r] + size - oldSize;
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::SetRowSizes(const Long64_t * sizes)
+{
+// Sets the number of values of all rows. sizes must have GetNumRows()
+// entries. All values of the column are set to 0.
+
+   for (UInt_t row = 0; row < GetNumRows(); row++)
+      fOffsets[row + 1] = fOffsets[row] + sizes[row];
+   fValues.assign(fOffsets.back(), T());
+   fFillRow = GetNumRows();
+   InvalidateStats();
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::SetRow(UInt_t row, const T * values, UInt_t size)
+{
+// Sets all size values of one row.
+
+   SetRowSize(row, size);
+   if (size > 0)
+      memcpy(GetDataArray() + Offset(row), values, size * sizeof(T));
+   InvalidateStats();
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::FillStats(TFColStats & stats, UInt_t firstRow, UInt_t numRows) const
+{
+   const T * values = GetDataArray() + Offset(firstRow);
+   if (fNumNull == 0)
+      stats.Fill(values, Offset(firstRow + numRows) - Offset(firstRow));
+   else
+      for (UInt_t row = firstRow; row < firstRow + numRows; row++)
+         {
+         FillCells(stats, values, row, 1, GetRowSize(row));
+         values += GetRowSize(row);
+         }
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::CopyRows(const TFBaseCol & col, const UInt_t * rows, UInt_t numRows)
+{
+// Replaces all rows of this column by the rows of col, see TFBaseCol::CopyRows()
+
+   const TFVarArrColumn<T, F> & arr = (const TFVarArrColumn<T, F> &)col;
+
+   fOffsets.assign(numRows + 1, 0);
+   for (UInt_t row = 0; row < numRows; row++)
+      fOffsets[row + 1] = fOffsets[row] + 
+                          (rows[row] < arr.GetNumRows() ? arr.GetRowSize(rows[row]) : 0);
+
+   fValues.resize(fOffsets[numRows]);
+   fFillRow = numRows;
+   for (UInt_t row = 0; row < numRows; row++)
+      if (fOffsets[row + 1] > fOffsets[row])
+         std::copy(arr.fValues.begin() + arr.Offset(rows[row]),
+                   arr.fValues.begin() + arr.Offset(rows[row] + 1),
+                   fValues.begin() + fOffsets[row]);
+
+   TFBaseCol::CopyRows(col, rows, numRows);
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::DeleteRows(UInt_t numRows, UInt_t pos)
+{
+   UpdateOffsets();
+   ULong64_t numValues = fOffsets[pos + numRows] - fOffsets[pos];
+   fValues.erase(fValues.begin() + fOffsets[pos], 
+                 fValues.begin() + fOffsets[pos + numRows]);
+   fOffsets.erase(fOffsets.begin() + pos + 1, fOffsets.begin() + pos + numRows + 1);
+   for (UInt_t r = pos + 1; r < fOffsets.size(); r++)
+      fOffsets[r] -= numValues;
+   fFillRow = GetNumRows();
+
+   TFBaseCol::DeleteRows(numRows, pos);
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void TFVarArrColumn<T, F>::MakeBranch(TTree* tree, TFNameConvert * nameConvert) const
+{
+// Adds two branches to the tree: the number of values of a row in
+// the branch <name>_n and the values in the branch <name>.
+
+   if (F::GetBranchType()[0] == 0)
+      return;
+
+   char name[200];
+   char count[210];
+   char branch[430];
+   strncpy(name, nameConvert->Conv(GetName()), 199);
+   name[199] = 0;
+   sprintf(count, "%s_n", name);
+
+   UInt_t maxSize = GetMaxRowSize();
+   treeBuffer = new T[maxSize > 0 ? maxSize : 1];
+   fTreeCount = 0;
+
+   sprintf(branch, "%s/I", count);
+   tree->Branch(count, (void*)&fTreeCount, (const char*)branch);
+   sprintf(branch, "%s[%s]%s", name, count, F::GetBranchType());
+   tree->Branch(name, (void*)treeBuffer, (const char*)branch);
+}
+//_____________________________________________________________________________
+template <class T, class F>
+void * TFVarArrColumn<T, F>::GetVarBranchBuffer(TLeaf * leaf)
+{
+// Returns a buffer large enough for the values of leaf, a leaf with a
+// variable number of values per entry. CopyBranchBuffer() copies
+// leaf->GetLen() values of the buffer into a row.
+
+   fLeaf = leaf;
+   Int_t maxSize = leaf->GetLenStatic();
+   if (leaf->GetLeafCount())
+      maxSize *= leaf->GetLeafCount()->GetMaximum();
+
+   delete [] treeBuffer;
+   treeBuffer = new T[maxSize > 0 ? maxSize : 1];
+   return treeBuffer;
+}
+
 
 #endif
 
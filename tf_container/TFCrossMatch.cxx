@@ -0,0 +1,275 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFCrossMatch.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+
+#include <algorithm>
+#include <set>
+
+#include "healpix_base.h"
+#include "pointing.h"
+#include "rangeset.h"
+
+#include "TFCrossMatch.h"
+#include "TFJoin.h"
+#include "TFSkyIndex.h"
+#include "TFTable.h"
+#include "TFColumn.h"
+#include "TFParallel.h"
+#include "TFError.h"
+
+
+//_____________________________________________________________________________
+// TFCrossMatch:
+//    Internal class, used by TFTable::CrossMatch() and
+//    TFTable::CrossMatchRows(). Should not be used directly by an
+//    application.
+//    The positions of the smaller table are sorted by their HEALPix pixel
+//    in the NESTED scheme. The resolution is the highest one with pixels
+//    still larger than the match radius. For every position of the other
+//    table the pixels overlapping the circle of the match radius are
+//    found with query_disc_inclusive(). In the NESTED scheme these pixels
+//    are a few ranges of pixel numbers, each range is one contiguous part
+//    of the sorted positions. The positions of the other table are
+//    processed in parallel by the threads of the ROOT thread pool, if the
+//    implicit multi-threading of ROOT is enabled.
+
+static const Int_t  kMaxOrder  = 29;     // highest order of 64 bit pixel numbers
+static const UInt_t kBlockRows = 4096;   // rows converted to double at once
+
+//_____________________________________________________________________________
+// one position of the bucketed table
+
+struct TFSkyPos
+{
+   Double_t    fX;      // unit vector of the position
+   Double_t    fY;
+   Double_t    fZ;
+   UInt_t      fRow;    // row of the position
+};
+
+//_____________________________________________________________________________
+// one pair of matching positions
+
+struct TFSkyMatch
+{
+   UInt_t      fRow;        // row of the first table
+   UInt_t      fOtherRow;   // row of the second table
+   Double_t    fDist2;      // square of the chord distance of both positions
+
+   bool operator < (const TFSkyMatch & match) const
+           {return fRow != match.fRow     ? fRow < match.fRow     :
+                   fDist2 != match.fDist2 ? fDist2 < match.fDist2 :
+                                            fOtherRow < match.fOtherRow;}
+};
+
+//_____________________________________________________________________________
+static inline Bool_t IsValid(const TFBaseCol * ra, const TFBaseCol * dec,
+                             UInt_t row, Double_t raVal, Double_t decVal)
+{
+// a position with a NULL, NaN or infinite value or with a declination
+// outside -90 to 90 degrees never matches
+
+   return std::isfinite(raVal) && std::isfinite(decVal) && fabs(decVal) <= 90 &&
+          !(ra->HasNull() && ra->IsNull(row)) && !(dec->HasNull() && dec->IsNull(row));
+}
+
+//_____________________________________________________________________________
+Bool_t TFCrossMatch::MatchRows(const TFTable & table, const TFTable & other,
+                               Double_t radius, const char * pos, const char * otherPos,
+                               std::vector<UInt_t> & rows, std::vector<UInt_t> & otherRows,
+                               std::vector<Double_t> & separations,
+                               Bool_t nearest, Bool_t parallel)
+{
+// Computes the pairs of rows of the positional cross-match of table and
+// other, see TFTable::CrossMatchRows().
+
+   rows.clear();
+   otherRows.clear();
+   separations.clear();
+
+   const TFBaseCol * ra[2];
+   const TFBaseCol * dec[2];
+   if (!TFSkyIndex::GetPosCols(table, pos, "TFTable::CrossMatch", ra[0], dec[0]) ||
+       !TFSkyIndex::GetPosCols(other, otherPos ? otherPos : pos, "TFTable::CrossMatch",
+                               ra[1], dec[1]))
+      return kFALSE;
+
+   if (!(radius > 0))
+      {
+      TFError::SetError("TFTable::CrossMatch", "The match radius %g is not positive.",
+                        radius);
+      return kFALSE;
+      }
+
+   // the smaller table is bucketed, the positions of the other table are
+   // looked up in the buckets
+   Int_t  build    = table.GetNumRows() < other.GetNumRows() ? 0 : 1;
+   Int_t  probe    = 1 - build;
+   UInt_t numBuild = build == 0 ? table.GetNumRows() : other.GetNumRows();
+   UInt_t numProbe = build == 0 ? other.GetNumRows() : table.GetNumRows();
+
+   Double_t radRadius = std::min(radius, 180.) * M_PI / 180.;
+   Double_t maxDist2  = 4 * sin(radRadius / 2) * sin(radRadius / 2);
+
+   Int_t order = 0;
+   while (order < kMaxOrder && Healpix_Base2(order + 1, NEST).max_pixrad() >= radRadius)
+      order++;
+   Healpix_Base2 healpix(order, NEST);
+
+   std::vector<Double_t> raVal(numBuild), decVal(numBuild);
+   ra[build]->ToDoubles(0, numBuild, raVal.data());
+   dec[build]->ToDoubles(0, numBuild, decVal.data());
+
+   std::vector<int64>  pixels(numBuild);
+   std::vector<char>   valid(numBuild);
+   TFParallel::Foreach(numBuild, parallel ? TFParallel::GetNumChunks(numBuild) : 1,
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {
+            for (UInt_t row = begin; row < end; row++)
+               {
+               valid[row] = IsValid(ra[build], dec[build], row, raVal[row], decVal[row]);
+               if (valid[row])
+                  pixels[row] = healpix.ang2pix(pointing((90 - decVal[row]) * M_PI / 180,
+                                                         raVal[row] * M_PI / 180));
+               }
+         });
+
+   std::vector<std::pair<int64, UInt_t> > pixRows;
+   pixRows.reserve(numBuild);
+   for (UInt_t row = 0; row < numBuild; row++)
+      if (valid[row])
+         pixRows.push_back(std::make_pair(pixels[row], row));
+   std::sort(pixRows.begin(), pixRows.end());
+
+   std::vector<TFSkyPos> bucket(pixRows.size());
+   pixels.resize(pixRows.size());
+   for (size_t num = 0; num < pixRows.size(); num++)
+      {
+      UInt_t   row  = pixRows[num].second;
+      Double_t cDec = cos(decVal[row] * M_PI / 180);
+      pixels[num]         = pixRows[num].first;
+      bucket[num].fX      = cDec * cos(raVal[row] * M_PI / 180);
+      bucket[num].fY      = cDec * sin(raVal[row] * M_PI / 180);
+      bucket[num].fZ      = sin(decVal[row] * M_PI / 180);
+      bucket[num].fRow    = row;
+      }
+   std::vector<std::pair<int64, UInt_t> >().swap(pixRows);
+   std::vector<Double_t>().swap(raVal);
+   std::vector<Double_t>().swap(decVal);
+
+   // every chunk of the other table collects its matches
+   UInt_t numChunks = parallel ? TFParallel::GetNumChunks(numProbe) : 1;
+   std::vector<std::vector<TFSkyMatch> > matches(numChunks);
+   TFParallel::Foreach(numProbe, numChunks,
+         [&](UInt_t chunk, UInt_t begin, UInt_t end)
+         {
+            std::vector<TFSkyMatch> & out = matches[chunk];
+            std::vector<Double_t> raBuf(kBlockRows), decBuf(kBlockRows);
+            rangeset<int64> ranges;
+
+            for (UInt_t first = begin; first < end; first += kBlockRows)
+               {
+               UInt_t last = std::min(end, first + kBlockRows);
+               ra[probe]->ToDoubles(first, last, raBuf.data());
+               dec[probe]->ToDoubles(first, last, decBuf.data());
+
+               for (UInt_t row = first; row < last; row++)
+                  {
+                  Double_t raPos  = raBuf[row - first];
+                  Double_t decPos = decBuf[row - first];
+                  if (!IsValid(ra[probe], dec[probe], row, raPos, decPos))
+                     continue;
+
+                  Double_t cDec = cos(decPos * M_PI / 180);
+                  Double_t x    = cDec * cos(raPos * M_PI / 180);
+                  Double_t y    = cDec * sin(raPos * M_PI / 180);
+                  Double_t z    = sin(decPos * M_PI / 180);
+
+                  healpix.query_disc_inclusive(pointing((90 - decPos) * M_PI / 180,
+                                                        raPos * M_PI / 180),
+                                               radRadius, ranges);
+                  for (size_t range = 0; range < ranges.nranges(); range++)
+                     {
+                     size_t num = std::lower_bound(pixels.begin(), pixels.end(),
+                                                   ranges.ivbegin(range)) - pixels.begin();
+                     for ( ; num < pixels.size() && pixels[num] < ranges.ivend(range); num++)
+                        {
+                        const TFSkyPos & sky = bucket[num];
+                        Double_t dist2 = (x - sky.fX) * (x - sky.fX) +
+                                         (y - sky.fY) * (y - sky.fY) +
+                                         (z - sky.fZ) * (z - sky.fZ);
+                        if (dist2 > maxDist2)
+                           continue;
+
+                        TFSkyMatch match;
+                        match.fRow      = build == 0 ? sky.fRow : row;
+                        match.fOtherRow = build == 0 ? row : sky.fRow;
+                        match.fDist2    = dist2;
+                        out.push_back(match);
+                        }
+                     }
+                  }
+               }
+         });
+
+   // order the matches by the row of table and by their separation
+   std::vector<TFSkyMatch> all;
+   size_t num = 0;
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      num += matches[chunk].size();
+   all.reserve(num);
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      {
+      all.insert(all.end(), matches[chunk].begin(), matches[chunk].end());
+      std::vector<TFSkyMatch>().swap(matches[chunk]);
+      }
+   std::sort(all.begin(), all.end());
+
+   for (size_t match = 0; match < all.size(); match++)
+      {
+      if (nearest && match > 0 && all[match].fRow == all[match - 1].fRow)
+         continue;
+      rows.push_back(all[match].fRow);
+      otherRows.push_back(all[match].fOtherRow);
+      separations.push_back(2 * asin(std::min(1., sqrt(all[match].fDist2) / 2)) * 180 / M_PI);
+      }
+
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+TFTable * TFCrossMatch::CrossMatch(const TFTable & table, const TFTable & other,
+                                   Double_t radius, const char * pos, const char * otherPos,
+                                   const char * sepName, Bool_t nearest, Bool_t parallel)
+{
+// Creates the table of the positional cross-match of table and other, see
+// TFTable::CrossMatch().
+
+   std::vector<UInt_t>   rows, otherRows;
+   std::vector<Double_t> separations;
+   if (!MatchRows(table, other, radius, pos, otherPos, rows, otherRows, separations,
+                  nearest, parallel))
+      return NULL;
+
+   TFTable * result = TFJoin::MakeTable(table, other, rows, otherRows,
+                                        std::set<const TFBaseCol *>(), parallel);
+
+   TFDoubleCol * sep = new TFDoubleCol(sepName, separations.size());
+   for (UInt_t row = 0; row < separations.size(); row++)
+      (*sep)[row] = separations[row];
+
+   if (result->AddColumn(sep) < 0)
+      {
+      delete sep;
+      delete result;
+      return NULL;
+      }
+   return result;
+}
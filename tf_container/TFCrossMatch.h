@@ -0,0 +1,39 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFCrossMatch.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFCrossMatch
+#define ROOT_TFCrossMatch
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <vector>
+
+
+class TFTable;
+
+//_____________________________________________________________________________
+
+class TFCrossMatch
+{
+public:
+   static Bool_t     MatchRows(const TFTable & table, const TFTable & other,
+                               Double_t radius, const char * pos, const char * otherPos,
+                               std::vector<UInt_t> & rows, std::vector<UInt_t> & otherRows,
+                               std::vector<Double_t> & separations,
+                               Bool_t nearest = kTRUE, Bool_t parallel = kTRUE);
+
+   static TFTable *  CrossMatch(const TFTable & table, const TFTable & other,
+                                Double_t radius, const char * pos, const char * otherPos,
+                                const char * sepName, Bool_t nearest = kTRUE,
+                                Bool_t parallel = kTRUE);
+};
+
+#endif
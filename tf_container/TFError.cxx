@@ -31,6 +31,12 @@ ClassImp(TFException)
 //    Several of the TF - classes write error messages into this storage. At the
 //    end of an application or at any time the error messages can be printed
 //    with PrintErrors().
+//    Each thread has its own error messages and its own error type ( see
+//    SetErrorType() ), therefore the TF - classes can be used at the same
+//    time in different threads. Functions which process the rows of a 
+//    table in parallel by the ROOT thread pool ( see TFParallel ) handle
+//    the errors of the pool threads with the error type of the calling
+//    thread and pass them to the calling thread.
 //
 //
 // TFErrMsg:
@@ -48,10 +54,10 @@ ClassImp(TFException)
 //    to the TFError class with the AddToError() function.
 //
 
-Int_t       TFError::fMaxErrors  = 20;
-Int_t       TFError::fNumErrors  = 0;
-TFErrMsg *  TFError::fErrMsgs    = NULL;
-TFErrorType TFError::fErrorType  = kStoreErr;
+Int_t                    TFError::fMaxErrors  = 20;
+thread_local Int_t       TFError::fNumErrors  = 0;
+thread_local TFErrMsg *  TFError::fErrMsgs    = NULL;
+thread_local TFErrorType TFError::fErrorType  = kStoreErr;
 
 //_____________________________________________________________________________
 void TFErrMsg::Add(TFErrMsg * errMsg)
@@ -198,6 +204,31 @@ void TFError::SetMaxErrors(Int_t num)
       }
 }
 //_____________________________________________________________________________
+TFErrMsg * TFError::TakeErrors()
+{
+// Removes all error messages of this thread from the storage and returns
+// them as linked list. The caller is the owner of the list. 
+// This is an internal function used by TFParallel.
+
+   TFErrMsg * errMsgs = fErrMsgs;
+   fErrMsgs   = NULL;
+   fNumErrors = 0;
+   return errMsgs;
+}
+//_____________________________________________________________________________
+void TFError::RestoreErrors(TFErrMsg * errMsgs)
+{
+// Replaces the error messages of this thread by errMsgs, a list returned
+// by TakeErrors(). This storage becomes the owner of the list.
+// This is an internal function used by TFParallel.
+
+   delete fErrMsgs;
+   fErrMsgs   = errMsgs;
+   fNumErrors = 0;
+   for (TFErrMsg * errMsg = fErrMsgs; errMsg; errMsg = errMsg->fNext)
+      fNumErrors++;
+}
+//_____________________________________________________________________________
 void TFError::PrintErrors()
 {
 // Prints all error messages on standard output
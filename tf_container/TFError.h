@@ -42,11 +42,11 @@ private:
 
 class TFError
 {
-   static Int_t         fMaxErrors;    // maximum number of stored errors 
-   static Int_t         fNumErrors;    // actual number of stored errors 
+   static Int_t                     fMaxErrors;    // maximum number of stored errors 
+   static thread_local Int_t        fNumErrors;    // actual number of stored errors 
   
-   static TFErrMsg      * fErrMsgs;    // root of a list of error messages
-   static TFErrorType   fErrorType;    // type of error handling: store, exception
+   static thread_local TFErrMsg     * fErrMsgs;    // root of a list of error messages
+   static thread_local TFErrorType  fErrorType;    // type of error handling: store, exception
 
 public:
    TFError() {}
@@ -69,6 +69,9 @@ public:
    static void    SetMaxErrors(Int_t num);
    static Int_t   GetMaxErrors()                      {return fMaxErrors;}
 
+   static TFErrMsg * TakeErrors();
+   static void       RestoreErrors(TFErrMsg * errMsgs);
+
 private:
    ClassDef(TFError,0)  // Class to store error messages and to print them
 
@@ -0,0 +1,1322 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFFilter.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include <algorithm>
+#include <limits>
+#include <atomic>
+
+#include "TFFilter.h"
+#include "TFColumn.h"
+#include "TFError.h"
+
+//_____________________________________________________________________________
+// TFFilter:
+//    Internal class, used by TFRowIter::Filter(). Should not be used
+//    directly by an application.
+//    A filter string is compiled into a tree of nodes. Every node computes
+//    its result for kBatch rows at once into a buffer of doubles, therefore
+//    the columns are read as typed arrays without a virtual function call
+//    per row. Only the columns used in the filter string are read from
+//    the file.
+//    The filter string is a c - expression. It can use column names,
+//    the variables "row" and "row_", numbers, character and string
+//    constants, the operators
+//       ||  &&  |  ^  &  ==  !=  <  <=  >  >=  +  -  *  /  %  !  ~
+//    with the precedence of c and some mathematical functions like
+//    sqrt(), abs(), pow() or TMath::Log10().
+//    For tables with more than TFBaseCol::kZoneRows rows the filter
+//    uses the zone maps of the columns (see TFBaseCol::GetZones() ): 
+//    The rows of a block are not evaluated if the minimum and maximum of
+//    the used columns in this block decide the result of the filter.
+//    The zone maps are used only if the rows are filtered in ascending
+//    order, and they are computed when a block is tested the first time.
+
+//_____________________________________________________________________________
+
+enum EFltOp {kFltOr, kFltAnd, kFltBitOr, kFltBitXor, kFltBitAnd,
+             kFltEq, kFltNe, kFltLe, kFltGe, kFltLt, kFltGt,
+             kFltAdd, kFltSub, kFltMul, kFltDiv, kFltMod,
+             kFltNeg, kFltNot, kFltBitNot};
+
+struct TFFltOpDef
+{
+   const char  * fName;    // the operator in the filter string
+   Int_t       fLevel;     // precedence level, 0 binds weakest
+   Int_t       fOp;        // the operator
+};
+
+// binary operators. Longer operators have to be defined before shorter
+// operators with the same first character
+static const TFFltOpDef gFltOps[] =
+{
+   {"||", 0, kFltOr},   {"&&", 1, kFltAnd},
+   {"|",  2, kFltBitOr}, {"^", 3, kFltBitXor}, {"&",  4, kFltBitAnd},
+   {"==", 5, kFltEq},   {"!=", 5, kFltNe},
+   {"<=", 6, kFltLe},   {">=", 6, kFltGe},    {"<",  6, kFltLt}, {">", 6, kFltGt},
+   {"+",  7, kFltAdd},  {"-",  7, kFltSub},
+   {"*",  8, kFltMul},  {"/",  8, kFltDiv},   {"%",  8, kFltMod},
+   {NULL, 0, 0}
+};
+static const Int_t kFltNumLevels = 9;
+
+
+//_____________________________________________________________________________
+
+static Double_t FltAbs(Double_t x)              {return fabs(x);}
+static Double_t FltSqrt(Double_t x)             {return sqrt(x);}
+static Double_t FltExp(Double_t x)              {return exp(x);}
+static Double_t FltLog(Double_t x)              {return log(x);}
+static Double_t FltLog10(Double_t x)            {return log10(x);}
+static Double_t FltSin(Double_t x)              {return sin(x);}
+static Double_t FltCos(Double_t x)              {return cos(x);}
+static Double_t FltTan(Double_t x)              {return tan(x);}
+static Double_t FltASin(Double_t x)             {return asin(x);}
+static Double_t FltACos(Double_t x)             {return acos(x);}
+static Double_t FltATan(Double_t x)             {return atan(x);}
+static Double_t FltFloor(Double_t x)            {return floor(x);}
+static Double_t FltCeil(Double_t x)             {return ceil(x);}
+static Double_t FltPow(Double_t x, Double_t y)  {return pow(x, y);}
+static Double_t FltATan2(Double_t y, Double_t x){return atan2(y, x);}
+static Double_t FltFmod(Double_t x, Double_t y) {return fmod(x, y);}
+static Double_t FltMin(Double_t x, Double_t y)  {return x < y ? x : y;}
+static Double_t FltMax(Double_t x, Double_t y)  {return x > y ? x : y;}
+
+struct TFFltFuncDef
+{
+   const char  * fName;                         // function name in the filter
+   Double_t    (*fFunc1)(Double_t);             // function with one argument
+   Double_t    (*fFunc2)(Double_t, Double_t);   // function with two arguments
+   Bool_t      fKeepInt;                        // integer arguments give integer
+};
+
+static const TFFltFuncDef gFltFuncs[] =
+{
+   {"abs",   FltAbs,   NULL,     kTRUE },  {"fabs",  FltAbs,   NULL,     kFALSE},
+   {"Abs",   FltAbs,   NULL,     kTRUE },  {"sqrt",  FltSqrt,  NULL,     kFALSE},
+   {"Sqrt",  FltSqrt,  NULL,     kFALSE},  {"exp",   FltExp,   NULL,     kFALSE},
+   {"Exp",   FltExp,   NULL,     kFALSE},  {"log",   FltLog,   NULL,     kFALSE},
+   {"Log",   FltLog,   NULL,     kFALSE},  {"log10", FltLog10, NULL,     kFALSE},
+   {"Log10", FltLog10, NULL,     kFALSE},  {"sin",   FltSin,   NULL,     kFALSE},
+   {"Sin",   FltSin,   NULL,     kFALSE},  {"cos",   FltCos,   NULL,     kFALSE},
+   {"Cos",   FltCos,   NULL,     kFALSE},  {"tan",   FltTan,   NULL,     kFALSE},
+   {"Tan",   FltTan,   NULL,     kFALSE},  {"asin",  FltASin,  NULL,     kFALSE},
+   {"ASin",  FltASin,  NULL,     kFALSE},  {"acos",  FltACos,  NULL,     kFALSE},
+   {"ACos",  FltACos,  NULL,     kFALSE},  {"atan",  FltATan,  NULL,     kFALSE},
+   {"ATan",  FltATan,  NULL,     kFALSE},  {"floor", FltFloor, NULL,     kFALSE},
+   {"Floor", FltFloor, NULL,     kFALSE},  {"ceil",  FltCeil,  NULL,     kFALSE},
+   {"Ceil",  FltCeil,  NULL,     kFALSE},  {"pow",   NULL,     FltPow,   kFALSE},
+   {"Power", NULL,     FltPow,   kFALSE},  {"atan2", NULL,     FltATan2, kFALSE},
+   {"ATan2", NULL,     FltATan2, kFALSE},  {"fmod",  NULL,     FltFmod,  kFALSE},
+   {"min",   NULL,     FltMin,   kTRUE },  {"Min",   NULL,     FltMin,   kTRUE },
+   {"max",   NULL,     FltMax,   kTRUE },  {"Max",   NULL,     FltMax,   kTRUE },
+   {NULL,    NULL,     NULL,     kFALSE}
+};
+
+//_____________________________________________________________________________
+// the rows of one block of the zone maps of the columns, used to compute 
+// the range of the result of a node for all rows of a block
+
+struct TFFltZone
+{
+   UInt_t      fBlock;        // the block of the zone maps
+   Double_t    fFirstRow;     // first row of the block
+   Double_t    fLastRow;      // last row of the block
+   Double_t    fFirstIndex;   // smallest "row_" of the evaluated rows
+   Double_t    fLastIndex;    // largest "row_" of the evaluated rows
+};
+
+typedef std::atomic<const std::vector<TFColStats> *> TFFltZones;
+
+static Bool_t ZoneRange(const TFBaseCol * col, TFFltZones & zones, UInt_t block,
+                        Double_t & min, Double_t & max)
+{
+// the range of the values of a column in one block. The range is unknown
+// if the block has NULL values or NaN values. The zone map of the column
+// is computed when it is used the first time and kept in zones.
+
+   if (col->GetNumRows() <= TFBaseCol::kZoneRows)
+      return kFALSE;
+
+   const std::vector<TFColStats> * colZones = zones.load(std::memory_order_acquire);
+   if (colZones == NULL)
+      {
+      colZones = &col->GetZones();
+      zones.store(colZones, std::memory_order_release);
+      }
+   if (block >= colZones->size())
+      return kFALSE;
+
+   const TFColStats & zone = (*colZones)[block];
+   if (zone.GetNumNull() > 0 || zone.GetNumNaN() > 0 || zone.GetCount() == 0)
+      return kFALSE;
+
+   min = zone.GetMin();
+   max = zone.GetMax();
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+template <class C>
+static Bool_t FindColRange(const C * col, Double_t min, Double_t max, TFBitmap & rows)
+{
+// the rows of a column with a value between min and max. A sorted column
+// is faster than the bitmap index, the bitmap index faster than the index
+
+   UInt_t begin, end;
+   if (col->FindRowRange(min, max, begin, end))
+      {
+      rows.Clear();
+      if (begin < end)
+         rows.AddRange(begin, end - 1);
+      return kTRUE;
+      }
+
+   if (col->FindBitmap(min, max, rows))
+      return kTRUE;
+
+   std::vector<UInt_t> found;
+   if (!col->FindRows(min, max, found))
+      return kFALSE;
+
+   rows.Clear();
+   for (size_t i = 0; i < found.size(); i++)
+      rows.Add(found[i]);
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+// the nodes of a compiled filter
+
+class TFFltNode
+{
+public:
+   Int_t       fSlot;      // index of the result buffer in the work space
+   Bool_t      fInteger;   // kTRUE if the result is an integer number
+
+   TFFltNode()             {fSlot = -1; fInteger = kFALSE;}
+   virtual ~TFFltNode()    {}
+
+   // computes num results for the rows rows[0..num). first is the
+   // value of row_ of rows[0]
+   virtual const Double_t * Eval(const UInt_t * rows, UInt_t first, UInt_t num,
+                                 Double_t * work) const = 0;
+
+   // computes the range [min, max] of the results for all rows of zone.
+   // Returns kFALSE if the range is unknown.
+   virtual Bool_t    Range(const TFFltZone &, Double_t &, Double_t &) const
+                                           {return kFALSE;}
+
+   // sets rows to all rows which can pass the filter, in ascending order.
+   // Returns kFALSE if these rows cannot be found with an index.
+   virtual Bool_t    FindRows(TFBitmap &) const  {return kFALSE;}
+
+   // sets rows to all rows with a value of this node between min and max
+   // if the node is a column with an index, a bitmap index or the row number.
+   virtual Bool_t    FindRange(Double_t, Double_t, TFBitmap &) const
+                                           {return kFALSE;}
+
+   virtual Bool_t    IsConst() const       {return kFALSE;}
+   virtual Bool_t    IsString() const      {return kFALSE;}
+   virtual Bool_t    HasConstArgs() const  {return kFALSE;}
+
+   Double_t *        Out(Double_t * work) const {return work + fSlot * TFFilter::kBatch;}
+};
+
+//_____________________________________________________________________________
+
+class TFFltConst : public TFFltNode
+{
+   std::vector <Double_t>  fBuf;   // kBatch times the constant value
+
+public:
+   TFFltConst(Double_t val, Bool_t integer) : fBuf(TFFilter::kBatch, val)
+                                          {fInteger = integer;}
+
+   const Double_t *  Eval(const UInt_t *, UInt_t, UInt_t, Double_t *) const
+                                          {return &fBuf[0];}
+   Bool_t            Range(const TFFltZone &, Double_t & min, Double_t & max) const
+                                          {min = max = fBuf[0]; return kTRUE;}
+   Bool_t            IsConst() const      {return kTRUE;}
+};
+
+//_____________________________________________________________________________
+// the variable "row"
+
+class TFFltRow : public TFFltNode
+{
+   UInt_t   fNumRows;   // number of rows of the table
+
+public:
+   TFFltRow(UInt_t numRows) {fNumRows = numRows; fInteger = kTRUE;}
+
+   Bool_t   Range(const TFFltZone & zone, Double_t & min, Double_t & max) const
+                     {min = zone.fFirstRow; max = zone.fLastRow; return kTRUE;}
+
+   Bool_t   FindRange(Double_t min, Double_t max, TFBitmap & rows) const
+      {
+         Double_t first = std::max(ceil(min), 0.0);
+         Double_t last  = std::min(floor(max), (Double_t)fNumRows - 1);
+         rows.Clear();
+         if (first <= last)
+            rows.AddRange((UInt_t)first, (UInt_t)last);
+         return kTRUE;
+      }
+
+   const Double_t *  Eval(const UInt_t * rows, UInt_t, UInt_t num, Double_t * work) const
+      {
+         Double_t * out = Out(work);
+         for (UInt_t i = 0; i < num; i++)
+            out[i] = rows[i];
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+// the variable "row_"
+
+class TFFltRowIndex : public TFFltNode
+{
+public:
+   TFFltRowIndex() {fInteger = kTRUE;}
+
+   Bool_t   Range(const TFFltZone & zone, Double_t & min, Double_t & max) const
+                     {min = zone.fFirstIndex; max = zone.fLastIndex; return kTRUE;}
+
+   const Double_t *  Eval(const UInt_t *, UInt_t first, UInt_t num, Double_t * work) const
+      {
+         Double_t * out = Out(work);
+         for (UInt_t i = 0; i < num; i++)
+            out[i] = first + i;
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+// a column with one value per row
+
+template <class C>
+   class TFFltCol : public TFFltNode
+{
+   const C  * fCol;     // the column
+   mutable TFFltZones fZones;   // zone map of the column, NULL until it is used
+
+public:
+   TFFltCol(const C * col)
+      {fCol = col; fInteger = std::numeric_limits<typename C::value_type>::is_integer;
+       fZones = NULL;}
+
+   Bool_t   Range(const TFFltZone & zone, Double_t & min, Double_t & max) const
+                     {return ZoneRange(fCol, fZones, zone.fBlock, min, max);}
+   Bool_t   FindRange(Double_t min, Double_t max, TFBitmap & rows) const
+                     {return FindColRange(fCol, min, max, rows);}
+
+   const Double_t *  Eval(const UInt_t * rows, UInt_t, UInt_t num, Double_t * work) const
+      {
+         Double_t * out = Out(work);
+         const C & col = *fCol;
+         for (UInt_t i = 0; i < num; i++)
+            out[i] = (Double_t)col[rows[i]];
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+// one bin of an array column
+
+template <class C>
+   class TFFltArrCol : public TFFltNode
+{
+   const C  * fCol;     // the column
+   Int_t    fBin;       // the bin of the column used in the filter
+   mutable TFFltZones fZones;   // zone map of all bins of the column, NULL until it is used
+
+public:
+   TFFltArrCol(const C * col, Int_t bin)
+      {fCol = col; fBin = bin;
+       fInteger = std::numeric_limits<typename C::value_type>::is_integer;
+       fZones = NULL;}
+
+   Bool_t   Range(const TFFltZone & zone, Double_t & min, Double_t & max) const
+                     {return ZoneRange(fCol, fZones, zone.fBlock, min, max);}
+
+   const Double_t *  Eval(const UInt_t * rows, UInt_t, UInt_t num, Double_t * work) const
+      {
+         Double_t * out = Out(work);
+         const C & col = *fCol;
+         for (UInt_t i = 0; i < num; i++)
+            out[i] = (Double_t)col[rows[i]][fBin];
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+// a string constant or a string column. Both can only be used in
+// a comparison, they are replaced by a TFFltStrCmp
+
+class TFFltString : public TFFltNode
+{
+public:
+   const TFStringCol     * fCol;    // the string column or NULL
+   const TFDictStringCol * fDict;   // the dictionary encoded string column or NULL
+   TString               fStr;      // the string constant
+
+   TFFltString(const TFStringCol * col)     {fCol = col;  fDict = NULL;}
+   TFFltString(const TFDictStringCol * col) {fCol = NULL; fDict = col;}
+   TFFltString(const char * str) : fStr(str) {fCol = NULL; fDict = NULL;}
+
+   Bool_t            IsColumn() const     {return fCol != NULL || fDict != NULL;}
+   std::string_view  GetView(UInt_t row) const
+                        {return fCol ? fCol->GetView(row) : fDict->GetView(row);}
+
+   const Double_t *  Eval(const UInt_t *, UInt_t, UInt_t, Double_t *) const
+                                          {return NULL;}
+   Bool_t            IsString() const     {return kTRUE;}
+};
+
+//_____________________________________________________________________________
+
+static Double_t CompareResult(int comp, Int_t op)
+{
+   switch (op)
+      {
+      case kFltEq: return comp == 0;
+      case kFltNe: return comp != 0;
+      case kFltLe: return comp <= 0;
+      case kFltGe: return comp >= 0;
+      case kFltLt: return comp <  0;
+      default:     return comp >  0;
+      }
+}
+
+//_____________________________________________________________________________
+
+class TFFltStrCmp : public TFFltNode
+{
+   const TFFltString  * fStr1;   // left string column
+   const TFFltString  * fStr2;   // right string column or constant
+   Int_t              fOp;       // the comparison
+
+public:
+   TFFltStrCmp(const TFFltString * str1, const TFFltString * str2, Int_t op)
+      {fStr1 = str1; fStr2 = str2; fOp = op; fInteger = kTRUE;}
+
+   const Double_t *  Eval(const UInt_t * rows, UInt_t, UInt_t num, Double_t * work) const
+      {
+         Double_t * out = Out(work);
+         std::string_view str(fStr2->fStr.Data(), fStr2->fStr.Length());
+         for (UInt_t i = 0; i < num; i++)
+            {
+            int comp = fStr2->IsColumn() ? fStr1->GetView(rows[i]).compare(fStr2->GetView(rows[i])) :
+                                           fStr1->GetView(rows[i]).compare(str);
+            out[i] = CompareResult(comp, fOp);
+            }
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+// comparison of a dictionary encoded string column with a constant. The
+// result of each code of the dictionary is computed once, the rows only 
+// look up the result of their code
+
+class TFFltDictCmp : public TFFltNode
+{
+   const TFDictStringCol  * fCol;      // the string column
+   TString                fStr;      // the string constant
+   Int_t                  fOp;       // the comparison
+   std::vector <Double_t> fResult;   // result of each code
+
+public:
+   TFFltDictCmp(const TFDictStringCol * col, const char * str, Int_t op) 
+      : fStr(str), fResult(col->GetNumCodes())
+      {
+         fCol = col; fOp = op; fInteger = kTRUE;
+         for (UInt_t code = 0; code < fResult.size(); code++)
+            fResult[code] = CompareResult(col->GetCodeString(code).CompareTo(fStr), op);
+      }
+
+   const Double_t *  Eval(const UInt_t * rows, UInt_t, UInt_t num, Double_t * work) const
+      {
+         Double_t * out = Out(work);
+         const UInt_t * codes = fCol->GetCodes();
+         for (UInt_t i = 0; i < num; i++)
+            {
+            UInt_t code = codes[rows[i]];
+            // codes added after the compilation of the filter
+            out[i] = code < fResult.size() ? fResult[code] :
+                     CompareResult(fCol->GetCodeString(code).CompareTo(fStr), fOp);
+            }
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+
+class TFFltUnary : public TFFltNode
+{
+   TFFltNode   * fArg;     // the argument
+   Int_t       fOp;        // kFltNeg, kFltNot or kFltBitNot
+
+public:
+   TFFltUnary(Int_t op, TFFltNode * arg)
+      {fOp = op; fArg = arg; fInteger = op != kFltNeg || arg->fInteger;}
+
+   Bool_t   HasConstArgs() const {return fArg->IsConst();}
+
+   Bool_t   Range(const TFFltZone & zone, Double_t & min, Double_t & max) const
+      {
+         Double_t aMin, aMax;
+         if (fOp == kFltBitNot || !fArg->Range(zone, aMin, aMax))
+            return kFALSE;
+         if (fOp == kFltNeg)
+            {min = -aMax; max = -aMin;}
+         else
+            {min = aMin == 0 && aMax == 0; max = aMin <= 0 && aMax >= 0;}
+         return kTRUE;
+      }
+
+   const Double_t *  Eval(const UInt_t * rows, UInt_t first, UInt_t num, Double_t * work) const
+      {
+         const Double_t * a = fArg->Eval(rows, first, num, work);
+         Double_t * out = Out(work);
+         if (fOp == kFltNeg)
+            for (UInt_t i = 0; i < num; i++)
+               out[i] = -a[i];
+         else if (fOp == kFltNot)
+            for (UInt_t i = 0; i < num; i++)
+               out[i] = a[i] == 0;
+         else
+            for (UInt_t i = 0; i < num; i++)
+               out[i] = (Double_t)(~(Long64_t)a[i]);
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+
+class TFFltFunc : public TFFltNode
+{
+   const TFFltFuncDef   * fDef;    // the function
+   TFFltNode            * fArg1;   // first argument
+   TFFltNode            * fArg2;   // second argument or NULL
+
+public:
+   TFFltFunc(const TFFltFuncDef * def, TFFltNode * arg1, TFFltNode * arg2)
+      {fDef = def; fArg1 = arg1; fArg2 = arg2;
+       fInteger = def->fKeepInt && arg1->fInteger && (!arg2 || arg2->fInteger);}
+
+   Bool_t   HasConstArgs() const {return fArg1->IsConst() && (!fArg2 || fArg2->IsConst());}
+
+   const Double_t *  Eval(const UInt_t * rows, UInt_t first, UInt_t num, Double_t * work) const
+      {
+         const Double_t * a = fArg1->Eval(rows, first, num, work);
+         Double_t * out = Out(work);
+         if (fArg2)
+            {
+            const Double_t * b = fArg2->Eval(rows, first, num, work);
+            for (UInt_t i = 0; i < num; i++)
+               out[i] = fDef->fFunc2(a[i], b[i]);
+            }
+         else
+            for (UInt_t i = 0; i < num; i++)
+               out[i] = fDef->fFunc1(a[i]);
+         return out;
+      }
+};
+
+//_____________________________________________________________________________
+
+class TFFltBinary : public TFFltNode
+{
+   TFFltNode   * fLeft;    // left operand
+   TFFltNode   * fRight;   // right operand
+   Int_t       fOp;        // the operator
+
+public:
+   TFFltBinary(Int_t op, TFFltNode * left, TFFltNode * right);
+
+   Bool_t   HasConstArgs() const {return fLeft->IsConst() && fRight->IsConst();}
+
+   Bool_t   Range(const TFFltZone & zone, Double_t & min, Double_t & max) const;
+   Bool_t   FindRows(TFBitmap & rows) const;
+   const Double_t *  Eval(const UInt_t * rows, UInt_t first, UInt_t num, Double_t * work) const;
+};
+
+//_____________________________________________________________________________
+TFFltBinary::TFFltBinary(Int_t op, TFFltNode * left, TFFltNode * right)
+{
+   fOp    = op;
+   fLeft  = left;
+   fRight = right;
+
+   if (op >= kFltAdd)
+      fInteger = left->fInteger && right->fInteger;
+   else
+      // logical, bit and comparison operators
+      fInteger = kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFFltBinary::Range(const TFFltZone & zone, Double_t & min, Double_t & max) const
+{
+// Interval arithmetic of the logical, comparison, + and - operators. 
+// A logical operator has a known range if one argument decides the result.
+
+   Double_t aMin, aMax, bMin, bMax;
+   Bool_t   aKnown = fLeft->Range(zone, aMin, aMax);
+   Bool_t   bKnown = fRight->Range(zone, bMin, bMax);
+
+   // a known range of a logical argument: always false, always true
+   Bool_t aFalse = aKnown && aMin == 0 && aMax == 0;
+   Bool_t bFalse = bKnown && bMin == 0 && bMax == 0;
+   Bool_t aTrue  = aKnown && (aMin > 0 || aMax < 0);
+   Bool_t bTrue  = bKnown && (bMin > 0 || bMax < 0);
+
+   if (fOp == kFltAnd)
+      {
+      if (aFalse || bFalse)
+         {min = max = 0; return kTRUE;}
+      if (aTrue && bTrue)
+         {min = max = 1; return kTRUE;}
+      min = 0; max = 1;
+      return kTRUE;
+      }
+   if (fOp == kFltOr)
+      {
+      if (aTrue || bTrue)
+         {min = max = 1; return kTRUE;}
+      if (aFalse && bFalse)
+         {min = max = 0; return kTRUE;}
+      min = 0; max = 1;
+      return kTRUE;
+      }
+
+   if (!aKnown || !bKnown)
+      return kFALSE;
+
+   // the comparison is always true: 1, always false: 0 or unknown: -1
+   Int_t result = -1;
+   switch (fOp)
+      {
+      case kFltEq: result = aMin == aMax && bMin == bMax && aMin == bMin ? 1 :
+                            aMax < bMin || aMin > bMax ? 0 : -1;             break;
+      case kFltNe: result = aMax < bMin || aMin > bMax ? 1 :
+                            aMin == aMax && bMin == bMax && aMin == bMin ? 0 : -1; break;
+      case kFltLe: result = aMax <= bMin ? 1 : aMin >  bMax ? 0 : -1;       break;
+      case kFltGe: result = aMin >= bMax ? 1 : aMax <  bMin ? 0 : -1;       break;
+      case kFltLt: result = aMax <  bMin ? 1 : aMin >= bMax ? 0 : -1;       break;
+      case kFltGt: result = aMin >  bMax ? 1 : aMax <= bMin ? 0 : -1;       break;
+      case kFltAdd: min = aMin + bMin; max = aMax + bMax; return kTRUE;
+      case kFltSub: min = aMin - bMax; max = aMax - bMin; return kTRUE;
+      default:      return kFALSE;
+      }
+
+   min = result == 1 ? 1 : 0;
+   max = result == 0 ? 0 : 1;
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFFltBinary::FindRows(TFBitmap & rows) const
+{
+// The rows of a comparison of a column with an index or a bitmap index 
+// or of the row number with a constant are found without a scan of all 
+// rows. The rows of && and || are the intersection and the union of the
+// rows of their arguments.
+
+   if (fOp == kFltAnd || fOp == kFltOr)
+      {
+      TFBitmap right;
+      Bool_t hasLeft  = fLeft->FindRows(rows);
+      Bool_t hasRight = fRight->FindRows(right);
+
+      if (fOp == kFltAnd && hasLeft && hasRight)
+         rows.And(right);
+      else if (fOp == kFltAnd && hasRight)
+         std::swap(rows, right);
+      else if (fOp == kFltOr && hasLeft && hasRight)
+         rows.Or(right);
+      else
+         return fOp == kFltAnd && hasLeft;
+      return kTRUE;
+      }
+
+   if (fOp < kFltEq || fOp > kFltGt)
+      return kFALSE;
+
+   // the column or row on the left side, the constant on the right side
+   const TFFltNode * var = fLeft;
+   Double_t          val;
+   Int_t             op  = fOp;
+   if (fRight->IsConst())
+      fRight->Range(TFFltZone(), val, val);
+   else if (fLeft->IsConst())
+      {
+      fLeft->Range(TFFltZone(), val, val);
+      var = fRight;
+      op  = op == kFltLe ? kFltGe : op == kFltGe ? kFltLe :
+            op == kFltLt ? kFltGt : op == kFltGt ? kFltLt : op;
+      }
+   else
+      return kFALSE;
+
+   if (std::isnan(val))
+      return kFALSE;
+
+   const Double_t kInf = std::numeric_limits<Double_t>::infinity();
+   Double_t below = nextafter(val, -kInf);
+   Double_t above = nextafter(val,  kInf);
+   switch (op)
+      {
+      case kFltEq: return var->FindRange(val, val, rows);
+      case kFltLe: return var->FindRange(-kInf, val, rows);
+      case kFltLt: return var->FindRange(-kInf, below, rows);
+      case kFltGe: return var->FindRange(val, kInf, rows);
+      case kFltGt: return var->FindRange(above, kInf, rows);
+      }
+
+   // != : the rows below and above the constant
+   TFBitmap upper;
+   if (!var->FindRange(-kInf, below, rows) || !var->FindRange(above, kInf, upper))
+      return kFALSE;
+   rows.Or(upper);
+   return kTRUE;
+}
+//_____________________________________________________________________________
+const Double_t * TFFltBinary::Eval(const UInt_t * rows, UInt_t first, UInt_t num,
+                                   Double_t * work) const
+{
+   const Double_t * a = fLeft->Eval(rows, first, num, work);
+   const Double_t * b = fRight->Eval(rows, first, num, work);
+   Double_t * out = Out(work);
+   UInt_t i;
+
+   switch (fOp)
+      {
+      case kFltOr:     for (i = 0; i < num; i++) out[i] = (a[i] != 0) | (b[i] != 0); break;
+      case kFltAnd:    for (i = 0; i < num; i++) out[i] = (a[i] != 0) & (b[i] != 0); break;
+      case kFltBitOr:  for (i = 0; i < num; i++) out[i] = (Double_t)((Long64_t)a[i] | (Long64_t)b[i]); break;
+      case kFltBitXor: for (i = 0; i < num; i++) out[i] = (Double_t)((Long64_t)a[i] ^ (Long64_t)b[i]); break;
+      case kFltBitAnd: for (i = 0; i < num; i++) out[i] = (Double_t)((Long64_t)a[i] & (Long64_t)b[i]); break;
+      case kFltEq:     for (i = 0; i < num; i++) out[i] = a[i] == b[i]; break;
+      case kFltNe:     for (i = 0; i < num; i++) out[i] = a[i] != b[i]; break;
+      case kFltLe:     for (i = 0; i < num; i++) out[i] = a[i] <= b[i]; break;
+      case kFltGe:     for (i = 0; i < num; i++) out[i] = a[i] >= b[i]; break;
+      case kFltLt:     for (i = 0; i < num; i++) out[i] = a[i] <  b[i]; break;
+      case kFltGt:     for (i = 0; i < num; i++) out[i] = a[i] >  b[i]; break;
+      case kFltAdd:    for (i = 0; i < num; i++) out[i] = a[i] + b[i]; break;
+      case kFltSub:    for (i = 0; i < num; i++) out[i] = a[i] - b[i]; break;
+      case kFltMul:    for (i = 0; i < num; i++) out[i] = a[i] * b[i]; break;
+      case kFltDiv:
+         if (fInteger)
+            // integer division as in c, but without a crash if b == 0
+            for (i = 0; i < num; i++)
+               out[i] = b[i] != 0 ? trunc(a[i] / b[i]) : 0;
+         else
+            for (i = 0; i < num; i++)
+               out[i] = a[i] / b[i];
+         break;
+      case kFltMod:
+         if (fInteger)
+            for (i = 0; i < num; i++)
+               out[i] = b[i] != 0 ? fmod(a[i], b[i]) : 0;
+         else
+            for (i = 0; i < num; i++)
+               out[i] = fmod(a[i], b[i]);
+         break;
+      }
+
+   return out;
+}
+
+//_____________________________________________________________________________
+//_____________________________________________________________________________
+
+template <class C>
+static Bool_t MakeFltCol(const TFBaseCol * col, TFFltNode *& node)
+{
+   const C * c = dynamic_cast<const C *>(col);
+   if (c)
+      node = new TFFltCol<C>(c);
+   return c != NULL;
+}
+
+template <class C>
+static Bool_t MakeFltArrCol(const TFBaseCol * col, Int_t bin, TFFltNode *& node)
+{
+   const C * c = dynamic_cast<const C *>(col);
+   if (c)
+      node = new TFFltArrCol<C>(c, bin);
+   return c != NULL;
+}
+
+//_____________________________________________________________________________
+//_____________________________________________________________________________
+TFFilter::TFFilter(const TFTable * table)
+{
+// The filter can be used for the rows of table. Call Compile() before
+// Select().
+
+   fTable    = table;
+   fRoot     = NULL;
+   fNumSlots = 0;
+   fPos      = NULL;
+   fUseRowIndex = kFALSE;
+}
+//_____________________________________________________________________________
+TFFilter::~TFFilter()
+{
+   for (std::vector<TFFltNode*>::iterator i_node = fNodes.begin();
+        i_node != fNodes.end(); i_node++)
+      delete *i_node;
+}
+//_____________________________________________________________________________
+Bool_t TFFilter::Compile(const char * filter)
+{
+// Compiles the filter string. The columns used in the filter are
+// read from the file if they are not yet in memory.
+// Returns kFALSE and writes an error message into the error stack
+// ( see TFError ) if there is a syntax error in the filter string or
+// if a used column does not exist in the table.
+
+   for (std::vector<TFFltNode*>::iterator i_node = fNodes.begin();
+        i_node != fNodes.end(); i_node++)
+      delete *i_node;
+   fNodes.clear();
+   fRoot     = NULL;
+   fNumSlots = 0;
+   fError    = "";
+   fUseRowIndex = kFALSE;
+
+   fFilter = filter ? filter : "";
+   fPos    = fFilter.Data();
+
+   TFFltNode * root = ParseLevel(0);
+   if (root)
+      {
+      SkipBlanks();
+      if (fPos[0] == '=' && fPos[1] != '=')
+         root = SetParseError("use == to compare two values");
+      else if (*fPos)
+         root = SetParseError("unexpected character '%c'", *fPos);
+      else if (root->IsString())
+         root = SetParseError("a string is not a valid filter");
+      }
+
+   if (root == NULL)
+      {
+      TFError::SetError("TFFilter::Compile",
+               "Error at position %d of the filter \"%s\": %s",
+               (int)(fPos - fFilter.Data()), fFilter.Data(), fError.Data());
+      return kFALSE;
+      }
+
+   // every node gets its own buffer for kBatch results
+   for (std::vector<TFFltNode*>::iterator i_node = fNodes.begin();
+        i_node != fNodes.end(); i_node++)
+      if (!(*i_node)->IsConst() && !(*i_node)->IsString())
+         (*i_node)->fSlot = fNumSlots++;
+
+   fRoot = root;
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFFilter::FindRows(TFBitmap & rows) const
+{
+// Sets rows to the rows of the table which may pass the filter. These
+// rows are found without a scan of all rows for comparisons of the row
+// number, of columns with an index ( see TFBaseCol::HasIndex() ) or with
+// a bitmap index ( see TFBaseCol::HasBitmapIndex() ) with constants. 
+// Select() is still needed to evaluate the other parts of the filter.
+// Returns kFALSE if the filter has no such comparisons or if it uses
+// "row_". In this case all rows have to be evaluated by Select().
+// This function is not thread safe, it may build the index of a column.
+
+   if (fRoot == NULL || fUseRowIndex)
+      return kFALSE;
+
+   return fRoot->FindRows(rows);
+}
+//_____________________________________________________________________________
+UInt_t TFFilter::Select(UInt_t * rows, UInt_t numRows, UInt_t first) const
+{
+// Evaluates the compiled filter for the numRows row numbers in rows.
+// The row numbers of the rows that pass the filter are moved to the
+// beginning of rows, their order is not changed. The function returns
+// the number of rows that passed the filter.
+// first is the value of the variable "row_" for rows[0].
+// This function can be called at the same time from different threads.
+
+   if (fRoot == NULL)
+      return numRows;
+
+   std::vector<Double_t> work(fNumSlots * kBatch + 1);
+   UInt_t tableRows = fTable->GetNumRows();
+   // the rows of a batch are in one block of the zone maps only if the
+   // rows are in ascending order, not for a sorted or permuted iterator
+   Bool_t useZones  = tableRows > TFBaseCol::kZoneRows &&
+                      std::is_sorted(rows, rows + numRows);
+
+   UInt_t to = 0;
+   UInt_t start = 0;
+   while (start < numRows)
+      {
+      UInt_t num = numRows - start < kBatch ? numRows - start : kBatch;
+
+      if (useZones)
+         {
+         // the rows of one batch in the same block of the zone maps. If the
+         // range of the filter result is known for this block, the rows
+         // are not evaluated
+         TFFltZone zone;
+         zone.fBlock = rows[start] / TFBaseCol::kZoneRows;
+         UInt_t n = 1;
+         while (n < num && rows[start + n] / TFBaseCol::kZoneRows == zone.fBlock)
+            n++;
+         num = n;
+
+         zone.fFirstRow   = (Double_t)zone.fBlock * TFBaseCol::kZoneRows;
+         zone.fLastRow    = std::min(zone.fFirstRow + TFBaseCol::kZoneRows, (Double_t)tableRows) - 1;
+         zone.fFirstIndex = first + start;
+         zone.fLastIndex  = first + start + num - 1;
+
+         Double_t min, max;
+         if (fRoot->Range(zone, min, max))
+            {
+            if (min == 0 && max == 0)
+               {
+               // no row can pass the filter
+               start += num;
+               continue;
+               }
+            if (min > 0 || max < 0)
+               {
+               // all rows pass the filter
+               memmove(rows + to, rows + start, num * sizeof(UInt_t));
+               to    += num;
+               start += num;
+               continue;
+               }
+            }
+         }
+
+      const Double_t * result = fRoot->Eval(rows + start, first + start, num, &work[0]);
+
+      for (UInt_t i = 0; i < num; i++)
+         if (result[i] != 0)
+            rows[to++] = rows[start + i];
+
+      start += num;
+      }
+
+   return to;
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::Add(TFFltNode * node)
+{
+// the filter adopts the node
+
+   fNodes.push_back(node);
+   return node;
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::Fold(TFFltNode * node)
+{
+// replaces a node with only constant arguments by a constant
+
+   if (!node->HasConstArgs())
+      return node;
+
+   Double_t work[kBatch];
+   node->fSlot = 0;
+   UInt_t row = 0;
+   Double_t val = node->Eval(&row, 0, 1, work)[0];
+
+   return Add(new TFFltConst(val, node->fInteger));
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::SetParseError(const char * errorMsg, ...)
+{
+// stores the first error of the parser. Returns always NULL
+
+   if (fError.Length() == 0)
+      {
+      char hstr[500];
+      va_list vaList;
+      va_start(vaList, errorMsg);
+      vsnprintf(hstr, sizeof(hstr), errorMsg, vaList);
+      va_end(vaList);
+      fError = hstr;
+      }
+   return NULL;
+}
+//_____________________________________________________________________________
+void TFFilter::SkipBlanks()
+{
+   while (isspace(*fPos))
+      fPos++;
+}
+//_____________________________________________________________________________
+Bool_t TFFilter::Match(char c)
+{
+   SkipBlanks();
+   if (*fPos != c)
+      return kFALSE;
+   fPos++;
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Int_t TFFilter::MatchOp(Int_t level)
+{
+// returns the binary operator of precedence level at the actual position
+// and moves the position behind the operator. Returns -1 if there is
+// no operator of this level.
+
+   SkipBlanks();
+   for (const TFFltOpDef * def = gFltOps; def->fName; def++)
+      {
+      if (def->fLevel != level)
+         continue;
+
+      size_t len = strlen(def->fName);
+      if (strncmp(fPos, def->fName, len) != 0)
+         continue;
+
+      // do not split the operators &&, ||, << and >>
+      if (len == 1 && fPos[1] == fPos[0] && strchr("&|<>", fPos[0]))
+         continue;
+
+      fPos += len;
+      return def->fOp;
+      }
+
+   return -1;
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::ParseLevel(Int_t level)
+{
+// parses all binary operators of precedence level and higher
+
+   if (level == kFltNumLevels)
+      return ParseUnary();
+
+   TFFltNode * left = ParseLevel(level + 1);
+   Int_t op;
+   while (left && (op = MatchOp(level)) >= 0)
+      {
+      TFFltNode * right = ParseLevel(level + 1);
+      if (right == NULL)
+         return NULL;
+      left = MakeBinary(op, left, right);
+      }
+
+   return left;
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::ParseUnary()
+{
+   Int_t op;
+
+   SkipBlanks();
+   if      (fPos[0] == '-')                   op = kFltNeg;
+   else if (fPos[0] == '!' && fPos[1] != '=') op = kFltNot;
+   else if (fPos[0] == '~')                   op = kFltBitNot;
+   else if (fPos[0] == '+')                   op = -1;
+   else
+      return ParsePrimary();
+
+   fPos++;
+   TFFltNode * arg = ParseUnary();
+   if (arg == NULL || op < 0)
+      return arg;
+
+   if (arg->IsString())
+      return SetParseError("invalid operator for a string");
+
+   return Fold(Add(new TFFltUnary(op, arg)));
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::ParsePrimary()
+{
+   SkipBlanks();
+
+   if (Match('('))
+      {
+      TFFltNode * node = ParseLevel(0);
+      if (node && !Match(')'))
+         return SetParseError("')' expected");
+      return node;
+      }
+
+   if (isdigit(fPos[0]) || (fPos[0] == '.' && isdigit(fPos[1])))
+      return ParseNumber();
+
+   if (fPos[0] == '"')
+      {
+      // a string constant
+      TString str;
+      for (fPos++; *fPos && *fPos != '"'; fPos++)
+         {
+         if (*fPos == '\\' && fPos[1])
+            fPos++;
+         str += *fPos;
+         }
+      if (*fPos != '"')
+         return SetParseError("missing '\"' at the end of a string");
+      fPos++;
+      return Add(new TFFltString(str.Data()));
+      }
+
+   if (fPos[0] == '\'')
+      {
+      // a character constant
+      char c = fPos[1];
+      fPos += 2;
+      if (c == '\\')
+         {
+         switch (*fPos++)
+            {
+            case 'n':  c = '\n'; break;
+            case 't':  c = '\t'; break;
+            case '0':  c = '\0'; break;
+            default:   c = fPos[-1]; break;
+            }
+         }
+      if (*fPos != '\'')
+         return SetParseError("invalid character constant");
+      fPos++;
+      return Add(new TFFltConst(c, kTRUE));
+      }
+
+   if (isalpha(fPos[0]) || fPos[0] == '_')
+      {
+      const char * start = fPos;
+      while (isalnum(*fPos) || *fPos == '_' || (fPos[0] == ':' && fPos[1] == ':'))
+         fPos += *fPos == ':' ? 2 : 1;
+      TString name(start, fPos - start);
+
+      if (Match('('))
+         return ParseFunction(name);
+
+      if (name == "row")
+         return Add(new TFFltRow(fTable->GetNumRows()));
+      if (name == "row_")
+         {
+         fUseRowIndex = kTRUE;
+         return Add(new TFFltRowIndex);
+         }
+      if (name == "kTRUE" || name == "true")
+         return Add(new TFFltConst(1, kTRUE));
+      if (name == "kFALSE" || name == "false")
+         return Add(new TFFltConst(0, kTRUE));
+
+      Int_t bin = 0;
+      if (Match('['))
+         {
+         SkipBlanks();
+         char * end;
+         bin = (Int_t)strtol(fPos, &end, 0);
+         if (end == fPos || bin < 0)
+            return SetParseError("invalid bin number of column %s", name.Data());
+         fPos = end;
+         if (!Match(']'))
+            return SetParseError("']' expected");
+         }
+
+      return MakeColumn(name, bin);
+      }
+
+   if (*fPos == 0)
+      return SetParseError("unexpected end of the filter");
+
+   return SetParseError("unexpected character '%c'", *fPos);
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::ParseNumber()
+{
+   char * end;
+   Double_t val;
+   Bool_t integer;
+
+   if (fPos[0] == '0' && (fPos[1] == 'x' || fPos[1] == 'X'))
+      {
+      val = (Double_t)strtoull(fPos, &end, 16);
+      integer = kTRUE;
+      }
+   else
+      {
+      val = strtod(fPos, &end);
+      integer = strcspn(fPos, ".eE") >= (size_t)(end - fPos);
+      }
+   fPos = end;
+
+   // skip the c - suffixes of numbers
+   while (*fPos && strchr("uUlLfF", *fPos))
+      {
+      if (*fPos == 'f' || *fPos == 'F')
+         integer = kFALSE;
+      fPos++;
+      }
+
+   if (isalnum(*fPos) || *fPos == '_')
+      return SetParseError("invalid number");
+
+   return Add(new TFFltConst(val, integer));
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::ParseFunction(const TString & name)
+{
+// parses the arguments of a function. The opening ( is already read.
+
+   TString fName = name;
+   if (fName.BeginsWith("TMath::"))
+      fName.Remove(0, 7);
+   else if (fName.BeginsWith("std::"))
+      fName.Remove(0, 5);
+
+   const TFFltFuncDef * def = gFltFuncs;
+   while (def->fName && fName != def->fName)
+      def++;
+   if (def->fName == NULL)
+      return SetParseError("unknown function %s", name.Data());
+
+   TFFltNode * arg1 = ParseLevel(0);
+   TFFltNode * arg2 = NULL;
+   if (arg1 == NULL)
+      return NULL;
+
+   if (def->fFunc2)
+      {
+      if (!Match(','))
+         return SetParseError("function %s needs two arguments", name.Data());
+      if ((arg2 = ParseLevel(0)) == NULL)
+         return NULL;
+      }
+   if (!Match(')'))
+      return SetParseError("')' expected");
+
+   if (arg1->IsString() || (arg2 && arg2->IsString()))
+      return SetParseError("invalid string argument of function %s", name.Data());
+
+   return Fold(Add(new TFFltFunc(def, arg1, arg2)));
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::MakeColumn(const TString & name, Int_t bin)
+{
+// creates the node of one column. The column is read from the file
+// if it is not yet in memory.
+
+   TFBaseCol * col = NULL;
+
+   TFErrorType errT = TFError::GetErrorType();
+   TFError::SetErrorType(kExceptionErr);
+   try{
+      col = &fTable->GetColumn(name.Data());
+      }
+   catch (TFException)
+      {
+      col = NULL;
+      }
+   TFError::SetErrorType(errT);
+
+   if (col == NULL)
+      return SetParseError("column %s does not exist in table %s",
+                           name.Data(), fTable->GetName());
+
+   TFStringCol * strCol = dynamic_cast<TFStringCol*>(col);
+   if (strCol)
+      {
+      if (bin != 0)
+         return SetParseError("column %s has only one value per row", name.Data());
+      return Add(new TFFltString(strCol));
+      }
+
+   TFDictStringCol * dictCol = dynamic_cast<TFDictStringCol*>(col);
+   if (dictCol)
+      {
+      if (bin != 0)
+         return SetParseError("column %s has only one value per row", name.Data());
+      return Add(new TFFltString(dictCol));
+      }
+
+   TFFltNode * node = NULL;
+   if (MakeFltCol<TFBoolCol>     (col, node) ||
+       MakeFltCol<TFCharCol>     (col, node) ||
+       MakeFltCol<TFUCharCol>    (col, node) ||
+       MakeFltCol<TFShortCol>    (col, node) ||
+       MakeFltCol<TFUShortCol>   (col, node) ||
+       MakeFltCol<TFIntCol>      (col, node) ||
+       MakeFltCol<TFUIntCol>     (col, node) ||
+       MakeFltCol<TFFloatCol>    (col, node) ||
+       MakeFltCol<TFDoubleCol>   (col, node)   )
+      {
+      Add(node);
+      if (bin != 0)
+         return SetParseError("column %s has only one value per row", name.Data());
+      return node;
+      }
+
+   if (bin >= col->GetNumBins())
+      return SetParseError("bin %d of column %s does not exist", bin, name.Data());
+
+   if (MakeFltArrCol<TFBoolArrCol>  (col, bin, node) ||
+       MakeFltArrCol<TFCharArrCol>  (col, bin, node) ||
+       MakeFltArrCol<TFUCharArrCol> (col, bin, node) ||
+       MakeFltArrCol<TFShortArrCol> (col, bin, node) ||
+       MakeFltArrCol<TFUShortArrCol>(col, bin, node) ||
+       MakeFltArrCol<TFIntArrCol>   (col, bin, node) ||
+       MakeFltArrCol<TFUIntArrCol>  (col, bin, node) ||
+       MakeFltArrCol<TFFloatArrCol> (col, bin, node) ||
+       MakeFltArrCol<TFDoubleArrCol>(col, bin, node)   )
+      return Add(node);
+
+   return SetParseError("column %s of type %s cannot be used in a filter",
+                        name.Data(), col->GetColTypeName());
+}
+//_____________________________________________________________________________
+TFFltNode * TFFilter::MakeBinary(Int_t op, TFFltNode * left, TFFltNode * right)
+{
+// creates the node of a binary operator. Operators with two constant
+// arguments are replaced by a constant.
+
+   if (left->IsString() || right->IsString())
+      {
+      if (op < kFltEq || op > kFltGt)
+         return SetParseError("invalid operator for a string");
+      if (!left->IsString() || !right->IsString())
+         return SetParseError("a string can only be compared with a string");
+
+      TFFltString * lStr = (TFFltString*)left;
+      TFFltString * rStr = (TFFltString*)right;
+      if (!lStr->IsColumn() && !rStr->IsColumn())
+         return SetParseError("comparison of two string constants");
+
+      if (!lStr->IsColumn())
+         {
+         // the column has to be the left argument: "abc" < col  ->  col > "abc"
+         TFFltString * tmp = lStr; lStr = rStr; rStr = tmp;
+         switch (op)
+            {
+            case kFltLe: op = kFltGe; break;
+            case kFltGe: op = kFltLe; break;
+            case kFltLt: op = kFltGt; break;
+            case kFltGt: op = kFltLt; break;
+            }
+         }
+      if (lStr->fDict && !rStr->IsColumn())
+         return Add(new TFFltDictCmp(lStr->fDict, rStr->fStr.Data(), op));
+      return Add(new TFFltStrCmp(lStr, rStr, op));
+      }
+
+   return Fold(Add(new TFFltBinary(op, left, right)));
+}
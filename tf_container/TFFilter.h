@@ -0,0 +1,71 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFFilter.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFFilter
+#define ROOT_TFFilter
+
+#include <vector>
+
+#ifndef ROOT_TFTable
+#include "TFTable.h"
+#endif
+
+
+class TFFltNode;
+class TFBitmap;
+
+//_____________________________________________________________________________
+
+class TFFilter
+{
+public:
+   enum {kBatch = 1024};                  // number of rows evaluated in one step
+
+private:
+   const TFTable              * fTable;   // the table of the filtered rows
+   TString                    fFilter;    // the filter string
+   std::vector <TFFltNode*>   fNodes;     // all nodes of the compiled filter
+   TFFltNode                  * fRoot;    // top node of the compiled filter
+   Int_t                      fNumSlots;  // number of buffers for intermediate results
+   Bool_t                     fUseRowIndex; // kTRUE if the filter uses "row_"
+
+   const char                 * fPos;     //! actual parser position in fFilter
+   TString                    fError;     //! first error of the parser
+
+   TFFilter(const TFFilter & filter);
+   TFFilter & operator = (const TFFilter & filter);
+
+public:
+   TFFilter(const TFTable * table);
+   ~TFFilter();
+
+   Bool_t       Compile(const char * filter);
+   Bool_t       FindRows(TFBitmap & rows) const;
+   UInt_t       Select(UInt_t * rows, UInt_t numRows, UInt_t first = 0) const;
+
+   const char * GetFilter() const   {return fFilter.Data();}
+
+private:
+   TFFltNode *  Add(TFFltNode * node);
+   TFFltNode *  Fold(TFFltNode * node);
+   TFFltNode *  SetParseError(const char * errorMsg, ...);
+   void         SkipBlanks();
+   Int_t        MatchOp(Int_t level);
+   Bool_t       Match(char c);
+
+   TFFltNode *  ParseLevel(Int_t level);
+   TFFltNode *  ParseUnary();
+   TFFltNode *  ParsePrimary();
+   TFFltNode *  ParseNumber();
+   TFFltNode *  ParseFunction(const TString & name);
+   TFFltNode *  MakeColumn(const TString & name, Int_t bin);
+   TFFltNode *  MakeBinary(Int_t op, TFFltNode * left, TFFltNode * right);
+};
+
+#endif
@@ -33,6 +33,8 @@
 #include <math.h>
 #include <map>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "TFFitsIO.h"
 #include "TFError.h"
@@ -80,7 +82,9 @@ static const char * errMsg[] = {
 static int CreateFitsColumn(fitsfile * fptr, const TFBaseCol & col);
 template<class B, class C> int WriteFitsColumn(fitsfile * fptr, C & col);
 template<class B, class C> int WriteFitsArrColumn(fitsfile * fptr, C & col);
-static int WriteStringFitsColumn(fitsfile * fptr, TFStringCol & col);
+template<class B, class C> int WriteFitsVarArrColumn(fitsfile * fptr, C & col);
+template <class C>
+static int WriteStringFitsColumn(fitsfile * fptr, C & col);
 static int WriteFitsGroupColumn(fitsfile * fptr, TFGroupCol & col);
 
 
@@ -112,6 +116,11 @@ static TFBaseCol * FloatArrColFits2Root(fitsfile * fptr, int col,
 static TFBaseCol * DoubleArrColFits2Root(fitsfile * fptr, int col, 
                         const char * colName, long numRows, long repeat, int * status);
 
+static TClass * VarArrColClass(fitsfile * fptr, int col, int typecode, 
+                        const char ** typeName);
+static TFBaseCol * VarArrColFits2Root(fitsfile * fptr, int col, 
+                        const char * colName, long numRows, int typecode, int * status);
+
 
 //_____________________________________________________________________________
 static void InitFitsColDef()
@@ -144,6 +153,8 @@ static void InitFitsColDef()
 
    _fitsColDef[TFStringCol::Class()] =    FitsColDef("A", TSTRING,    0,             0);
 
+   _fitsColDef[TFDictStringCol::Class()] = FitsColDef("A", TSTRING,   0,             0);
+
 
    _fitsColDef[TFBoolArrCol::Class()] =   FitsColDef("L" , TLOGICAL,  0,             0);
                                                                     
@@ -162,6 +173,25 @@ static void InitFitsColDef()
    _fitsColDef[TFFloatArrCol::Class()] =  FitsColDef("E" , TFLOAT,    0,             0);
                                                                     
    _fitsColDef[TFDoubleArrCol::Class()] = FitsColDef("D" , TDOUBLE,   0,             0);
+
+
+   _fitsColDef[TFBoolVarArrCol::Class()] =   FitsColDef("L" , TLOGICAL,  0,             0);
+
+   _fitsColDef[TFCharVarArrCol::Class()] =   FitsColDef("B" , TSHORT,    0,             32767);
+
+   _fitsColDef[TFUCharVarArrCol::Class()] =  FitsColDef("B" , TBYTE,     0,             255);
+
+   _fitsColDef[TFShortVarArrCol::Class()] =  FitsColDef("I" , TSHORT,    0,             32767);
+
+   _fitsColDef[TFUShortVarArrCol::Class()] = FitsColDef("U" , TUSHORT,   32768,         32767);
+
+   _fitsColDef[TFIntVarArrCol::Class()] =    FitsColDef("J" , TINT,      0,             2147483647);
+
+   _fitsColDef[TFUIntVarArrCol::Class()] =   FitsColDef("V" , TUINT,     2147483648LL,  2147483647);
+
+   _fitsColDef[TFFloatVarArrCol::Class()] =  FitsColDef("E" , TFLOAT,    0,             0);
+
+   _fitsColDef[TFDoubleVarArrCol::Class()] = FitsColDef("D" , TDOUBLE,   0,             0);
 }                                                                   
 
 //_____________________________________________________________________________
@@ -365,7 +395,11 @@ TFBaseCol * TFFitsIO::ReadCol(const char * name)
 
    // copy the FITS column into a ROOT column
    TFBaseCol * rootCol = NULL;
-   if (repeat == 1)
+   if (typecode < 0)
+      // variable length array with descriptors into the heap
+      rootCol = VarArrColFits2Root(fptr, col, name, numRows, typecode, &status);
+
+   else if (repeat == 1)
       {
       if (typecode == TSTRING)
          rootCol = StringColFits2Root(fptr, col, name, numRows, width, &status);
@@ -464,7 +498,11 @@ void TFFitsIO::ReadAllCol(ColList & columns)
          continue;
 
       TFBaseCol * rootCol = NULL;
-      if (repeat == 1)
+      if (typecode < 0)
+         // variable length array with descriptors into the heap
+         rootCol = VarArrColFits2Root(fptr, col, colName + 1, numRows, typecode, &status);
+
+      else if (repeat == 1)
          {
          if (typecode == TSTRING)
             rootCol = StringColFits2Root(fptr, col, colName + 1, numRows, width, &status);
@@ -645,6 +683,8 @@ Int_t TFFitsIO::SaveColumns(ColList & columns, Int_t compLevel)
                      (fptr, dynamic_cast<TFDoubleCol&>(i_c->GetCol()) ); 
       else if (i_c->GetCol().IsA() == TFStringCol::Class())
          status = WriteStringFitsColumn(fptr, dynamic_cast<TFStringCol&>(i_c->GetCol()) );
+      else if (i_c->GetCol().IsA() == TFDictStringCol::Class())
+         status = WriteStringFitsColumn(fptr, dynamic_cast<TFDictStringCol&>(i_c->GetCol()) );
 
       else if (i_c->GetCol().IsA() == TFBoolArrCol::Class())
          status = WriteFitsArrColumn<char>
@@ -673,6 +713,35 @@ Int_t TFFitsIO::SaveColumns(ColList & columns, Int_t compLevel)
       else if (i_c->GetCol().IsA() == TFDoubleArrCol::Class())
          status = WriteFitsArrColumn<TFDoubleArrCol::value_type>
                      (fptr, dynamic_cast<TFDoubleArrCol&>(i_c->GetCol()) ); 
+
+      else if (i_c->GetCol().IsA() == TFBoolVarArrCol::Class())
+         status = WriteFitsVarArrColumn<char>
+                     (fptr, dynamic_cast<TFBoolVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFCharVarArrCol::Class())
+         status = WriteFitsVarArrColumn<short>
+                     (fptr, dynamic_cast<TFCharVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFUCharVarArrCol::Class())
+         status = WriteFitsVarArrColumn<TFUCharVarArrCol::value_type>
+                     (fptr, dynamic_cast<TFUCharVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFShortVarArrCol::Class())
+         status = WriteFitsVarArrColumn<TFShortVarArrCol::value_type>
+                     (fptr, dynamic_cast<TFShortVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFUShortVarArrCol::Class())
+         status = WriteFitsVarArrColumn<TFUShortVarArrCol::value_type>
+                     (fptr, dynamic_cast<TFUShortVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFIntVarArrCol::Class())
+         status = WriteFitsVarArrColumn<TFIntVarArrCol::value_type>
+                     (fptr, dynamic_cast<TFIntVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFUIntVarArrCol::Class())
+         status = WriteFitsVarArrColumn<TFUIntVarArrCol::value_type>
+                     (fptr, dynamic_cast<TFUIntVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFFloatVarArrCol::Class())
+         status = WriteFitsVarArrColumn<TFFloatVarArrCol::value_type>
+                     (fptr, dynamic_cast<TFFloatVarArrCol&>(i_c->GetCol()) ); 
+      else if (i_c->GetCol().IsA() == TFDoubleVarArrCol::Class())
+         status = WriteFitsVarArrColumn<TFDoubleVarArrCol::value_type>
+                     (fptr, dynamic_cast<TFDoubleVarArrCol&>(i_c->GetCol()) ); 
+
       else if (i_c->GetCol().IsA() == TFGroupCol::Class())
          status = WriteFitsGroupColumn(fptr, dynamic_cast<TFGroupCol&>(i_c->GetCol()) );
 
@@ -690,6 +759,22 @@ Int_t TFFitsIO::SaveColumns(ColList & columns, Int_t compLevel)
    return 0;
 }
 //_____________________________________________________________________________
+template <class C>
+static Bool_t GetVarArrSize(const TFBaseCol & col, UInt_t & maxSize, 
+                            ULong64_t & numValues)
+{
+// sets the size of the largest row and the number of all values of col
+// if col is a column of type C.
+
+   const C * c = dynamic_cast<const C *>(&col);
+   if (c)
+      {
+      maxSize   = c->GetMaxRowSize();
+      numValues = c->GetOffsets()[c->GetNumRows()];
+      }
+   return c != NULL;
+}
+//_____________________________________________________________________________
 static int CreateFitsColumn(fitsfile * fptr, const TFBaseCol & col)
 {
 // create one new column int FITS table and sets offset for unsigend int
@@ -705,10 +790,10 @@ static int CreateFitsColumn(fitsfile * fptr, const TFBaseCol & col)
    FitsColDef & fcd = i_fcd->second;
 
    int status = 0;
-   char tform[10];
+   char tform[40];
 
    // string columns are somehting special
-   if (col.IsA() == TFStringCol::Class())
+   if (col.IsA() == TFStringCol::Class() || col.IsA() == TFDictStringCol::Class())
       {
       TFErrorType prevErrType = TFError::GetErrorType();
       TFError::SetErrorType(kExceptionErr);
@@ -719,15 +804,36 @@ static int CreateFitsColumn(fitsfile * fptr, const TFBaseCol & col)
          }
       catch (TFException) {
          // we have to find the maximum size of the strings
-         const TFStringCol & strCol = dynamic_cast<const TFStringCol&>(col);
-         length = 1;
-         for (UInt_t row = 0; row < col.GetNumRows(); row++)
-            if (length < strCol[row].Length())
-               length = strCol[row].Length();
+         if (col.IsA() == TFStringCol::Class())
+            length = dynamic_cast<const TFStringCol&>(col).GetMaxLength();
+         else
+            length = dynamic_cast<const TFDictStringCol&>(col).GetMaxLength();
+         if (length < 1)
+            length = 1;
          }
       TFError::SetErrorType(prevErrType);
       sprintf(tform, "%u%s", length, fcd.tform);
       }
+   else if (col.GetNumBins() < 0)
+      {
+      // variable length array. The heap needs 64 bit descriptors (Q) if
+      // it is larger than 2GB, otherwise 32 bit descriptors (P) are used
+      UInt_t    maxSize   = 0;
+      ULong64_t numValues = 0;
+      if (!GetVarArrSize<TFBoolVarArrCol>   (col, maxSize, numValues) &&
+          !GetVarArrSize<TFCharVarArrCol>   (col, maxSize, numValues) &&
+          !GetVarArrSize<TFUCharVarArrCol>  (col, maxSize, numValues) &&
+          !GetVarArrSize<TFShortVarArrCol>  (col, maxSize, numValues) &&
+          !GetVarArrSize<TFUShortVarArrCol> (col, maxSize, numValues) &&
+          !GetVarArrSize<TFIntVarArrCol>    (col, maxSize, numValues) &&
+          !GetVarArrSize<TFUIntVarArrCol>   (col, maxSize, numValues) &&
+          !GetVarArrSize<TFFloatVarArrCol>  (col, maxSize, numValues) &&
+          !GetVarArrSize<TFDoubleVarArrCol> (col, maxSize, numValues)    )
+         return -1;
+      sprintf(tform, "1%c%s(%u)", 
+              numValues * col.GetWidth() < 0x80000000ULL ? 'P' : 'Q', 
+              fcd.tform, maxSize);
+      }
    else
       sprintf(tform, "%d%s", col.GetNumBins(), fcd.tform);
 
@@ -737,8 +843,9 @@ static int CreateFitsColumn(fitsfile * fptr, const TFBaseCol & col)
    colNum++;
    fits_insert_col(fptr, colNum, (char*)col.GetName(), tform, &status);
 
-   if (col.IsA() == TFCharCol::Class() ||
-       col.IsA() == TFCharArrCol::Class() )
+   if (col.IsA() == TFCharCol::Class()    ||
+       col.IsA() == TFCharArrCol::Class() ||
+       col.IsA() == TFCharVarArrCol::Class() )
       {
       // make the column to be a signed char
       int colNum;
@@ -897,21 +1004,27 @@ template<class B, class C> int WriteFitsArrColumn(fitsfile * fptr, C & col)
    if (status != 0)
       return status;
 
-   long numData = col.GetNumRows() * col.GetNumBins();
-   B * buffer = new B [numData];
-
-   int index = 0;
-   for (int row = 0; row < col.GetNumRows(); row++)
-         for (int bin = 0; bin < col.GetNumBins(); bin++)
-            {
-            buffer[index] = col[row][bin];
-            index++;
-            }
+   long numData = (long)col.GetNumRows() * col.GetNumBins();
 
    B nullVal;
    status = SetNullValue(fptr, col, fcd, nullVal, colNum, 
                          col.HasNull(), status);
 
+   // the data of the column can be written without a copy if the
+   // FITS data type is the type of the column and there are no NULL values
+   if (numData > 0 && !col.HasNull() &&
+       std::is_same<B, typename C::value_type>::value)
+      {
+      fits_write_col(fptr, fcd.dataType, colNum, 1, 1, numData, 
+                     (void*)col.GetDataArray(), &status);
+      return status;
+      }
+
+   B * buffer = new B [numData];
+   const typename C::value_type * data = col.GetDataArray();
+   for (long index = 0; index < numData; index++)
+      buffer[index] = data[index];
+
    if (numData > 0)
       {
       if (col.HasNull())
@@ -931,8 +1044,16 @@ template<class B, class C> int WriteFitsArrColumn(fitsfile * fptr, C & col)
    return status;
 }
 //_____________________________________________________________________________
-static int WriteStringFitsColumn(fitsfile * fptr, TFStringCol & col)
+template<class B, class C> int WriteFitsVarArrColumn(fitsfile * fptr, C & col)
 {
+// writes a variable length array column row by row into the heap of the
+// FITS table
+
+   std::map<TClass*, FitsColDef>::iterator i_fcd;
+   i_fcd = _fitsColDef.find(col.IsA());
+   if (i_fcd == _fitsColDef.end())   return -1;
+   FitsColDef & fcd = i_fcd->second;
+
    int status = 0;   
 
    int colNum;
@@ -940,22 +1061,70 @@ static int WriteStringFitsColumn(fitsfile * fptr, TFStringCol & col)
    if (status != 0)
       return status;
 
-   long repeat;
-   long width;
-   fits_get_coltype(fptr, colNum, NULL, NULL, &width, &status);
+   B nullVal;
+   status = SetNullValue(fptr, col, fcd, nullVal, colNum, 
+                         col.HasNull(), status);
+
+   // the data of a row can be written without a copy if the FITS data
+   // type is the type of the column and there are no NULL values
+   Bool_t direct = !col.HasNull() && std::is_same<B, typename C::value_type>::value;
+
+   std::vector<B> buffer(col.GetMaxRowSize());
+   for (UInt_t row = 0; status == 0 && row < col.GetNumRows(); row++)
+      {
+      UInt_t size = col.GetRowSize(row);
+      if (size == 0)
+         {
+         fits_write_descript(fptr, colNum, row + 1, 0, 0, &status);
+         continue;
+         }
+
+      const typename C::value_type * data = col.GetDataArray() + col.GetOffsets()[row];
+      if (direct)
+         {
+         fits_write_col(fptr, fcd.dataType, colNum, row + 1, 1, size, 
+                        (void*)data, &status);
+         continue;
+         }
+
+      for (UInt_t bin = 0; bin < size; bin++)
+         buffer[bin] = data[bin];
+
+      if (col.HasNull())
+         {
+         for (UInt_t bin = 0; bin < size; bin++)
+            if (col.IsNull(row, bin))
+               buffer[bin] = nullVal;
+
+         fits_write_colnull(fptr, fcd.dataType, colNum, row + 1, 1, size, 
+                            &buffer[0], &nullVal, &status);
+         }
+      else
+         fits_write_col(fptr, fcd.dataType, colNum, row + 1, 1, size, 
+                        &buffer[0], &status);
+      }
+
+   return status;
+}
+//_____________________________________________________________________________
+template <class C>
+static int WriteStringFitsColumn(fitsfile * fptr, C & col)
+{
+   int status = 0;   
+
+   int colNum;
+   fits_get_colnum(fptr, CASESEN, (char*)col.GetName(), &colNum, &status);
+   if (status != 0)
+      return status;
 
    long numData = col.GetNumRows();
    
-   // prepare the data buffer
-   int minSize = width + 1 > 7 ? width + 1 : 7;
+   // the strings are written directly from the arena or the dictionary
+   // of the column, cfitsio truncates strings which are longer than the column width
    char ** buffer;
    buffer = new char*[numData];
    for (int row = 0; row < numData; row++)
-      {
-      buffer[row] = new char[minSize];      
-      strncpy(buffer[row], col[row].Data(), minSize);
-      buffer[row][minSize-1] = 0;
-      }
+      buffer[row] = (char*)col.GetData(row);
 
    if (col.HasNull())
       {
@@ -963,7 +1132,7 @@ static int WriteStringFitsColumn(fitsfile * fptr, TFStringCol & col)
       strcpy(nulVal, "\n\r\'\b\"\t");
       TFNullIter i_null = col.MakeNullIterator();
       while (i_null.Next())
-         strcpy(buffer[*i_null], nulVal);
+         buffer[*i_null] = nulVal;
    
       fits_write_colnull(fptr, TSTRING, colNum, 1, 1, numData, buffer, 
                          nulVal, &status);
@@ -971,8 +1140,6 @@ static int WriteStringFitsColumn(fitsfile * fptr, TFStringCol & col)
    else
       fits_write_col(fptr, TSTRING, colNum, 1, 1, numData, buffer, &status);
 
-   for (int row = 0; row < numData; row++)
-      delete buffer[row];
    delete [] buffer;
 
    return status;
@@ -1128,7 +1295,17 @@ void TFFitsIO::GetColNames(std::map<TString, TNamed> & columns)
 
       TNamed name;
 
-      if (repeat == 1)
+      if (typecode < 0)
+         {
+         const char * typeName;
+         TClass * colClass = VarArrColClass(fptr, col, typecode, &typeName);
+         if (colClass == NULL)
+            continue;
+         name.SetName(colClass->GetName());
+         name.SetTitle(typeName);
+         }
+
+      else if (repeat == 1)
          {
          if (typecode == TSTRING)
             {
@@ -1266,12 +1443,13 @@ static TFBaseCol * StringColFits2Root(fitsfile * fptr, int col,
                          "maximum size of string in FITS file without terminating 0") );
 
 
-   // prepare the data buffer
+   // the strings are read directly into the arena of the column
    int minSize = width + 1 > 7 ? width + 1 : 7;
+   char * chars = rootCol->AllocStrings(0, numRows, minSize);
    char ** buffer;
    buffer = new char*[numRows];
    for (int row = 0; row < numRows; row++)
-      buffer[row] = new char[minSize];      
+      buffer[row] = chars + (size_t)row * minSize;      
 
    char nulVal[7];
    strcpy(nulVal, "\n\r\'\b\"\t");
@@ -1279,16 +1457,16 @@ static TFBaseCol * StringColFits2Root(fitsfile * fptr, int col,
    // read the column
    int anyNull = 0;
    fits_read_col(fptr, TSTRING, col, 1, 1, numRows, nulVal, buffer, &anyNull, status);
+   rootCol->UpdateLengths(0, numRows);
    
-   // copy the strings into the root column
-   for (int row = 0; row < numRows; row++)
-      {
-      if (anyNull && strcmp(nulVal, buffer[row]) == 0)
-          rootCol->SetNull(row);
-      else
-          (*rootCol)[row] = buffer[row];
-      delete [] buffer[row];
-      }
+   // mark the NULL values
+   if (anyNull)
+      for (int row = 0; row < numRows; row++)
+         if (strcmp(nulVal, rootCol->GetData(row)) == 0)
+            {
+            rootCol->SetNull(row);
+            rootCol->SetRow(row, "", 0);
+            }
 
    // clean memory
    delete [] buffer;
@@ -1616,7 +1794,7 @@ static TFBaseCol * ByteArrColFits2Root(fitsfile * fptr, int col,
    rootCol->SetNumBins(repeat);
 
    // prepare the data buffer
-   unsigned char * buffer = new unsigned char [numRows * repeat];
+   unsigned char * buffer = rootCol->GetDataArray();
    unsigned char nulVal = 0;
    char keyword[10];
    char strNullVal[20];
@@ -1633,19 +1811,11 @@ static TFBaseCol * ByteArrColFits2Root(fitsfile * fptr, int col,
    fits_read_col(fptr, TBYTE, col, 1, 1, numRows * repeat, &nulVal, 
                  buffer, &anyNull, status);
    
-   // copy the data into the root column
-   int index = 0;
-   for (int row = 0; row < numRows; row++)
-      for (int bin = 0; bin < repeat; bin++)
-         {
-         if (anyNull && buffer[index] == nulVal)
-             rootCol->SetNull(row, bin);
-         (*rootCol)[row][bin] = buffer[index];
-         index++;
-         }
-
-   // clean memory
-   delete [] buffer;
+   // the data are read directly into the root column, mark the NULL values
+   if (anyNull)
+      for (long index = 0; index < numRows * repeat; index++)
+         if (buffer[index] == nulVal)
+            rootCol->SetNull(index / repeat, index % repeat);
 
    return rootCol;
 }
@@ -1670,7 +1840,7 @@ static TFBaseCol * ShortArrColFits2Root(fitsfile * fptr, int col,
       rootCol->SetNumBins(repeat);
 
       // prepare the data buffer
-      short * buffer = new short [numRows * repeat];
+      short * buffer = rootCol->GetDataArray();
       short nulVal = 0;
       char strNullVal[20];
       sprintf(keyword, "TNULL%d", col);
@@ -1690,19 +1860,11 @@ static TFBaseCol * ShortArrColFits2Root(fitsfile * fptr, int col,
       fits_read_col(fptr, TSHORT, col, 1, 1, numRows * repeat, &nulVal, 
                     buffer, &anyNull, status);
 
-      // copy the data into the root column
-      int index = 0;
-      for (int row = 0; row < numRows; row++)
-         for (int bin = 0; bin < repeat; bin++)
-            {
-            if (anyNull && buffer[index] == nulVal)
-                rootCol->SetNull(row, bin);
-            (*rootCol)[row][bin] = buffer[index];
-            index++;
-            }
-
-      // clean memory
-      delete [] buffer;
+      // the data are read directly into the root column, mark the NULL values
+      if (anyNull)
+         for (long index = 0; index < numRows * repeat; index++)
+            if (buffer[index] == nulVal)
+               rootCol->SetNull(index / repeat, index % repeat);
       return rootCol;
       }
    else
@@ -1713,7 +1875,7 @@ static TFBaseCol * ShortArrColFits2Root(fitsfile * fptr, int col,
       rootCol->SetNumBins(repeat);
 
       // prepare the data buffer
-      unsigned short * buffer = new unsigned short [numRows * repeat];
+      unsigned short * buffer = rootCol->GetDataArray();
       unsigned short nulVal = 0;
       char strNullVal[20];
       sprintf(keyword, "TNULL%d", col);
@@ -1733,19 +1895,11 @@ static TFBaseCol * ShortArrColFits2Root(fitsfile * fptr, int col,
       fits_read_col(fptr, TUSHORT, col, 1, 1, numRows * repeat, &nulVal, 
                     buffer, &anyNull, status);
       
-      // copy the data into the root column
-      int index = 0;
-      for (int row = 0; row < numRows; row++)
-         for (int bin = 0; bin < repeat; bin++)
-            {
-            if (anyNull && buffer[index] == nulVal)
-                rootCol->SetNull(row, bin);
-            (*rootCol)[row][bin] = buffer[index];
-            index++;
-            }
-
-      // clean memory
-      delete [] buffer;
+      // the data are read directly into the root column, mark the NULL values
+      if (anyNull)
+         for (long index = 0; index < numRows * repeat; index++)
+            if (buffer[index] == nulVal)
+               rootCol->SetNull(index / repeat, index % repeat);
       return rootCol;
       }
 }
@@ -1770,7 +1924,7 @@ static TFBaseCol * IntArrColFits2Root(fitsfile * fptr, int col,
       rootCol->SetNumBins(repeat);
 
       // prepare the data buffer
-      int * buffer = new int [numRows * repeat];
+      int * buffer = rootCol->GetDataArray();
       int nulVal = 0;
       char strNullVal[20];
       sprintf(keyword, "TNULL%d", col);
@@ -1790,19 +1944,11 @@ static TFBaseCol * IntArrColFits2Root(fitsfile * fptr, int col,
       fits_read_col(fptr, TINT32BIT, col, 1, 1, numRows * repeat, &nulVal, 
                     buffer, &anyNull, status);
 
-      // copy the data into the root column
-      int index = 0;
-      for (int row = 0; row < numRows; row++)
-         for (int bin = 0; bin < repeat; bin++)
-            {
-            if (anyNull && buffer[index] == nulVal)
-                rootCol->SetNull(row, bin);
-            (*rootCol)[row][bin] = buffer[index];
-            index++;
-            }
-
-      // clean memory
-      delete [] buffer;
+      // the data are read directly into the root column, mark the NULL values
+      if (anyNull)
+         for (long index = 0; index < numRows * repeat; index++)
+            if (buffer[index] == nulVal)
+               rootCol->SetNull(index / repeat, index % repeat);
       return rootCol;
       }
    else
@@ -1813,7 +1959,7 @@ static TFBaseCol * IntArrColFits2Root(fitsfile * fptr, int col,
       rootCol->SetNumBins(repeat);
 
       // prepare the data buffer
-      unsigned int * buffer = new unsigned int [numRows * repeat];
+      unsigned int * buffer = rootCol->GetDataArray();
       unsigned int nulVal = 0;
       char strNullVal[20];
       sprintf(keyword, "TNULL%d", col);
@@ -1833,19 +1979,11 @@ static TFBaseCol * IntArrColFits2Root(fitsfile * fptr, int col,
       fits_read_col(fptr, TUINT, col, 1, 1, numRows * repeat, &nulVal, 
                     buffer, &anyNull, status);
       
-      // copy the data into the root column
-      int index = 0;
-      for (int row = 0; row < numRows; row++)
-         for (int bin = 0; bin < repeat; bin++)
-            {
-            if (anyNull && buffer[index] == nulVal)
-                rootCol->SetNull(row, bin);
-            (*rootCol)[row][bin] = buffer[index];
-            index++;
-            }
-
-      // clean memory
-      delete [] buffer;
+      // the data are read directly into the root column, mark the NULL values
+      if (anyNull)
+         for (long index = 0; index < numRows * repeat; index++)
+            if (buffer[index] == nulVal)
+               rootCol->SetNull(index / repeat, index % repeat);
       return rootCol;
       }
 }
@@ -1858,7 +1996,7 @@ static TFBaseCol * FloatArrColFits2Root(fitsfile * fptr, int col,
    rootCol->SetNumBins(repeat);
 
    // prepare the data buffer
-   float * buffer = new float [numRows * repeat];
+   float * buffer = rootCol->GetDataArray();
    long nan = 0xffffffff;
    float nulVal = *((float*)(&nan));
 
@@ -1867,19 +2005,10 @@ static TFBaseCol * FloatArrColFits2Root(fitsfile * fptr, int col,
    fits_read_col(fptr, TFLOAT, col, 1, 1, numRows * repeat, &nulVal, 
                  buffer, &anyNull, status);
    
-   // copy the data into the root column
-   int index = 0;
-   for (int row = 0; row < numRows; row++)
-      for (int bin = 0; bin < repeat; bin++)
-         {
-         if (isnan(buffer[index]))
-             rootCol->SetNull(row, bin);
-         (*rootCol)[row][bin] = buffer[index];
-         index++;
-         }
-
-   // clean memory
-   delete [] buffer;
+   // the data are read directly into the root column, mark the NULL values
+   for (long index = 0; index < numRows * repeat; index++)
+      if (isnan(buffer[index]))
+         rootCol->SetNull(index / repeat, index % repeat);
    return rootCol;
 }
 //_____________________________________________________________________________
@@ -1891,7 +2020,7 @@ static TFBaseCol * DoubleArrColFits2Root(fitsfile * fptr, int col,
    rootCol->SetNumBins(repeat);
 
    // prepare the data buffer
-   double * buffer = new double [numRows * repeat];
+   double * buffer = rootCol->GetDataArray();
    unsigned long long nan = 0xffffffffffffffffLL;
    double nulVal = *((double*)(&nan));
 
@@ -1900,18 +2029,133 @@ static TFBaseCol * DoubleArrColFits2Root(fitsfile * fptr, int col,
    fits_read_col(fptr, TDOUBLE, col, 1, 1, numRows * repeat, &nulVal, 
                  buffer, &anyNull, status);
    
-   // copy the data into the root column
-   int index = 0;
-   for (int row = 0; row < numRows; row++)
-      for (int bin = 0; bin < repeat; bin++)
-         {
-         if (isnan(buffer[index]))
-             rootCol->SetNull(row, bin);
-         (*rootCol)[row][bin] = buffer[index];
-         index++;
-         }
+   // the data are read directly into the root column, mark the NULL values
+   for (long index = 0; index < numRows * repeat; index++)
+      if (isnan(buffer[index]))
+         rootCol->SetNull(index / repeat, index % repeat);
+   return rootCol;
+}
+//_____________________________________________________________________________
+static TClass * VarArrColClass(fitsfile * fptr, int col, int typecode, 
+                               const char ** typeName)
+{
+// returns the class of the column used for the variable length array 
+// column col with the data type -typecode. typeName is set to the name
+// of the data type. Returns NULL if the data type is not supported.
 
-   // clean memory
-   delete [] buffer;
+   // test if it is an unsigned column
+   char keyword[10];
+   char offset[30];
+   int  status = 0;
+   sprintf(keyword, "TZERO%d", col);
+   fits_read_keyword(fptr, keyword, offset, NULL, &status);
+   if (status != 0)
+      offset[0] = 0;
+
+   switch (-typecode)
+      {
+      case TLOGICAL:
+         *typeName = BoolCharFormat::GetTypeName();
+         return TFBoolVarArrCol::Class();
+      case TBYTE:
+         *typeName = UCharFormat::GetTypeName();
+         return TFUCharVarArrCol::Class();
+      case TSHORT:
+         if (strcmp(offset, "32768") == 0)
+            {
+            *typeName = UShortFormat::GetTypeName();
+            return TFUShortVarArrCol::Class();
+            }
+         *typeName = ShortFormat::GetTypeName();
+         return TFShortVarArrCol::Class();
+      case TINT32BIT:
+         if (strcmp(offset, "2147483648") == 0)
+            {
+            *typeName = UIntFormat::GetTypeName();
+            return TFUIntVarArrCol::Class();
+            }
+         *typeName = IntFormat::GetTypeName();
+         return TFIntVarArrCol::Class();
+      case TFLOAT:
+         *typeName = FloatFormat::GetTypeName();
+         return TFFloatVarArrCol::Class();
+      case TDOUBLE:
+         *typeName = DoubleFormat::GetTypeName();
+         return TFDoubleVarArrCol::Class();
+      }
+
+   return NULL;
+}
+//_____________________________________________________________________________
+template <class C>
+static TFBaseCol * VarArrColFits2Root(fitsfile * fptr, int col, 
+                        const char * colName, long numRows, int dataType, int * status)
+{
+// reads the variable length array column col with the FITS data type
+// dataType into a new column of type C
+
+   if (*status != 0)  return NULL;
+
+   C * rootCol = new C(colName, numRows);
+
+   // the descriptors give the number of values of each row
+   std::vector<LONGLONG> length(numRows + 1);
+   std::vector<LONGLONG> heapPos(numRows + 1);
+   if (numRows > 0)
+      fits_read_descriptsll(fptr, col, 1, numRows, &length[0], &heapPos[0], status);
+   rootCol->SetRowSizes(&length[0]);
+
+   // read the values directly into the root column, row by row
+   std::vector<char> nullArray(rootCol->GetMaxRowSize() + 1);
+   for (long row = 0; *status == 0 && row < numRows; row++)
+      {
+      if (length[row] == 0)
+         continue;
+
+      int anyNull = 0;
+      fits_read_colnull(fptr, dataType, col, row + 1, 1, length[row], 
+                        rootCol->GetDataArray() + rootCol->GetOffsets()[row],
+                        &nullArray[0], &anyNull, status);
+      if (anyNull)
+         for (long bin = 0; bin < length[row]; bin++)
+            if (nullArray[bin])
+               rootCol->SetNull(row, bin);
+      }
+
+   if (*status != 0)
+      {
+      delete rootCol;
+      return NULL;
+      }
    return rootCol;
 }
+//_____________________________________________________________________________
+static TFBaseCol * VarArrColFits2Root(fitsfile * fptr, int col, 
+                        const char * colName, long numRows, int typecode, int * status)
+{
+   if (*status != 0)  return NULL;
+
+   const char * typeName;
+   TClass * colClass = VarArrColClass(fptr, col, typecode, &typeName);
+
+   if (colClass == NULL)
+      return NULL;
+   else if (colClass == TFBoolVarArrCol::Class())
+      return VarArrColFits2Root<TFBoolVarArrCol>(fptr, col, colName, numRows, TLOGICAL, status);
+   else if (colClass == TFUCharVarArrCol::Class())
+      return VarArrColFits2Root<TFUCharVarArrCol>(fptr, col, colName, numRows, TBYTE, status);
+   else if (colClass == TFShortVarArrCol::Class())
+      return VarArrColFits2Root<TFShortVarArrCol>(fptr, col, colName, numRows, TSHORT, status);
+   else if (colClass == TFUShortVarArrCol::Class())
+      return VarArrColFits2Root<TFUShortVarArrCol>(fptr, col, colName, numRows, TUSHORT, status);
+   else if (colClass == TFIntVarArrCol::Class())
+      return VarArrColFits2Root<TFIntVarArrCol>(fptr, col, colName, numRows, TINT, status);
+   else if (colClass == TFUIntVarArrCol::Class())
+      return VarArrColFits2Root<TFUIntVarArrCol>(fptr, col, colName, numRows, TUINT, status);
+   else if (colClass == TFFloatVarArrCol::Class())
+      return VarArrColFits2Root<TFFloatVarArrCol>(fptr, col, colName, numRows, TFLOAT, status);
+   else if (colClass == TFDoubleVarArrCol::Class())
+      return VarArrColFits2Root<TFDoubleVarArrCol>(fptr, col, colName, numRows, TDOUBLE, status);
+
+   return NULL;
+}
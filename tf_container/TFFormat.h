@@ -261,7 +261,7 @@ public:
     static const char * GetTypeName()     {return "TString";}
     static const char * GetBranchType()   {return "";}
     static double       ToDouble(const TString & value)
-                                            {double d; sscanf(value.Data(), "%lf",&d); return d;}
+                                            {double d = 0; sscanf(value.Data(), "%lf",&d); return d;}
     static void         SetDouble(Double_t dbl, TString & value) {value.Resize(0); value += dbl;}
 };
 
@@ -225,11 +225,13 @@ public:
    void           SetSelector(TFSelector * select);
    void           ClearSelectors();
    Bool_t         Filter(const char * filter)    {return fRowIter.Filter(filter);}
-   void           Sort(const char * colName)     {fRowIter.Sort(colName);}
+   void           Sort(const char * colNames, Bool_t ascending = kTRUE)
+                                                 {fRowIter.Sort(colNames, ascending);}
    void           ClearFilterSort()              {fRowIter.ClearFilterSort();}
    Bool_t         Next();
    TFIOElement &  operator * ()                  {return fList ? fList->operator*() : *fLast;}
    TFIOElement *  operator -> ()                 {return fList ? fList->operator->() : fLast;}
+   TFIOElement *  Release();
    void           Reset();
    void           SetReadOnly(Bool_t readOnly = kTRUE);
    Bool_t         IsReadOnly()         {return fReadOnly;}
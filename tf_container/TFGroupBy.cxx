@@ -0,0 +1,514 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFGroupBy.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+
+#include "TFGroupBy.h"
+#include "TFHashKeys.h"
+#include "TFTable.h"
+#include "TFColumn.h"
+#include "TFParallel.h"
+#include "TFError.h"
+
+#include "TObjArray.h"
+#include "TObjString.h"
+
+//_____________________________________________________________________________
+// TFGroupBy:
+//    Internal class, used by TFTable::GroupBy().
+//    Should not be used directly by an application.
+//    The rows of a table are grouped by the values of the key columns with
+//    a hash table. Every chunk of rows is aggregated by one thread of the
+//    ROOT thread pool into its own hash table, if the implicit
+//    multi-threading of ROOT is enabled. At the end these partial hash
+//    tables are merged, again in parallel: every thread merges the groups
+//    of one part of the range of the hash values.
+
+static const UInt_t kNoGroup   = 0xffffffff;   // empty slot of the hash table
+static const UInt_t kBlockRows = 4096;         // rows converted to double at once
+
+enum EAggregate {kCountRows, kCount, kSum, kMean, kStd, kMin, kMax, kFirst, kLast};
+
+//_____________________________________________________________________________
+// one aggregate of the output table
+
+struct TFAggregate
+{
+   EAggregate  fType;      // the aggregate function
+   TString     fName;      // name of the output column
+   Int_t       fValue;     // index of the value column, -1 for kCountRows
+};
+
+//_____________________________________________________________________________
+// the aggregated values of one value column in one group
+
+struct TFGroupValue
+{
+   ULong64_t   fCount;     // number of not NULL values
+   Double_t    fSum;       // sum of the values
+   Double_t    fM2;        // sum of the squared differences to the mean
+   Double_t    fMin;       // minimum value
+   Double_t    fMax;       // maximum value
+   UInt_t      fMinRow;    // first row with the minimum value
+   UInt_t      fMaxRow;    // first row with the maximum value
+   UInt_t      fFirstRow;  // first row with a not NULL value
+   UInt_t      fLastRow;   // last row with a not NULL value
+
+   TFGroupValue() : fCount(0), fSum(0), fM2(0), fMin(0), fMax(0),
+                    fMinRow(TF_MAX_ROWS), fMaxRow(TF_MAX_ROWS),
+                    fFirstRow(TF_MAX_ROWS), fLastRow(TF_MAX_ROWS) {}
+
+   void  Fill(Double_t val, UInt_t row);
+   void  Add(const TFGroupValue & value);
+};
+
+//_____________________________________________________________________________
+inline void TFGroupValue::Fill(Double_t val, UInt_t row)
+{
+// adds the value of row, rows are added in ascending order.
+
+   if (fCount == 0)
+      {
+      fSum      = val;
+      fMin      = val;
+      fMax      = val;
+      fMinRow   = row;
+      fMaxRow   = row;
+      fFirstRow = row;
+      }
+   else
+      {
+      Double_t delta = val - fSum / fCount;
+      fM2  += delta * delta * fCount / (fCount + 1);
+      fSum += val;
+      if (val < fMin || std::isnan(fMin))
+         {
+         fMin    = val;
+         fMinRow = row;
+         }
+      if (val > fMax || std::isnan(fMax))
+         {
+         fMax    = val;
+         fMaxRow = row;
+         }
+      }
+   fLastRow = row;
+   fCount++;
+}
+
+//_____________________________________________________________________________
+void TFGroupValue::Add(const TFGroupValue & value)
+{
+// merges value of the rows after the rows of this group value. The
+// variances are combined with the formula of Chan et al.
+
+   if (value.fCount == 0)
+      return;
+   if (fCount == 0)
+      {
+      *this = value;
+      return;
+      }
+
+   Double_t n1    = fCount;
+   Double_t n2    = value.fCount;
+   Double_t delta = value.fSum / n2 - fSum / n1;
+   fM2  += value.fM2 + delta * delta * n1 * n2 / (n1 + n2);
+   fSum += value.fSum;
+   if (value.fMin < fMin || std::isnan(fMin))
+      {
+      fMin    = value.fMin;
+      fMinRow = value.fMinRow;
+      }
+   if (value.fMax > fMax || std::isnan(fMax))
+      {
+      fMax    = value.fMax;
+      fMaxRow = value.fMaxRow;
+      }
+   fLastRow = value.fLastRow;
+   fCount  += value.fCount;
+}
+
+//_____________________________________________________________________________
+// a hash table of groups with open addressing
+
+struct TFGroupTable
+{
+   std::vector<UInt_t>        fSlots;     // the group of each slot or kNoGroup
+   std::vector<ULong64_t>     fHashes;    // hash value of the keys of each group
+   std::vector<UInt_t>        fRows;      // first row of each group
+   std::vector<UInt_t>        fNumRows;   // number of rows of each group
+   std::vector<TFGroupValue>  fValues;    // all value columns of each group
+   UInt_t                     fNumValues; // number of value columns
+
+   TFGroupTable() : fSlots(1024, kNoGroup), fNumValues(0) {}
+
+   UInt_t   GetNumGroups() const    {return fRows.size();}
+   UInt_t   Find(const TFHashKeys & keys, ULong64_t hash, UInt_t row);
+};
+
+//_____________________________________________________________________________
+UInt_t TFGroupTable::Find(const TFHashKeys & keys, ULong64_t hash, UInt_t row)
+{
+// returns the group of row, which keys have the hash value hash. Creates
+// a new group with row as first row if it does not yet exist.
+
+   ULong64_t mask = fSlots.size() - 1;
+   for (ULong64_t slot = hash & mask; ; slot = (slot + 1) & mask)
+      {
+      UInt_t group = fSlots[slot];
+      if (group == kNoGroup)
+         {
+         group = fRows.size();
+         fSlots[slot] = group;
+         fHashes.push_back(hash);
+         fRows.push_back(row);
+         fNumRows.push_back(0);
+         fValues.resize(fValues.size() + fNumValues);
+         break;
+         }
+      if (fHashes[group] == hash && keys.SameGroup(fRows[group], row))
+         return group;
+      }
+
+   // keep the hash table at most half full
+   if (fRows.size() * 2 > fSlots.size())
+      {
+      fSlots.assign(fSlots.size() * 2, kNoGroup);
+      mask = fSlots.size() - 1;
+      for (UInt_t group = 0; group < fRows.size(); group++)
+         {
+         ULong64_t slot = fHashes[group] & mask;
+         while (fSlots[slot] != kNoGroup)
+            slot = (slot + 1) & mask;
+         fSlots[slot] = group;
+         }
+      }
+
+   return fRows.size() - 1;
+}
+
+//_____________________________________________________________________________
+// one group of the output table
+
+struct TFGroupEntry
+{
+   UInt_t               fRow;       // first row of the group
+   UInt_t               fNumRows;   // number of rows of the group
+   const TFGroupValue * fValues;    // all value columns of the group
+};
+
+//_____________________________________________________________________________
+static Bool_t GetAggregates(const TFTable & table, const TFHashKeys & keys,
+                            const char * aggregates, std::vector<TFAggregate> & aggrs,
+                            std::vector<const TFBaseCol *> & values)
+{
+// interprets the comma separated list of aggregates and finds the value
+// columns.
+
+   static const char * funcs[] = {"count", "count", "sum", "mean", "std",
+                                  "min", "max", "first", "last"};
+
+   std::set<std::string> names;
+   for (UInt_t num = 0; num < keys.GetNumKeys(); num++)
+      names.insert(keys.GetColumn(num)->GetName());
+
+   std::vector<TString> specs;
+   TString     list(aggregates ? aggregates : "");
+   TObjArray * tokens = list.Tokenize(",");
+   for (Int_t num = 0; num < tokens->GetEntriesFast(); num++)
+      specs.push_back(((TObjString*)tokens->At(num))->GetString().Strip(TString::kBoth));
+   delete tokens;
+
+   for (size_t num = 0; num < specs.size(); num++)
+      {
+      TString spec = specs[num];
+      TString name;
+      Ssiz_t  pos = spec.Index("=");
+      if (pos != kNPOS)
+         {
+         name = TString(spec.Data(), pos).Strip(TString::kBoth);
+         spec = TString(spec.Data() + pos + 1).Strip(TString::kBoth);
+         }
+
+      TString func = spec;
+      TString colName;
+      Ssiz_t  open = spec.Index("(");
+      if (open != kNPOS)
+         {
+         if (!spec.EndsWith(")"))
+            {
+            TFError::SetError("TFTable::GroupBy", "Cannot interpret the aggregate %s.",
+                              specs[num].Data());
+            return kFALSE;
+            }
+         func    = TString(spec.Data(), open).Strip(TString::kBoth);
+         colName = TString(spec.Data() + open + 1, spec.Length() - open - 2).Strip(TString::kBoth);
+         }
+      func.ToLower();
+
+      TFAggregate aggr;
+      Int_t type;
+      for (type = kCount; type <= kLast; type++)
+         if (func == funcs[type])
+            break;
+      if (type > kLast)
+         {
+         TFError::SetError("TFTable::GroupBy", "Unknown aggregate function %s.",
+                           func.Data());
+         return kFALSE;
+         }
+      if (type == kCount && colName.IsNull())
+         type = kCountRows;
+      aggr.fType  = (EAggregate)type;
+      aggr.fValue = -1;
+
+      if (type != kCountRows)
+         {
+         if (colName.IsNull())
+            {
+            TFError::SetError("TFTable::GroupBy", "Missing column of the aggregate %s.",
+                              specs[num].Data());
+            return kFALSE;
+            }
+         const TFBaseCol * col = &table.GetColumn(colName.Data());
+         if (col == NULL)
+            return kFALSE;
+
+         if (type != kCount && type != kFirst && type != kLast &&
+             (!col->IsNumeric() || col->GetNumBins() != 1))
+            {
+            TFError::SetError("TFTable::GroupBy",
+                              "Column %s of table %s cannot be aggregated with %s.",
+                              colName.Data(), table.GetName(), func.Data());
+            return kFALSE;
+            }
+
+         aggr.fValue = std::find(values.begin(), values.end(), col) - values.begin();
+         if (aggr.fValue == (Int_t)values.size())
+            values.push_back(col);
+         }
+
+      if (name.IsNull() && type == kCountRows)
+         name = "count";
+      else if (name.IsNull())
+         {
+         name  = colName;
+         name += "_";
+         name += funcs[type];
+         }
+      if (!names.insert(name.Data()).second)
+         {
+         TFError::SetError("TFTable::GroupBy",
+                           "The name %s of the aggregate %s is not unique.",
+                           name.Data(), specs[num].Data());
+         return kFALSE;
+         }
+      aggr.fName = name;
+      aggrs.push_back(aggr);
+      }
+
+   return kTRUE;
+}
+//_____________________________________________________________________________
+static void AddResultColumn(TFTable * result, TFBaseCol * col)
+{
+// adds col to the result table. A column which the table rejects, for 
+// example the second column of a duplicate name, is deleted.
+
+   try
+      {
+      if (result->AddColumn(col) == 0)
+         return;
+      }
+   catch (TFException &)
+      {
+      delete col;
+      throw;
+      }
+
+   TString name = col->GetName();
+   delete col;
+   TFError::SetError("TFTable::GroupBy", 
+                     "Column %s is missing in the result table, "
+                     "the table has already a column with this name.", name.Data());
+}
+
+//_____________________________________________________________________________
+TFTable * TFGroupBy::GroupBy(const TFTable & table, const char * keyNames,
+                             const char * aggregates, Bool_t parallel)
+{
+// Creates the table of the aggregates of all groups of rows with the same
+// keys, see TFTable::GroupBy().
+
+   TFHashKeys keys;
+   if (!keys.Init(table, keyNames, "TFTable::GroupBy"))
+      return NULL;
+
+   std::vector<TFAggregate>       aggrs;
+   std::vector<const TFBaseCol *> values;
+   if (!GetAggregates(table, keys, aggregates, aggrs, values))
+      return NULL;
+
+   UInt_t numValues = values.size();
+   std::vector<char> numeric(numValues);
+   for (UInt_t val = 0; val < numValues; val++)
+      numeric[val] = values[val]->IsNumeric() && values[val]->GetNumBins() == 1;
+
+   // every chunk of rows is aggregated into its own hash table
+   UInt_t numRows   = table.GetNumRows();
+   UInt_t numChunks = parallel ? TFParallel::GetNumChunks(numRows) : 1;
+   std::vector<TFGroupTable> parts(numChunks);
+   TFParallel::Foreach(numRows, numChunks,
+         [&](UInt_t chunk, UInt_t begin, UInt_t end)
+         {
+            TFGroupTable & groups = parts[chunk];
+            groups.fNumValues = numValues;
+            std::vector<Double_t> buffer((size_t)numValues * kBlockRows, 0);
+            std::vector<UInt_t>   blockGroups(kBlockRows);
+
+            for (UInt_t first = begin; first < end; first += kBlockRows)
+               {
+               UInt_t last = std::min(end, first + kBlockRows);
+               for (UInt_t row = first; row < last; row++)
+                  {
+                  UInt_t group = groups.Find(keys, keys.HashGroup(row), row);
+                  groups.fNumRows[group]++;
+                  blockGroups[row - first] = group;
+                  }
+
+               for (UInt_t val = 0; val < numValues; val++)
+                  {
+                  const TFBaseCol * col = values[val];
+                  Double_t * vals = &buffer[(size_t)val * kBlockRows];
+                  if (numeric[val])
+                     col->ToDoubles(first, last, vals);
+                  Bool_t hasNull = col->HasNull();
+                  for (UInt_t row = first; row < last; row++)
+                     if (!hasNull || !col->IsNull(row))
+                        groups.fValues[(size_t)blockGroups[row - first] * numValues + val].
+                                          Fill(vals[row - first], row);
+                  }
+               }
+         });
+
+   // the partial hash tables are merged in parallel, each thread merges the
+   // groups of its range of hash values of all chunks in the order of the
+   // chunks
+   std::vector<TFGroupTable> merged(numChunks);
+   TFParallel::Foreach(numChunks, numChunks,
+         [&](UInt_t part, UInt_t, UInt_t)
+         {
+            TFGroupTable & groups = merged[part];
+            groups.fNumValues = numValues;
+            for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+               {
+               const TFGroupTable & from = parts[chunk];
+               for (UInt_t group = 0; group < from.GetNumGroups(); group++)
+                  {
+                  ULong64_t hash = from.fHashes[group];
+                  if (numChunks > 1 && (UInt_t)((hash >> 32) % numChunks) != part)
+                     continue;
+
+                  UInt_t to = groups.Find(keys, hash, from.fRows[group]);
+                  groups.fNumRows[to] += from.fNumRows[group];
+                  for (UInt_t val = 0; val < numValues; val++)
+                     groups.fValues[(size_t)to * numValues + val].Add(
+                                    from.fValues[(size_t)group * numValues + val]);
+                  }
+               }
+         });
+   std::vector<TFGroupTable>().swap(parts);
+
+   // the groups are ordered by their first row
+   std::vector<TFGroupEntry> order;
+   for (UInt_t part = 0; part < numChunks; part++)
+      for (UInt_t group = 0; group < merged[part].GetNumGroups(); group++)
+         {
+         TFGroupEntry out;
+         out.fRow     = merged[part].fRows[group];
+         out.fNumRows = merged[part].fNumRows[group];
+         out.fValues  = merged[part].fValues.data() + (size_t)group * numValues;
+         order.push_back(out);
+         }
+   std::sort(order.begin(), order.end(),
+             [](const TFGroupEntry & g1, const TFGroupEntry & g2) {return g1.fRow < g2.fRow;});
+
+   UInt_t numGroups = order.size();
+   std::vector<UInt_t> groupRows(numGroups);
+   for (UInt_t group = 0; group < numGroups; group++)
+      groupRows[group] = order[group].fRow;
+
+   // the output columns: the key columns and one column per aggregate
+   TFTable * result = new TFTable(table.GetName(), numGroups);
+   for (UInt_t num = 0; num < keys.GetNumKeys(); num++)
+      {
+      const TFBaseCol * key = keys.GetColumn(num);
+      TFBaseCol * col = (TFBaseCol *)key->IsA()->New();
+      col->SetName(key->GetName());
+      col->CopyRows(*key, groupRows.data(), numGroups);
+      AddResultColumn(result, col);
+      }
+
+   std::vector<UInt_t> rows(numGroups);
+   for (size_t num = 0; num < aggrs.size(); num++)
+      {
+      const TFAggregate & aggr = aggrs[num];
+      TFBaseCol * col = NULL;
+
+      if (aggr.fType == kCountRows || aggr.fType == kCount)
+         {
+         TFUIntCol * count = new TFUIntCol(aggr.fName, numGroups);
+         for (UInt_t group = 0; group < numGroups; group++)
+            (*count)[group] = aggr.fType == kCountRows ? order[group].fNumRows :
+                              (UInt_t)order[group].fValues[aggr.fValue].fCount;
+         col = count;
+         }
+      else if (aggr.fType == kSum || aggr.fType == kMean || aggr.fType == kStd)
+         {
+         TFDoubleCol * dbl = new TFDoubleCol(aggr.fName, numGroups);
+         for (UInt_t group = 0; group < numGroups; group++)
+            {
+            const TFGroupValue & value = order[group].fValues[aggr.fValue];
+            if (value.fCount == 0 || (aggr.fType == kStd && value.fCount < 2))
+               dbl->SetNull(group);
+            else if (aggr.fType == kSum)
+               (*dbl)[group] = value.fSum;
+            else if (aggr.fType == kMean)
+               (*dbl)[group] = value.fSum / value.fCount;
+            else
+               (*dbl)[group] = sqrt(value.fM2 / (value.fCount - 1));
+            }
+         col = dbl;
+         }
+      else
+         {
+         // min, max, first and last are copied from the row of the value
+         for (UInt_t group = 0; group < numGroups; group++)
+            {
+            const TFGroupValue & value = order[group].fValues[aggr.fValue];
+            rows[group] = aggr.fType == kMin   ? value.fMinRow   :
+                          aggr.fType == kMax   ? value.fMaxRow   :
+                          aggr.fType == kFirst ? value.fFirstRow : value.fLastRow;
+            }
+         const TFBaseCol * from = values[aggr.fValue];
+         col = (TFBaseCol *)from->IsA()->New();
+         col->SetName(aggr.fName);
+         col->CopyRows(*from, rows.data(), numGroups);
+         }
+
+      AddResultColumn(result, col);
+      }
+
+   return result;
+}
@@ -0,0 +1,29 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFGroupBy.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFGroupBy
+#define ROOT_TFGroupBy
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+
+class TFTable;
+
+//_____________________________________________________________________________
+
+class TFGroupBy
+{
+public:
+   static TFTable *  GroupBy(const TFTable & table, const char * keys,
+                             const char * aggregates, Bool_t parallel = kTRUE);
+};
+
+#endif
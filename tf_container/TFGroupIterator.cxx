@@ -228,6 +228,21 @@ Bool_t  TFGroupIter::Next()
   return kFALSE;
 }
 //_____________________________________________________________________________
+TFIOElement * TFGroupIter::Release()
+{
+// Returns the element of the last call of Next() and passes it to the 
+// caller, who has to delete it. The iterator does not delete this element
+// at the next call of Next(). The operator *() and the operator->() must
+// not be used until Next() is called again.
+
+   if (fList)
+      return fList->Release();
+
+   TFIOElement * element = fLast;
+   fLast = NULL;
+   return element;
+}
+//_____________________________________________________________________________
 void TFGroupIter::Reset()
 {
 // resets the iterator, but not the filter, not the sorting and not the selection
@@ -0,0 +1,227 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFHashKeys.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include <math.h>
+
+#include <functional>
+
+#include "TFHashKeys.h"
+#include "TFTable.h"
+#include "TFColumn.h"
+#include "TFError.h"
+
+#include "TObjArray.h"
+#include "TObjString.h"
+
+//_____________________________________________________________________________
+// TFHashKeys:
+//    Internal class, used by TFTable::Join() and TFTable::GroupBy().
+//    Should not be used directly by an application.
+//    It combines the values of the key columns of one row of a table into
+//    one hash value and compares the keys of two rows. Numerical key
+//    columns of different types are compared by their values, string key
+//    columns by their strings. The strings of a dictionary string column
+//    are hashed only once per string of the dictionary.
+//    A join uses HashMatch() and Match(): a NULL or NaN key never matches.
+//    A group-by uses HashGroup() and SameGroup(): all rows with a NULL key
+//    are one group, as all rows with a NaN key.
+
+static const ULong64_t kNullHash = 0x6a09e667f3bcc908ULL;   // hash of a NULL key
+
+//_____________________________________________________________________________
+static inline ULong64_t Mix(ULong64_t hash)
+{
+// the finalizer of MurmurHash3, every bit of the input changes all bits
+
+   hash ^= hash >> 33;
+   hash *= 0xff51afd7ed558ccdULL;
+   hash ^= hash >> 33;
+   hash *= 0xc4ceb9fe1a85ec53ULL;
+   hash ^= hash >> 33;
+   return hash;
+}
+
+//_____________________________________________________________________________
+static inline ULong64_t Combine(ULong64_t hash, ULong64_t value)
+{
+   return Mix(hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2)));
+}
+
+//_____________________________________________________________________________
+std::string_view TFHashKeys::Key::GetView(UInt_t row) const
+{
+   return fStr ? fStr->GetView(row) : fDict->GetView(row);
+}
+
+//_____________________________________________________________________________
+Bool_t TFHashKeys::Init(const TFTable & table, const char * keyNames,
+                        const char * location)
+{
+// Defines the key columns. keyNames is a comma separated list of column
+// names of table. A key column must be a string column or a numerical
+// column with one value per row. Returns kFALSE and writes an error with
+// location as name of the function into the error stack if a column does
+// not exist or cannot be a key column.
+
+   std::vector<TString> names;
+   TString     list(keyNames ? keyNames : "");
+   TObjArray * tokens = list.Tokenize(",");
+   for (Int_t num = 0; num < tokens->GetEntriesFast(); num++)
+      names.push_back(((TObjString*)tokens->At(num))->GetString().Strip(TString::kBoth));
+   delete tokens;
+
+   fKeys.clear();
+   if (names.empty())
+      {
+      TFError::SetError(location, "No key column of table %s.", table.GetName());
+      return kFALSE;
+      }
+
+   fKeys.resize(names.size());
+   for (size_t num = 0; num < names.size(); num++)
+      {
+      Key & key = fKeys[num];
+      key.fCol = &table.GetColumn(names[num].Data());
+      if (key.fCol == NULL)
+         return kFALSE;
+
+      key.fStr  = dynamic_cast<const TFStringCol *>(key.fCol);
+      key.fDict = dynamic_cast<const TFDictStringCol *>(key.fCol);
+      if (key.fDict)
+         {
+         key.fHashes.resize(key.fDict->GetNumCodes());
+         for (UInt_t code = 0; code < key.fHashes.size(); code++)
+            {
+            const TString & str = key.fDict->GetCodeString(code);
+            key.fHashes[code] = std::hash<std::string_view>()(
+                                   std::string_view(str.Data(), str.Length()));
+            }
+         }
+      if (key.IsString())
+         continue;
+
+      if (!key.fCol->IsNumeric() || key.fCol->GetNumBins() != 1)
+         {
+         TFError::SetError(location, "Column %s of table %s cannot be a key column.",
+                           names[num].Data(), table.GetName());
+         return kFALSE;
+         }
+      key.fValues.resize(key.fCol->GetNumRows());
+      key.fCol->ToDoubles(0, key.fCol->GetNumRows(), key.fValues.data());
+      }
+
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+inline Bool_t TFHashKeys::IsNull(const Key & key, UInt_t row) const
+{
+   return key.fCol->HasNull() && key.fCol->IsNull(row);
+}
+
+//_____________________________________________________________________________
+inline ULong64_t TFHashKeys::HashValue(const Key & key, UInt_t row) const
+{
+// the hash of the key value of row, which is not NULL. -0 and +0 have the
+// same hash value as all NaN.
+
+   if (key.fDict)
+      return key.fHashes[key.fDict->GetCode(row)];
+   if (key.fStr)
+      return std::hash<std::string_view>()(key.fStr->GetView(row));
+
+   Double_t  val = key.fValues[row];
+   ULong64_t value;
+   if (std::isnan(val))
+      val = NAN;
+   else if (val == 0)
+      val = 0;
+   memcpy(&value, &val, sizeof(value));
+   return value;
+}
+
+//_____________________________________________________________________________
+Bool_t TFHashKeys::HashMatch(UInt_t row, ULong64_t & hash) const
+{
+// Computes the hash value of the keys of row for a join. Returns kFALSE
+// if a key of this row is NULL or NaN, such a row does not match any
+// other row.
+
+   hash = 0;
+   for (size_t num = 0; num < fKeys.size(); num++)
+      {
+      const Key & key = fKeys[num];
+      if (IsNull(key, row) || (!key.IsString() && std::isnan(key.fValues[row])))
+         return kFALSE;
+      hash = Combine(hash, HashValue(key, row));
+      }
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFHashKeys::Match(UInt_t row, const TFHashKeys & keys, UInt_t otherRow) const
+{
+// Returns kTRUE if the keys of row are equal to the keys of otherRow of
+// keys, another set of key columns with the same number and kind of
+// columns. Both rows must have a valid hash value ( see HashMatch() ).
+
+   for (size_t num = 0; num < fKeys.size(); num++)
+      if (fKeys[num].IsString() ?
+               fKeys[num].GetView(row) != keys.fKeys[num].GetView(otherRow) :
+               fKeys[num].fValues[row] != keys.fKeys[num].fValues[otherRow])
+         return kFALSE;
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+ULong64_t TFHashKeys::HashGroup(UInt_t row) const
+{
+// Returns the hash value of the keys of row for a group-by.
+
+   ULong64_t hash = 0;
+   for (size_t num = 0; num < fKeys.size(); num++)
+      hash = Combine(hash, IsNull(fKeys[num], row) ? kNullHash :
+                                                     HashValue(fKeys[num], row));
+   return hash;
+}
+
+//_____________________________________________________________________________
+Bool_t TFHashKeys::SameGroup(UInt_t row1, UInt_t row2) const
+{
+// Returns kTRUE if row1 and row2 belong to the same group: every key is
+// either NULL in both rows or has the same value in both rows. NaN is
+// equal to NaN.
+
+   for (size_t num = 0; num < fKeys.size(); num++)
+      {
+      const Key & key = fKeys[num];
+      Bool_t null1 = IsNull(key, row1);
+      if (null1 != IsNull(key, row2))
+         return kFALSE;
+      if (null1)
+         continue;
+
+      if (key.fDict)
+         {
+         if (key.fDict->GetCode(row1) != key.fDict->GetCode(row2) &&
+             key.GetView(row1) != key.GetView(row2))
+            return kFALSE;
+         }
+      else if (key.fStr)
+         {
+         if (key.GetView(row1) != key.GetView(row2))
+            return kFALSE;
+         }
+      else if (key.fValues[row1] != key.fValues[row2] &&
+               !(std::isnan(key.fValues[row1]) && std::isnan(key.fValues[row2])))
+         return kFALSE;
+      }
+   return kTRUE;
+}
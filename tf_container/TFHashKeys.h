@@ -0,0 +1,61 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFHashKeys.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFHashKeys
+#define ROOT_TFHashKeys
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <vector>
+#include <string_view>
+
+
+class TFTable;
+class TFBaseCol;
+class TFStringCol;
+class TFDictStringCol;
+
+//_____________________________________________________________________________
+
+class TFHashKeys
+{
+   struct Key
+      {
+      const TFBaseCol        * fCol;      // the key column
+      const TFStringCol      * fStr;      // the column if it is a string column
+      const TFDictStringCol  * fDict;     // the column if it is a dictionary string column
+      std::vector<Double_t>    fValues;   // all values of a numerical column
+      std::vector<ULong64_t>   fHashes;   // hash of each string of the dictionary
+
+      Bool_t            IsString() const  {return fStr != NULL || fDict != NULL;}
+      std::string_view  GetView(UInt_t row) const;
+      };
+
+   std::vector<Key>  fKeys;   // all key columns
+
+   Bool_t   IsNull(const Key & key, UInt_t row) const;
+   ULong64_t HashValue(const Key & key, UInt_t row) const;
+
+public:
+   Bool_t   Init(const TFTable & table, const char * keyNames, const char * location);
+
+   UInt_t            GetNumKeys() const             {return fKeys.size();}
+   const TFBaseCol * GetColumn(UInt_t num) const    {return fKeys[num].fCol;}
+   Bool_t            IsString(UInt_t num) const     {return fKeys[num].IsString();}
+
+   Bool_t   HashMatch(UInt_t row, ULong64_t & hash) const;
+   Bool_t   Match(UInt_t row, const TFHashKeys & keys, UInt_t otherRow) const;
+
+   ULong64_t HashGroup(UInt_t row) const;
+   Bool_t   SameGroup(UInt_t row1, UInt_t row2) const;
+};
+
+#endif
@@ -0,0 +1,380 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFHisto.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <vector>
+
+#include "TH1.h"
+#include "TH2.h"
+#include "TH3.h"
+#include "TAxis.h"
+#include "TArrayD.h"
+
+#include "TFHisto.h"
+#include "TFTable.h"
+#include "TFColumn.h"
+#include "TFParallel.h"
+#include "TFError.h"
+
+#include "TObjArray.h"
+#include "TObjString.h"
+
+//_____________________________________________________________________________
+// TFHisto:
+//    Internal class, used by TFTable::MakeHisto() and TFTable::FillHisto().
+//    Should not be used directly by an application.
+//    The values of the columns are converted block by block into double
+//    arrays ( see TFBaseCol::ToDoubles() ) and are counted in the bin arrays
+//    of one chunk of rows. Every chunk is processed by one thread of the
+//    ROOT thread pool, if the implicit multi-threading of ROOT is enabled.
+//    At the end the bin arrays of all chunks are added to the histogram.
+//    TH1::Fill() is never called.
+
+static const UInt_t kBlockRows = 4096;   // rows converted to double at once
+static const Int_t  kNumStats  = 11;     // statistics of TH1::GetStats() of a TH3
+
+//_____________________________________________________________________________
+// one axis of the histogram
+
+struct TFHistoAxis
+{
+   const TAxis * fAxis;       // the axis of the histogram
+   Int_t         fNumBins;    // number of bins without underflow and overflow
+   Double_t      fMin;        // lower edge of the first bin
+   Double_t      fMax;        // upper edge of the last bin
+   Bool_t        fVariable;   // kTRUE if the bins have different sizes
+
+   void  Init(const TAxis * axis);
+   Int_t FindBin(Double_t x) const;
+};
+
+//_____________________________________________________________________________
+void TFHistoAxis::Init(const TAxis * axis)
+{
+   fAxis     = axis;
+   fNumBins  = axis->GetNbins();
+   fMin      = axis->GetXmin();
+   fMax      = axis->GetXmax();
+   fVariable = axis->IsVariableBinSize();
+}
+
+//_____________________________________________________________________________
+inline Int_t TFHistoAxis::FindBin(Double_t x) const
+{
+// the bin of x, the same bin as TAxis::FindFixBin(). Underflow is bin 0,
+// overflow and NaN is bin fNumBins + 1.
+
+   if (x < fMin)
+      return 0;
+   if (!(x < fMax))
+      return fNumBins + 1;
+   if (fVariable)
+      return fAxis->FindFixBin(x);
+   return 1 + (Int_t)(fNumBins * (x - fMin) / (fMax - fMin));
+}
+
+//_____________________________________________________________________________
+// the bins and statistics of one chunk of rows
+
+struct TFHistoPart
+{
+   std::vector<Double_t>  fSumw;              // sum of the weights of each bin
+   std::vector<Double_t>  fSumw2;             // sum of the squared weights of each bin
+   Double_t               fStats[kNumStats];  // see TH1::GetStats()
+   ULong64_t              fEntries;           // number of filled rows
+};
+
+//_____________________________________________________________________________
+static Bool_t GetColumns(const TFTable & table, const char * cols, const char * weightCol,
+                         std::vector<const TFBaseCol *> & columns)
+{
+// the columns of the comma separated list cols and the weight column as
+// last column of columns, if weightCol is defined
+
+   std::vector<TString> names;
+   TString     list(cols ? cols : "");
+   TObjArray * tokens = list.Tokenize(",");
+   for (Int_t num = 0; num < tokens->GetEntriesFast(); num++)
+      names.push_back(((TObjString*)tokens->At(num))->GetString().Strip(TString::kBoth));
+   delete tokens;
+
+   if (names.empty() || names.size() > 3)
+      {
+      TFError::SetError("TFTable::MakeHisto",
+                        "%s are not 1 to 3 columns of table %s.", cols ? cols : "",
+                        table.GetName());
+      return kFALSE;
+      }
+   if (weightCol && weightCol[0] != 0)
+      names.push_back(weightCol);
+
+   columns.clear();
+   for (size_t num = 0; num < names.size(); num++)
+      {
+      const TFBaseCol * col = &table.GetColumn(names[num].Data());
+      if (col == NULL)
+         return kFALSE;
+      if (!col->IsNumeric() || col->GetNumBins() != 1)
+         {
+         TFError::SetError("TFTable::MakeHisto",
+                           "Column %s of table %s cannot be filled into a histogram.",
+                           names[num].Data(), table.GetName());
+         return kFALSE;
+         }
+      columns.push_back(col);
+      }
+
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFHisto::FillHisto(const TFTable & table, TH1 * hist, const char * cols,
+                          const char * weightCol, TFRowIter * rowIter, Bool_t parallel)
+{
+// Fills the values of the columns cols into the histogram hist, see
+// TFTable::FillHisto().
+
+   std::vector<const TFBaseCol *> columns;
+   if (!GetColumns(table, cols, weightCol, columns))
+      return kFALSE;
+
+   Bool_t weighted = weightCol && weightCol[0] != 0;
+   Int_t  numDim   = columns.size() - (weighted ? 1 : 0);
+   if (hist == NULL || hist->GetDimension() != numDim)
+      {
+      TFError::SetError("TFTable::MakeHisto",
+                        "The histogram does not have %d dimensions to fill %s.",
+                        numDim, cols);
+      return kFALSE;
+      }
+
+   TFHistoAxis axis[3];
+   axis[0].Init(hist->GetXaxis());
+   if (numDim > 1)
+      axis[1].Init(hist->GetYaxis());
+   if (numDim > 2)
+      axis[2].Init(hist->GetZaxis());
+   Int_t numX   = axis[0].fNumBins + 2;
+   Int_t numXY  = numX * (numDim > 1 ? axis[1].fNumBins + 2 : 1);
+   Int_t nCells = numXY * (numDim > 2 ? axis[2].fNumBins + 2 : 1);
+
+   if (weighted && hist->GetSumw2N() == 0)
+      hist->Sumw2();
+   Bool_t errors = hist->GetSumw2N() > 0;
+
+   // the selected rows, NULL for all rows of the table
+   const UInt_t * rows = NULL;
+   UInt_t numRows = table.GetNumRows();
+   if (rowIter && !rowIter->fAllRows)
+      {
+      rows    = rowIter->fRow;
+      numRows = rowIter->fMaxIndex;
+      }
+
+   // every chunk has at least as many rows as bins, the merge of the bins
+   // does not take longer than the filling
+   UInt_t numChunks = parallel ? TFParallel::GetNumChunks(numRows,
+                                          std::max<UInt_t>(65536, nCells)) : 1;
+   std::vector<TFHistoPart> parts(numChunks);
+   TFParallel::Foreach(numRows, numChunks,
+         [&](UInt_t chunk, UInt_t begin, UInt_t end)
+         {
+            TFHistoPart & part = parts[chunk];
+            part.fSumw.assign(nCells, 0);
+            if (errors)
+               part.fSumw2.assign(nCells, 0);
+            std::fill(part.fStats, part.fStats + kNumStats, 0.);
+            part.fEntries = 0;
+
+            Bool_t hasNull = kFALSE;
+            for (size_t col = 0; col < columns.size(); col++)
+               hasNull |= columns[col]->HasNull();
+
+            std::vector<Double_t> buffer(columns.size() * kBlockRows);
+            const Double_t * val[4];
+            for (size_t col = 0; col < columns.size(); col++)
+               val[col] = &buffer[col * kBlockRows];
+
+            for (UInt_t first = begin; first < end; first += kBlockRows)
+               {
+               UInt_t last = std::min(end, first + kBlockRows);
+               for (size_t col = 0; col < columns.size(); col++)
+                  {
+                  Double_t * out = &buffer[col * kBlockRows];
+                  if (rows == NULL)
+                     columns[col]->ToDoubles(first, last, out);
+                  else
+                     for (UInt_t index = first; index < last; index++)
+                        *out++ = (*columns[col])[rows[index]];
+                  }
+
+               for (UInt_t index = first; index < last; index++)
+                  {
+                  UInt_t num = index - first;
+                  if (hasNull)
+                     {
+                     UInt_t row = rows ? rows[index] : index;
+                     Bool_t null = kFALSE;
+                     for (size_t col = 0; col < columns.size() && !null; col++)
+                        null = columns[col]->HasNull() && columns[col]->IsNull(row);
+                     if (null)
+                        continue;
+                     }
+
+                  Double_t w   = weighted ? val[numDim][num] : 1;
+                  Int_t    bx  = axis[0].FindBin(val[0][num]);
+                  Int_t    by  = numDim > 1 ? axis[1].FindBin(val[1][num]) : 1;
+                  Int_t    bz  = numDim > 2 ? axis[2].FindBin(val[2][num]) : 1;
+                  Int_t    bin = bx + numX * (numDim > 1 ? by : 0) +
+                                 numXY * (numDim > 2 ? bz : 0);
+                  part.fEntries++;
+                  part.fSumw[bin] += w;
+                  if (errors)
+                     part.fSumw2[bin] += w * w;
+
+                  // like TH1::Fill() only values inside the axis ranges
+                  // contribute to the statistics
+                  if (bx == 0 || bx > axis[0].fNumBins ||
+                      (numDim > 1 && (by == 0 || by > axis[1].fNumBins)) ||
+                      (numDim > 2 && (bz == 0 || bz > axis[2].fNumBins)))
+                     continue;
+
+                  Double_t x = val[0][num];
+                  Double_t * s = part.fStats;
+                  s[0] += w;
+                  s[1] += w * w;
+                  s[2] += w * x;
+                  s[3] += w * x * x;
+                  if (numDim > 1)
+                     {
+                     Double_t y = val[1][num];
+                     s[4] += w * y;
+                     s[5] += w * y * y;
+                     s[6] += w * x * y;
+                     if (numDim > 2)
+                        {
+                        Double_t z = val[2][num];
+                        s[7]  += w * z;
+                        s[8]  += w * z * z;
+                        s[9]  += w * x * z;
+                        s[10] += w * y * z;
+                        }
+                     }
+                  }
+               }
+         });
+
+   // the bins of all chunks are added in parallel, every thread adds one
+   // range of bins
+   UInt_t numMerge = numChunks > 1 ? numChunks : 1;
+   TFParallel::Foreach(nCells, std::min<UInt_t>(numMerge, nCells > 0 ? nCells : 1),
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {
+            for (UInt_t chunk = 1; chunk < numChunks; chunk++)
+               for (UInt_t bin = begin; bin < end; bin++)
+                  {
+                  parts[0].fSumw[bin] += parts[chunk].fSumw[bin];
+                  if (errors)
+                     parts[0].fSumw2[bin] += parts[chunk].fSumw2[bin];
+                  }
+         });
+
+   Double_t  stats[TH1::kNstat];
+   ULong64_t entries = 0;
+   std::fill(stats, stats + TH1::kNstat, 0.);
+   hist->GetStats(stats);
+   Double_t  oldEntries = hist->GetEntries();
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      {
+      for (Int_t stat = 0; stat < kNumStats; stat++)
+         stats[stat] += parts[chunk].fStats[stat];
+      entries += parts[chunk].fEntries;
+      }
+
+   TArrayD * sumw2 = errors ? hist->GetSumw2() : NULL;
+   for (Int_t bin = 0; bin < nCells; bin++)
+      {
+      if (parts[0].fSumw[bin] != 0)
+         hist->AddBinContent(bin, parts[0].fSumw[bin]);
+      if (sumw2)
+         (*sumw2)[bin] += parts[0].fSumw2[bin];
+      }
+
+   hist->PutStats(stats);
+   hist->SetEntries(oldEntries + entries);
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+TH1 * TFHisto::MakeHisto(const TFTable & table, const char * cols, Int_t numBins,
+                         const char * weightCol, TFRowIter * rowIter,
+                         const char * name, Bool_t parallel)
+{
+// Creates a TH1D, TH2D or TH3D and fills the values of the columns cols,
+// see TFTable::MakeHisto().
+
+   std::vector<const TFBaseCol *> columns;
+   if (!GetColumns(table, cols, weightCol, columns))
+      return NULL;
+   if (numBins < 1)
+      {
+      TFError::SetError("TFTable::MakeHisto", "Invalid number of bins %d.", numBins);
+      return NULL;
+      }
+
+   // the axis ranges are the ranges of the values of the whole columns
+   Int_t    numDim = columns.size() - (weightCol && weightCol[0] != 0 ? 1 : 0);
+   Double_t min[3], max[3];
+   for (Int_t dim = 0; dim < numDim; dim++)
+      {
+      const TFColStats & stats = columns[dim]->GetStats();
+      min[dim] = stats.GetCount() > 0 ? stats.GetMin() : 0;
+      max[dim] = stats.GetCount() > 0 ? stats.GetMax() : 1;
+      if (max[dim] > min[dim])
+         // the maximum is inside the last bin
+         max[dim] += (max[dim] - min[dim]) * 1e-6;
+      else
+         {
+         min[dim] -= 0.5;
+         max[dim] += 0.5;
+         }
+      }
+
+   // the default name is the table name and the column names, histograms
+   // of different columns of one table do not replace each other
+   TString histName = name ? name : table.GetName();
+   for (Int_t dim = 0; dim < numDim && name == NULL; dim++)
+      {
+      histName += "_";
+      histName += columns[dim]->GetName();
+      }
+
+   TH1 * hist;
+   if (numDim == 1)
+      hist = new TH1D(histName.Data(), cols, numBins, min[0], max[0]);
+   else if (numDim == 2)
+      hist = new TH2D(histName.Data(), cols, numBins, min[0], max[0],
+                      numBins, min[1], max[1]);
+   else
+      hist = new TH3D(histName.Data(), cols, numBins, min[0], max[0],
+                      numBins, min[1], max[1], numBins, min[2], max[2]);
+
+   hist->GetXaxis()->SetTitle(columns[0]->GetName());
+   if (numDim > 1)
+      hist->GetYaxis()->SetTitle(columns[1]->GetName());
+   if (numDim > 2)
+      hist->GetZaxis()->SetTitle(columns[2]->GetName());
+
+   if (!FillHisto(table, hist, cols, weightCol, rowIter, parallel))
+      {
+      delete hist;
+      return NULL;
+      }
+   return hist;
+}
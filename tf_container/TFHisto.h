@@ -0,0 +1,35 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFHisto.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFHisto
+#define ROOT_TFHisto
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+
+class TFTable;
+class TFRowIter;
+class TH1;
+
+//_____________________________________________________________________________
+
+class TFHisto
+{
+public:
+   static TH1 *   MakeHisto(const TFTable & table, const char * cols, Int_t numBins,
+                            const char * weightCol, TFRowIter * rowIter,
+                            const char * name = NULL, Bool_t parallel = kTRUE);
+   static Bool_t  FillHisto(const TFTable & table, TH1 * hist, const char * cols,
+                            const char * weightCol, TFRowIter * rowIter,
+                            Bool_t parallel = kTRUE);
+};
+
+#endif
@@ -496,7 +496,7 @@ TH1 * TFBaseImage::MakeHisto(UInt_t zPos, TClass * type)
    return hist;
 }
 //_____________________________________________________________________________
-TTree * TFBaseImage::MakeTree(TFNameConvert * nameConvert) const
+TTree * TFBaseImage::MakeTree(TFNameConvert * nameConvert, TDirectory * dir) const
 {
 // cretes a TTree. One branch is the pixel value the other branches are
 // the axis of this image. There is one record per image pixel which are
@@ -504,11 +504,20 @@ TTree * TFBaseImage::MakeTree(TFNameConvert * nameConvert) const
 // the pixels of this sub - image.
 // nameConvert can be NULL. But it will be adopted by this
 // function and will be deleted by this function if it is not NULL.
-// The calling function has to delete the returning tree.
+// If dir is not NULL, for example a TFile open for writing, the tree is
+// created in this directory and its baskets are written to the file while
+// the tree is filled. The tree is written into dir at the end.
+// The calling function has to delete the returning tree. If dir is not
+// NULL, the tree is owned by dir and deleted when dir is closed.
    if (nameConvert == NULL)
       nameConvert = new TFNameConvert();
 
    TTree * tree= new TTree(nameConvert->Conv(GetName()), nameConvert->Conv(GetName()) );
+   if (dir)
+      {
+      tree->SetDirectory(dir);
+      tree->SetImplicitMT(kTRUE);
+      }
 
    // create branch for pixel values
    MakePixelBranch(tree);
@@ -516,6 +525,8 @@ TTree * TFBaseImage::MakeTree(TFNameConvert * nameConvert) const
    UInt_t numDim = GetNumDim(IsSubSection());
    if (numDim == 0)
       {
+      if (dir)
+         tree->Write("", TObject::kOverwrite);
       delete nameConvert;
       return tree;
       }
@@ -550,30 +561,34 @@ TTree * TFBaseImage::MakeTree(TFNameConvert * nameConvert) const
    // fill the tree pixel by pixel
    if (IsSubSection())
       {
-      // for sub- image
-      do {
-         int index = 0;
-         for (int dim = 0; dim < numDim; dim++)
-            index += (pos[dim] + fSubOffset[dim]) * fSizeNFr[dim] + fSubFreeze[dim];
+      // for sub- image: the index of the first pixel is computed once, 
+      // then it is updated with the step of each dimension in the 
+      // original image
+      UInt_t index = 0;
+      ULong64_t numPixels = 1;
+      for (UInt_t dim = 0; dim < numDim; dim++)
+         {
+         index += fSubOffset[dim] * fSizeNFr[dim] + fSubFreeze[dim];
+         numPixels *= size[dim];
+         }
 
+      for (ULong64_t pixel = 0; pixel < numPixels; pixel++)
+         {
          if (FillBranchBuffer(index))
             tree->Fill();
             
-         // set pos for next pixel
+         // set pos and index for next pixel
          UInt_t dim = numDim;
          do {
             dim--;
             pos[dim] += 1;
+            index    += fSizeNFr[dim];
             if (pos[dim] != size[dim])
                break;
+            index    -= size[dim] * fSizeNFr[dim];
             pos[dim] = 0;
             } while (dim != 0);
-
-         int num = 0;
-         for (int dim = 0; dim < numDim; dim++)
-            num += pos[dim];
-         if (num == 0) break;
-         } while (1);
+         }
       }
    else
       {
@@ -596,6 +611,9 @@ TTree * TFBaseImage::MakeTree(TFNameConvert * nameConvert) const
          }
       }
 
+   if (dir)
+      tree->Write("", TObject::kOverwrite);
+
    delete nameConvert;
    delete [] pos;
    delete [] size;
@@ -26,6 +26,7 @@
 #endif
 
 class TFNameConvert;
+class TDirectory;
 template <class T, class F> class TFImage;
 
 
@@ -97,7 +98,8 @@ public:
 
    virtual TH1 *     MakeHisto(TClass * type = TH2D::Class());
    virtual TH1 *     MakeHisto(UInt_t zPos, TClass * type = TH2D::Class());
-   virtual TTree *   MakeTree(TFNameConvert * nameConvert = NULL) const;
+   virtual TTree *   MakeTree(TFNameConvert * nameConvert = NULL,
+                              TDirectory * dir = NULL) const;
 
            operator  TFImage<Bool_t, BoolFormat>       * ();
            operator  TFImage<Char_t, CharFormat>       * ();
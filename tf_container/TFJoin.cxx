@@ -0,0 +1,277 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFJoin.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "TFJoin.h"
+#include "TFHashKeys.h"
+#include "TFTable.h"
+#include "TFColumn.h"
+#include "TFParallel.h"
+#include "TFError.h"
+
+//_____________________________________________________________________________
+// TFJoin:
+//    Internal class, used by TFTable::Join() and TFTable::JoinRows().
+//    Should not be used directly by an application.
+//    The equi-join of two tables is a hash join: the key values of the
+//    smaller table are stored in a hash table, then the rows of the other
+//    table are looked up in this hash table in parallel by the threads of
+//    the ROOT thread pool, if the implicit multi-threading of ROOT is
+//    enabled. Numerical key columns of different types are compared by
+//    their values, string key columns by their strings. NULL and NaN keys
+//    never match.
+
+static const UInt_t kNoRow = 0xffffffff;   // end of a chain of the hash table
+
+//_____________________________________________________________________________
+Bool_t TFJoin::JoinRows(const TFTable & left, const TFTable & right,
+                        const char * leftKeys, const char * rightKeys,
+                        std::vector<UInt_t> & leftRows, std::vector<UInt_t> & rightRows,
+                        Bool_t leftJoin, Bool_t parallel)
+{
+// Computes the pairs of rows of the equi-join of the tables left and
+// right, see TFTable::JoinRows().
+
+   leftRows.clear();
+   rightRows.clear();
+
+   TFHashKeys lKeys, rKeys;
+   if (!lKeys.Init(left, leftKeys, "TFTable::Join") ||
+       !rKeys.Init(right, rightKeys ? rightKeys : leftKeys, "TFTable::Join"))
+      return kFALSE;
+
+   if (lKeys.GetNumKeys() != rKeys.GetNumKeys())
+      {
+      TFError::SetError("TFTable::Join",
+                        "Different number of key columns of table %s and table %s.",
+                        left.GetName(), right.GetName());
+      return kFALSE;
+      }
+   for (UInt_t num = 0; num < lKeys.GetNumKeys(); num++)
+      if (lKeys.IsString(num) != rKeys.IsString(num))
+         {
+         TFError::SetError("TFTable::Join",
+                           "Cannot compare the string and the numerical key columns %s and %s.",
+                           lKeys.GetColumn(num)->GetName(), rKeys.GetColumn(num)->GetName());
+         return kFALSE;
+         }
+
+   // the hash table is built for the smaller table. The rows of the
+   // other table are looked up in the hash table.
+   Bool_t buildLeft = left.GetNumRows() < right.GetNumRows();
+   const TFHashKeys & bKeys = buildLeft ? lKeys : rKeys;
+   const TFHashKeys & pKeys = buildLeft ? rKeys : lKeys;
+   UInt_t numBuild = buildLeft ? left.GetNumRows()  : right.GetNumRows();
+   UInt_t numProbe = buildLeft ? right.GetNumRows() : left.GetNumRows();
+
+   std::vector<ULong64_t> hashes(numBuild);
+   std::vector<char>      valid(numBuild);
+   TFParallel::Foreach(numBuild, parallel ? TFParallel::GetNumChunks(numBuild) : 1,
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {
+            for (UInt_t row = begin; row < end; row++)
+               valid[row] = bKeys.HashMatch(row, hashes[row]);
+         });
+
+   // the chains of the buckets link the rows in ascending order
+   ULong64_t numBuckets = 1;
+   while (numBuckets < (ULong64_t)numBuild * 2)
+      numBuckets <<= 1;
+   ULong64_t           mask = numBuckets - 1;
+   std::vector<UInt_t> head(numBuckets, kNoRow);
+   std::vector<UInt_t> next(numBuild);
+   for (UInt_t row = numBuild; row-- > 0; )
+      if (valid[row])
+         {
+         next[row] = head[hashes[row] & mask];
+         head[hashes[row] & mask] = row;
+         }
+
+   // every chunk of the other table collects its pairs of rows
+   UInt_t numChunks = parallel ? TFParallel::GetNumChunks(numProbe) : 1;
+   std::vector<std::vector<std::pair<UInt_t, UInt_t> > > pairs(numChunks);
+   Bool_t unmatched = leftJoin && !buildLeft;
+   TFParallel::Foreach(numProbe, numChunks,
+         [&](UInt_t chunk, UInt_t begin, UInt_t end)
+         {
+            std::vector<std::pair<UInt_t, UInt_t> > & out = pairs[chunk];
+            for (UInt_t row = begin; row < end; row++)
+               {
+               ULong64_t hash;
+               Bool_t    found = kFALSE;
+               if (pKeys.HashMatch(row, hash))
+                  for (UInt_t bRow = head[hash & mask]; bRow != kNoRow; bRow = next[bRow])
+                     if (hashes[bRow] == hash && pKeys.Match(row, bKeys, bRow))
+                        {
+                        out.push_back(std::make_pair(row, bRow));
+                        found = kTRUE;
+                        }
+               if (!found && unmatched)
+                  out.push_back(std::make_pair(row, (UInt_t)TF_MAX_ROWS));
+               }
+         });
+
+   size_t num = 0;
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      num += pairs[chunk].size();
+
+   if (!buildLeft)
+      {
+      // the pairs are already ordered by the left row
+      leftRows.reserve(num);
+      rightRows.reserve(num);
+      for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+         for (size_t i = 0; i < pairs[chunk].size(); i++)
+            {
+            leftRows.push_back(pairs[chunk][i].first);
+            rightRows.push_back(pairs[chunk][i].second);
+            }
+      return kTRUE;
+      }
+
+   // order the pairs by the left row and add the left rows without match
+   std::vector<std::pair<UInt_t, UInt_t> > all;
+   all.reserve(num);
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      {
+      for (size_t i = 0; i < pairs[chunk].size(); i++)
+         all.push_back(std::make_pair(pairs[chunk][i].second, pairs[chunk][i].first));
+      std::vector<std::pair<UInt_t, UInt_t> >().swap(pairs[chunk]);
+      }
+
+   if (leftJoin)
+      {
+      std::vector<char> matched(numBuild, 0);
+      for (size_t i = 0; i < all.size(); i++)
+         matched[all[i].first] = 1;
+      for (UInt_t row = 0; row < numBuild; row++)
+         if (!matched[row])
+            all.push_back(std::make_pair(row, (UInt_t)TF_MAX_ROWS));
+      }
+   std::sort(all.begin(), all.end());
+
+   leftRows.resize(all.size());
+   rightRows.resize(all.size());
+   for (size_t i = 0; i < all.size(); i++)
+      {
+      leftRows[i]  = all[i].first;
+      rightRows[i] = all[i].second;
+      }
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+TFTable * TFJoin::Join(const TFTable & left, const TFTable & right,
+                       const char * leftKeys, const char * rightKeys,
+                       Bool_t leftJoin, Bool_t parallel)
+{
+// Creates the table of the equi-join of the tables left and right, see
+// TFTable::Join().
+
+   std::vector<UInt_t> lRows, rRows;
+   if (!JoinRows(left, right, leftKeys, rightKeys, lRows, rRows, leftJoin, parallel))
+      return NULL;
+
+   // the key columns of the right table are not copied
+   TFHashKeys rKeys;
+   rKeys.Init(right, rightKeys ? rightKeys : leftKeys, "TFTable::Join");
+   std::set<const TFBaseCol *> rKeyCols;
+   for (UInt_t num = 0; num < rKeys.GetNumKeys(); num++)
+      rKeyCols.insert(rKeys.GetColumn(num));
+
+   return MakeTable(left, right, lRows, rRows, rKeyCols, parallel);
+}
+
+//_____________________________________________________________________________
+TFTable * TFJoin::MakeTable(const TFTable & left, const TFTable & right,
+                            const std::vector<UInt_t> & leftRows,
+                            const std::vector<UInt_t> & rightRows,
+                            const std::set<const TFBaseCol *> & skipCols,
+                            Bool_t parallel)
+{
+// Creates a new table with the rows leftRows of the table left and the
+// rows rightRows of the table right. The new table has all columns of 
+// left and all columns of right except the columns in skipCols. A column
+// of right gets the suffix "_" and the name of right if left has a column
+// with the same name. A row TF_MAX_ROWS of rightRows is a row with NULL
+// values in all columns of right.
+
+   std::vector<const TFBaseCol *> from;
+   std::vector<TFBaseCol *>       to;
+   std::vector<Bool_t>            isRight;
+   std::set<std::string>          names;
+
+   TFColIter i_col = left.MakeColIterator();
+   while (i_col.Next())
+      {
+      from.push_back(&*i_col);
+      isRight.push_back(kFALSE);
+      names.insert(i_col->GetName());
+      }
+
+   i_col = right.MakeColIterator();
+   while (i_col.Next())
+      if (skipCols.count(&*i_col) == 0)
+         {
+         from.push_back(&*i_col);
+         isRight.push_back(kTRUE);
+         }
+
+   // a column of the right table gets the name of the table as suffix 
+   // if the left table has a column with the same name. A number is
+   // appended if this name is used, too.
+   for (size_t num = 0; num < from.size(); num++)
+      {
+      TString name = from[num]->GetName();
+      if (isRight[num] && names.count(name.Data()) > 0)
+         {
+         name += "_";
+         name += right.GetName();
+         TString base = name;
+         for (Int_t suffix = 2; names.count(name.Data()) > 0; suffix++)
+            {
+            name  = base;
+            name += "_";
+            name += suffix;
+            }
+         }
+      names.insert(name.Data());
+
+      to.push_back((TFBaseCol *)from[num]->IsA()->New());
+      to.back()->SetName(name);
+      }
+
+   // the columns are copied in parallel
+   UInt_t numCols = from.size();
+   TFParallel::Foreach(numCols, parallel ? TFParallel::GetNumChunks(numCols, 1) : 1,
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {
+            for (UInt_t num = begin; num < end; num++)
+               to[num]->CopyRows(*from[num], isRight[num] ? rightRows.data() : leftRows.data(),
+                                 leftRows.size());
+         });
+
+   TFTable * table = new TFTable(left.GetName(), (UInt_t)leftRows.size());
+   for (UInt_t num = 0; num < numCols; num++)
+      if (table->AddColumn(to[num]) != 0)
+         {
+         // AddColumn() rejected the column, the table does not adopt it
+         TFError::SetError("TFTable::Join", 
+                           "Column %s of table %s is missing in the joined table",
+                           from[num]->GetName(), 
+                           isRight[num] ? right.GetName() : left.GetName());
+         delete to[num];
+         }
+
+   return table;
+}
@@ -0,0 +1,46 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFJoin.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFJoin
+#define ROOT_TFJoin
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <vector>
+#include <set>
+
+
+class TFTable;
+class TFBaseCol;
+
+//_____________________________________________________________________________
+
+class TFJoin
+{
+public:
+   static Bool_t     JoinRows(const TFTable & left, const TFTable & right,
+                              const char * leftKeys, const char * rightKeys,
+                              std::vector<UInt_t> & leftRows,
+                              std::vector<UInt_t> & rightRows,
+                              Bool_t leftJoin = kFALSE, Bool_t parallel = kTRUE);
+
+   static TFTable *  Join(const TFTable & left, const TFTable & right,
+                          const char * leftKeys, const char * rightKeys,
+                          Bool_t leftJoin = kFALSE, Bool_t parallel = kTRUE);
+
+   static TFTable *  MakeTable(const TFTable & left, const TFTable & right,
+                               const std::vector<UInt_t> & leftRows,
+                               const std::vector<UInt_t> & rightRows,
+                               const std::set<const TFBaseCol *> & skipCols,
+                               Bool_t parallel = kTRUE);
+};
+
+#endif
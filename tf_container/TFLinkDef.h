@@ -15,8 +15,6 @@
 #pragma link off all classes;
 #pragma link off all functions;
 
-#pragma link C++ global g_flt;
-
 #pragma link C++ function TFRead;
 #pragma link C++ function TFReadTable;
 #pragma link C++ function TFReadGroup;
@@ -60,7 +58,6 @@
 #pragma link C++ class TFTable+;
 #pragma link C++ class TFColIter;
 #pragma link C++ class TFRowIter;
-#pragma link C++ class TFFlt;
 #pragma link C++ class TFNullIter;
 
 #pragma link C++ class TFGroup+;
@@ -0,0 +1,171 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFParallel.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include "RConfigure.h"
+#include "TROOT.h"
+
+#ifdef R__USE_IMT
+#include "ROOT/TThreadExecutor.hxx"
+#endif
+
+#include "TFParallel.h"
+#include "TFError.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+//_____________________________________________________________________________
+// TFParallel:
+//    Internal helper class to process a range of rows in several chunks
+//    in parallel. The chunks are processed by the ROOT thread pool if the
+//    implicit multi-threading of ROOT is enabled with
+//    ROOT::EnableImplicitMT(), otherwise one chunk after the other is
+//    processed in the calling thread.
+
+#ifdef R__USE_IMT
+//_____________________________________________________________________________
+static std::shared_ptr<ROOT::TThreadExecutor> GetExecutor()
+{
+// returns the executor of the ROOT thread pool, which is shared by all
+// calls of Foreach(). A new executor is created only when the size of the
+// thread pool has changed, a call which still uses the old executor keeps
+// it alive.
+
+   static std::mutex                               mutex;
+   static std::shared_ptr<ROOT::TThreadExecutor>   executor;
+   static UInt_t                                   poolSize = 0;
+
+   std::lock_guard<std::mutex> lock(mutex);
+   if (!executor || poolSize != ROOT::GetThreadPoolSize())
+      {
+      poolSize = ROOT::GetThreadPoolSize();
+      executor = std::make_shared<ROOT::TThreadExecutor>();
+      }
+   return executor;
+}
+#endif
+//_____________________________________________________________________________
+UInt_t TFParallel::GetNumThreads()
+{
+// Returns the number of threads of the ROOT thread pool or 1 if the 
+// implicit multi-threading is not enabled.
+
+#ifdef R__USE_IMT
+   if (ROOT::IsImplicitMTEnabled() && ROOT::GetThreadPoolSize() > 1)
+      return ROOT::GetThreadPoolSize();
+#endif
+   return 1;
+}
+//_____________________________________________________________________________
+UInt_t TFParallel::GetNumChunks(UInt_t num, UInt_t minChunkSize)
+{
+// Returns the number of chunks to process num items. Each chunk has
+// at least minChunkSize items. There are up to 4 chunks per thread to
+// balance the load of the threads. The function returns 1 if the 
+// implicit multi-threading is not enabled.
+
+   UInt_t numThreads = GetNumThreads();
+   if (numThreads <= 1 || num <= minChunkSize)
+      return 1;
+
+   UInt_t numChunks = num / (minChunkSize > 0 ? minChunkSize : 1);
+   return numChunks < 4 * numThreads ? numChunks : 4 * numThreads;
+}
+//_____________________________________________________________________________
+void TFParallel::Foreach(UInt_t num, UInt_t numChunks,
+                         const std::function<void (UInt_t chunk, UInt_t begin, UInt_t end)> & func)
+{
+// Splits the range [0, num) into numChunks chunks of about the same size
+// and calls func(chunk, begin, end) for every chunk. The chunks are 
+// processed in parallel if there is more than one chunk and the implicit
+// multi-threading of ROOT is enabled. 
+// Errors of TFError in the threads of the pool are handled with the
+// error type of the calling thread: they are added to the error messages
+// of the calling thread and, with kExceptionErr, the first error is thrown
+// as TFException in the calling thread. A chunk stops at its first error
+// in this case, the other chunks are still processed.
+// The function returns after all chunks are processed.
+
+   if (numChunks == 0)
+      return;
+
+#ifdef R__USE_IMT
+   if (numChunks > 1 && GetNumThreads() > 1)
+      {
+      TFErrorType errType = TFError::GetErrorType();
+      std::vector<TFErrMsg *> errors(numChunks, (TFErrMsg*)NULL);
+
+      std::shared_ptr<ROOT::TThreadExecutor> pool = GetExecutor();
+      try
+         {
+         pool->Foreach([&](UInt_t chunk)
+                      {
+                      // the errors of the chunk are collected apart from the
+                      // errors of the thread, which may be the calling thread
+                      TFErrorType threadType = TFError::GetErrorType();
+                      TFErrMsg  * threadMsgs = TFError::TakeErrors();
+                      TFError::SetErrorType((TFErrorType)(errType | kStoreErr));
+                      try
+                         {
+                         func(chunk, GetChunkBegin(num, numChunks, chunk),
+                                     GetChunkBegin(num, numChunks, chunk + 1));
+                         }
+                      catch (TFException &)
+                         {
+                         // the error message is stored
+                         }
+                      catch (...)
+                         {
+                         delete TFError::TakeErrors();
+                         TFError::RestoreErrors(threadMsgs);
+                         TFError::SetErrorType(threadType);
+                         throw;
+                         }
+                      errors[chunk] = TFError::TakeErrors();
+                      TFError::RestoreErrors(threadMsgs);
+                      TFError::SetErrorType(threadType);
+                      },
+                      ROOT::TSeqU(numChunks));
+         }
+      catch (...)
+         {
+         // the errors of the other chunks are lost
+         for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+            delete errors[chunk];
+         throw;
+         }
+
+      // pass the errors in the order of the chunks to the calling thread
+      TString function, msg;
+      for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+         {
+         for (TFErrMsg * errMsg = errors[chunk]; errMsg; errMsg = errMsg->fNext)
+            {
+            if (function.IsNull())
+               {
+               function = errMsg->fFunction;
+               msg      = errMsg->fMsg;
+               }
+            if (errType & kStoreErr)
+               TFError::AddError(errMsg->fFunction, errMsg->fMsg);
+            }
+         delete errors[chunk];
+         }
+
+      if ((errType & kExceptionErr) && !function.IsNull())
+         throw TFException(function.Data(), "%s", msg.Data());
+      return;
+      }
+#endif
+
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      func(chunk, GetChunkBegin(num, numChunks, chunk),
+                  GetChunkBegin(num, numChunks, chunk + 1));
+}
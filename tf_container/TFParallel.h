@@ -0,0 +1,34 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFParallel.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFParallel
+#define ROOT_TFParallel
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <functional>
+
+
+//_____________________________________________________________________________
+
+class TFParallel
+{
+public:
+   static UInt_t  GetNumThreads();
+   static UInt_t  GetNumChunks(UInt_t num, UInt_t minChunkSize = 65536);
+   static UInt_t  GetChunkBegin(UInt_t num, UInt_t numChunks, UInt_t chunk)
+                     {return (UInt_t)((ULong64_t)num * chunk / numChunks);}
+
+   static void    Foreach(UInt_t num, UInt_t numChunks,
+                          const std::function<void (UInt_t chunk, UInt_t begin, UInt_t end)> & func);
+};
+
+#endif
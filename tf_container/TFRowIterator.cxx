@@ -10,22 +10,27 @@
 //
 // ////////////////////////////////////////////////////////////////////////////
 #include <stdlib.h>
-#include <unistd.h>
-
-#include "TROOT.h"
 
 #include "TFTable.h"
 #include "TFColumn.h"
 #include "TFRowIterator.h"
+#include "TFFilter.h"
+#include "TFBitmap.h"
+#include "TFParallel.h"
+#include "TFSort.h"
+#include "TFSkyIndex.h"
 #include "TFError.h"
 
-#include <string>
-#include <list>
+#include "TObjArray.h"
+#include "TObjString.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
 
 #ifndef TF_CLASS_IMP
 #define TF_CLASS_IMP
 ClassImp(TFRowIter)
-ClassImp(TFFlt)
 #endif    // TF_CLASS_IMP
 
 //_____________________________________________________________________________
@@ -35,29 +40,18 @@ ClassImp(TFFlt)
 //    returned in increasing order. This iterator should be used to filter 
 //    rows and to sort the rows of a table. See functions Sort() and Filter()
 //    for more information how to sort the rows and how to filter rows.
-//
-// TFFlt:
-//    Internal class, used by the Filter() function. Should not used directly
-//    by an application.
-
-TFFlt g_flt;
-
+//    Different iterators, also of the same table, can filter and sort their
+//    rows at the same time in different threads.
 
-static TFBaseCol * CompCol;
-extern "C" {
-static int Comp(const void * row1, const void * row2)
-{
-   return CompCol->CompareRows(*(UInt_t*)row1, *(UInt_t*)row2);
-}
-}
 //_____________________________________________________________________________
 TFRowIter::TFRowIter(const TFTable * table)
 {
 // Private constructor. Use TFTable::MakeRowIterator() to create
 // a row iterator.
 
-   fTable = table;
-   fRow   = NULL;
+   fTable    = table;
+   fRow      = NULL;
+   fParallel = kTRUE;
 
    ClearFilterSort();
 }
@@ -69,6 +63,8 @@ TFRowIter::TFRowIter(const TFRowIter & rowIter)
    fTable      = rowIter.fTable;
    fNextIndex  = rowIter.fNextIndex;
    fMaxIndex   = rowIter.fMaxIndex;
+   fParallel   = rowIter.fParallel;
+   fAllRows    = rowIter.fAllRows;
 
    fRow = new UInt_t [fMaxIndex];
    memcpy(fRow, rowIter.fRow, fMaxIndex * sizeof(UInt_t));
@@ -84,6 +80,8 @@ TFRowIter & TFRowIter::operator = (const TFRowIter & rowIter)
       fTable      = rowIter.fTable;
       fNextIndex  = rowIter.fNextIndex;
       fMaxIndex   = rowIter.fMaxIndex;
+      fParallel   = rowIter.fParallel;
+      fAllRows    = rowIter.fAllRows;
 
       delete [] fRow;
       fRow = new UInt_t [fMaxIndex];
@@ -92,34 +90,142 @@ TFRowIter & TFRowIter::operator = (const TFRowIter & rowIter)
    return *this;
 }
 //_____________________________________________________________________________
-void TFRowIter::Sort(const char * colName)
+void TFRowIter::Sort(const char * colNames, Bool_t ascending)
 {
-// Sort the rows depending on the values of the column "colName".
-// If colName is a column with more than one item per row only the
-// first item of each row is used to sort the rows. 
+// Sort the rows depending on the values of the column "colNames".
+// colNames can also be a comma separated list of column names, the rows 
+// are sorted by the first column, rows with the same value in the first
+// column by the second column and so on. 
+// The rows are sorted in ascending order if ascending is kTRUE, else in
+// descending order. The order can also be defined for each column by 
+// "asc" or "desc" after the column name, for example: "CCD_ID, TIME desc".
+// If a column has more than one item per row the rows are sorted by the
+// first item, rows with the same first item by the second item and so on.
+// One item of such a column can be selected with its bin number in
+// brackets: "colName[3]".
+// The sort is stable: rows with the same values keep their order. 
+// Therefore also several calls of this function can be used to sort the
+// rows by several columns. The last call defines the primary sort order.
 // The rows are not sorted in the table but a row - index list is sorted.
 // Therefore the table cannot be saved into a file with sorted rows.
 // But the operator * () will return the row numbers depending on the 
 // sorting of this function.
-// If the column colName does not exist in the table of this iterator nothing
-// will happen, no sorting, no warning and no error message.
+// If one of the columns does not exist in the table of this iterator nothing
+// will happen, no sorting, no warning and no error message. A bin number
+// in brackets which is not a number is reported as error, nothing is
+// sorted in this case, too.
+// If the implicit multi-threading of ROOT is enabled ( see 
+// ROOT::EnableImplicitMT() ) and SetParallel(kFALSE) was not called, large 
+// tables are sorted by the threads of the ROOT thread pool.
+// The first ascending sort of an iterator by one column with an index ( see
+// TFTable::BuildIndex() ) or by a column which is already sorted copies 
+// the rows of the index.
+
+   struct SortKey
+      {
+      TFBaseCol * fCol;       // the column
+      Int_t       fBin;       // the bin, -1: all bins
+      Bool_t      fAscending; // sort order of this key
+      };
+   std::vector<SortKey> keys;
+
+   TString names(colNames ? colNames : "");
+   TObjArray * tokens = names.Tokenize(",");
+   TString badBin;     // a column name with an invalid bin
 
    TFErrorType errT = TFError::GetErrorType();
    TFError::SetErrorType(kExceptionErr);
 
-   try{	
-      CompCol = &(fTable->GetColumn(colName));
+   for (Int_t num = 0; num < tokens->GetEntriesFast(); num++)
+      {
+      TString name = ((TObjString*)tokens->At(num))->GetString();
+      SortKey key = {NULL, -1, ascending};
+
+      // the sort order after the name
+      name = name.Strip(TString::kBoth);
+      if (name.EndsWith(" desc", TString::kIgnoreCase))
+         {
+         key.fAscending = kFALSE;
+         name.Resize(name.Length() - 5);
+         }
+      else if (name.EndsWith(" asc", TString::kIgnoreCase))
+         {
+         key.fAscending = kTRUE;
+         name.Resize(name.Length() - 4);
+         }
+      name = name.Strip(TString::kBoth);
+
+      // the bin number in brackets
+      Ssiz_t bracket = name.Index("[");
+      if (bracket != kNPOS)
+         {
+         char * end;
+         key.fBin = (Int_t)strtol(name.Data() + bracket + 1, &end, 10);
+         if (end == name.Data() + bracket + 1 || *end != ']' || end[1] != 0)
+            {
+            badBin = name;
+            keys.clear();
+            break;
+            }
+         name.Resize(bracket);
+         name = name.Strip(TString::kBoth);
+         }
+
+      try{	
+         key.fCol = &(fTable->GetColumn(name.Data()));
+         }
+      catch (TFException) 
+         {
+         key.fCol = NULL;
+         }	
+
+      if (key.fCol == NULL || key.fBin >= key.fCol->GetNumBins())
+         {
+         keys.clear();
+         break;
+         }
+
+      keys.push_back(key);
       }
-   catch (TFException) 
+
+   TFError::SetErrorType(errT);
+   delete tokens;
+
+   if (!badBin.IsNull())
       {
-      TFError::SetErrorType(errT);
+      TFError::SetError("TFRowIter::Sort", 
+                        "Invalid bin number in %s. The rows are not sorted.",
+                        badBin.Data());
       return;
-      }	
+      }
 
-   TFError::SetErrorType(errT);
+   // all rows sorted by one column with an index are the rows of the index
+   if (fAllRows && keys.size() == 1 && keys[0].fAscending && keys[0].fBin <= 0 &&
+       keys[0].fCol->GetNumBins() == 1 && keys[0].fCol->HasIndex())
+      {
+      if (!keys[0].fCol->IsSorted())
+         {
+         keys[0].fCol->GetIndexRows(fRow);
+         fAllRows = kFALSE;
+         }
+      return;
+      }
+   if (!keys.empty())
+      fAllRows = kFALSE;
 
    // now we can sort the rows == sort the index numbers in fRow
-   qsort(fRow, fMaxIndex, sizeof(UInt_t), Comp);
+   // the stable sort sorts first by the last key
+   for (std::vector<SortKey>::reverse_iterator i_key = keys.rbegin();
+        i_key != keys.rend(); i_key++)
+      {
+      if (i_key->fBin >= 0)
+         TFSort::SortRows(*i_key->fCol, i_key->fBin, i_key->fAscending, 
+                          fRow, fMaxIndex, fParallel);
+      else
+         for (Int_t bin = i_key->fCol->GetNumBins() - 1; bin >= 0; bin--)
+            TFSort::SortRows(*i_key->fCol, bin, i_key->fAscending, 
+                             fRow, fMaxIndex, fParallel);
+      }
 }
 //_____________________________________________________________________________
 void TFRowIter::ClearFilterSort()
@@ -132,6 +238,7 @@ void TFRowIter::ClearFilterSort()
    fRow = new UInt_t [fMaxIndex];
 
    fNextIndex = 0;
+   fAllRows   = kTRUE;
 
    for (UInt_t row = 0; row < fMaxIndex; row++)
       fRow[row] = row;
@@ -168,23 +275,45 @@ Bool_t TFRowIter::Filter(const char * filter)
 // the operator ->().
 //
 // filter is a c - expression without ; at the end. Column names of the
-// table can be used as variable names in this filter string. They have the
-// same data type as their column. If the column has more than one 
-// value per row the first value is used in this filter. Of course, the 
-// column names must fulfill the requirement for c - variable names.
+// table can be used as variable names in this filter string. If the 
+// column has more than one value per row the first value is used in this
+// filter, other values can be selected with the bin number in brackets:
+// "colName[3]". Of course, the column names must fulfill the requirement 
+// for c - variable names. String columns can be compared with string 
+// constants or with other string columns.
 // Beside that "row" can be used to define the row number ( 0 based ). 
 // row is the row number of the original table without sorting and without
 // filter. The variable "row_" is the row number (0 based) of the sorted 
 // and already filtered row number before the call of this function.
 //
-// For each row in the table the column variables in the filter string are 
-// assigned to the value of the columns at the given row and "row" and "row_" 
-// in the filter string are set to the row number ( 0 based ). Than the filter 
-// statement is processed with the ROOT interpreter. If the result is  kTRUE
-// the given row will be returned from the operator * () and the 
-// operator -> (). If the result is kFALSE the given row will not be returned.
+// The filter string is compiled by TFFilter, it is not processed by the
+// ROOT interpreter. Supported are the c - operators 
+//    ||  &&  |  ^  &  ==  !=  <  <=  >  >=  +  -  *  /  %  !  ~
+// and the mathematical functions abs, sqrt, exp, log, log10, sin, cos, 
+// tan, asin, acos, atan, floor, ceil, pow, atan2, fmod, min and max. They
+// can also be written as TMath functions like TMath::Sqrt().
+// Only the columns used in the filter string are read from the file.
+// If the result of the filter is not 0 for a given row, this row will be
+// returned from the operator * () and the operator -> (). 
 // A second call of Filter() will not reset the previous filter but will
 // apply the new filter on the already filtered rows.
+//
+// The first filter of an iterator uses the index of a column ( see
+// TFTable::BuildIndex() ) or the order of an already sorted column, like 
+// the TIME column of event files: the rows of comparisons of such a 
+// column or of "row" with a constant, for example "TIME >= 1.5e8 && 
+// TIME < 1.6e8", are found by a binary search and only these rows are
+// evaluated. The bitmap index of flag columns ( see 
+// TFTable::BuildBitmapIndex() ) is used in the same way, for example 
+// "STATUS == 0 && (GRADE == 0 || GRADE == 2)" combines the bitmaps of the 
+// rows of these values without a scan of the table. Filters with "row_"
+// do not use an index.
+//
+// If the implicit multi-threading of ROOT is enabled ( see 
+// ROOT::EnableImplicitMT() ) large tables are filtered in parallel by
+// the threads of the ROOT thread pool. The order of the rows is not 
+// changed by the parallel processing. Use SetParallel(kFALSE) to filter
+// the rows of this iterator always in the calling thread.
 // 
 // The function returns kFALSE if the filter cannot be processed. This means
 // either there is a syntax error in the filter string or a used column name
@@ -197,93 +326,180 @@ Bool_t TFRowIter::Filter(const char * filter)
 //    "row_ < 40 || c2 <= c1"
 //    
 
-   using namespace std;
-
-   char  hstr[150];
-   int   cnt = 0;
-   int   err ;
-   list<string> assignment;
+   TFFilter flt(fTable);
+   if (!flt.Compile(filter))
+      return kFALSE;
 
+   // the rows found with the indexes of columns or with the row number
+   // replace all rows of the table, only these rows are evaluated
+   TFBitmap found;
+   if (fAllRows && flt.FindRows(found))
+      fMaxIndex = found.GetRows(fRow);
+   fAllRows = kFALSE;
 
-   g_flt.Reset();
-   g_flt.SetNumRows(fMaxIndex);
-   g_flt.SetRows(fRow);
+   UInt_t numChunks = fParallel ? TFParallel::GetNumChunks(fMaxIndex) : 1;
+   if (numChunks <= 1)
+      {
+      // remove the rows in fRow which we don't want any more
+      fMaxIndex = flt.Select(fRow, fMaxIndex);
+      return kTRUE;
+      }
 
-   //write the macro into a file: /tmp/tf'pid'_'counter'.C
-   char fileName[30];
-   char functionName[30];
-   static int counter = 0;
-   sprintf(functionName, "tf%d_%d", getpid(), ++counter);
-   sprintf(fileName, "/tmp/%s.C", functionName);
+   // every chunk of fRow is filtered by its own thread. The selected rows
+   // are at the beginning of each chunk
+   std::vector<UInt_t> numSelected(numChunks);
+   TFParallel::Foreach(fMaxIndex, numChunks, 
+                       [&](UInt_t chunk, UInt_t begin, UInt_t end)
+                       {numSelected[chunk] = flt.Select(fRow + begin, end - begin, begin);});
 
-   FILE * macroFile  = fopen(fileName, "w");
-   if (macroFile == NULL)
+   // now remove the gaps between the chunks
+   UInt_t to = numSelected[0];
+   for (UInt_t chunk = 1; chunk < numChunks; chunk++)
       {
-      TFError::SetError("TFRowIter::Filter", 
-                        "Cannot open temporary macro file %s", fileName);
+      UInt_t begin = TFParallel::GetChunkBegin(fMaxIndex, numChunks, chunk);
+      memmove(fRow + to, fRow + begin, numSelected[chunk] * sizeof(UInt_t));
+      to += numSelected[chunk];
+      }
+   fMaxIndex = to;
+
+   return kTRUE;
+}
+//_____________________________________________________________________________
+Bool_t TFRowIter::Cone(Double_t ra, Double_t dec, Double_t radius, const char * pos)
+{
+// Selects the rows with a sky position inside the cone around ra, dec 
+// with the radius radius. All values are in degrees. Like Filter() this
+// function does not reset a previous filter but selects the rows of the
+// already filtered rows.
+// pos is the comma separated list of the right ascension and the 
+// declination column. If pos is NULL the columns of the sky index of the 
+// table are used ( see TFTable::BuildSkyIndex() ) or the columns RA and 
+// DEC if the table has no sky index.
+// With a sky index of these columns only the rows in the HEALPix pixels
+// overlapping the cone are tested, without an index all rows are tested,
+// in parallel if the implicit multi-threading of ROOT is enabled. Rows 
+// with a NULL or NaN position are never selected.
+// The function returns kFALSE and writes an error into the error stack 
+// ( see TFError ) if a position column does not exist or if the radius is
+// negative.
+
+   TFSkyRegion region;
+   if (!region.SetCone(ra, dec, radius))
+      return kFALSE;
+
+   return SelectRegion(region, pos);
+}
+//_____________________________________________________________________________
+Bool_t TFRowIter::Box(Double_t raMin, Double_t raMax, Double_t decMin, Double_t decMax,
+                      const char * pos)
+{
+// Selects the rows with a sky position with a right ascension from raMin
+// to raMax and a declination from decMin to decMax. All values are in 
+// degrees. If raMin is greater than raMax the box wraps through right 
+// ascension 0, for example raMin = 350 and raMax = 10 selects a box of 20
+// degrees width. See Cone() for pos and how the rows are selected.
+// The function returns kFALSE and writes an error into the error stack 
+// ( see TFError ) if a position column does not exist or if decMin is
+// greater than decMax.
+
+   TFSkyRegion region;
+   if (!region.SetBox(raMin, raMax, decMin, decMax))
       return kFALSE;
+
+   return SelectRegion(region, pos);
+}
+//_____________________________________________________________________________
+Bool_t TFRowIter::Polygon(UInt_t num, const Double_t * ra, const Double_t * dec,
+                          const char * pos)
+{
+// Selects the rows with a sky position inside the convex polygon with the
+// num vertices ra[i], dec[i], in degrees. The edges of the polygon are 
+// great circle arcs, the vertices can be in clockwise or counterclockwise
+// order. See Cone() for pos and how the rows are selected.
+// The function returns kFALSE and writes an error into the error stack 
+// ( see TFError ) if a position column does not exist or if the polygon
+// has less than 3 vertices or is not convex.
+
+   TFSkyRegion region;
+   if (!region.SetPolygon(num, ra, dec))
+      return kFALSE;
+
+   return SelectRegion(region, pos);
+}
+//_____________________________________________________________________________
+Bool_t TFRowIter::SelectRegion(const TFSkyRegion & region, const char * pos)
+{
+// removes all rows from fRow with a position outside region
+
+   const TFSkyIndex * index = fTable->GetSkyIndex();
+
+   TString posCols = "RA,DEC";
+   if (pos)
+      posCols = pos;
+   else if (index)
+      {
+      posCols  = index->GetRaName();
+      posCols += ",";
+      posCols += index->GetDecName();
       }
 
-   fprintf(macroFile, "void %s() {\n", functionName);
+   const TFBaseCol * ra;
+   const TFBaseCol * dec;
+   if (!TFSkyIndex::GetPosCols(*fTable, posCols.Data(), "TFRowIter::SelectRegion", ra, dec))
+      return kFALSE;
 
-   TFColIter iter = fTable->MakeColIterator();
-   while ( iter.Next() )
+   if (index && index->HasColumns(ra, dec))
       {
-      if (strstr(filter, iter->GetName()))
+      std::vector<UInt_t> found;
+      index->Find(region, found);
+      if (fAllRows)
          {
-         // this column is in the filter
-         g_flt.AddCol(&*iter);
-         
-         // this line is something like
-         //  Int_t colName1; TFIntCol * __colName1__ = (TFIntCol*)g_flt(0);
-         fprintf(macroFile, "%s %s; %s *__%s__ = (%s*)g_flt(%d);\n",
-                 iter->GetTypeName(), iter->GetName(),
-                 iter->GetColTypeName(), iter->GetName(),
-                 iter->GetColTypeName(), cnt);
-
-         // this line is something like 
-         // colName1 = (*__colName1__)[row];
-         sprintf(hstr, "%s = (*__%s__)[row];",
-                 iter->GetName(), iter->GetName());
-         assignment.push_back(string(hstr));
-         cnt++;
+         if (!found.empty())
+            memcpy(fRow, found.data(), found.size() * sizeof(UInt_t));
+         fMaxIndex = found.size();
          }
+      else
+         {
+         // keep the order of the already sorted rows
+         UInt_t to = 0;
+         for (UInt_t num = 0; num < fMaxIndex; num++)
+            if (std::binary_search(found.begin(), found.end(), fRow[num]))
+               fRow[to++] = fRow[num];
+         fMaxIndex = to;
+         }
+      fAllRows = kFALSE;
+      return kTRUE;
       }
-   
-   // set the row variable
-   fprintf(macroFile, "UInt_t row_ = g_flt.GetNumRows(); UInt_t row;\n");
-
-   // the loop over all rows
-   fprintf(macroFile, "while(row_){row_--;row=g_flt.Map(row_);\n");
-   for (list<string>::iterator i_str = assignment.begin();
-        i_str != assignment.end(); i_str++)
-      fprintf(macroFile, "%s\n", i_str->c_str());
-
-
-   // finish the loop and the macro
-   fprintf(macroFile, "g_flt[row_]=%s;}}\n", filter);
- 
-   fclose(macroFile);
-
-   // now process the macro and delete the temporary file
-   gROOT->ProcessLine(Form(".x %s", fileName), &err);
-//   gROOT->Macro(fileName, &err);
-   unlink(fileName);
-  
-   // was there an error ?
-   if (err)
+   fAllRows = kFALSE;
+
+   // without an index every chunk of fRow is tested by its own thread. The 
+   // selected rows are at the beginning of each chunk
+   UInt_t numChunks = fParallel ? TFParallel::GetNumChunks(fMaxIndex) : 1;
+   std::vector<UInt_t> numSelected(numChunks);
+   TFParallel::Foreach(fMaxIndex, numChunks, 
+         [&](UInt_t chunk, UInt_t begin, UInt_t end)
+         {
+            Bool_t hasNull = ra->HasNull() || dec->HasNull();
+            UInt_t to = begin;
+            for (UInt_t num = begin; num < end; num++)
+               {
+               UInt_t row = fRow[num];
+               if (hasNull && (ra->IsNull(row) || dec->IsNull(row)))
+                  continue;
+               if (region.Contains((*ra)[row], (*dec)[row]))
+                  fRow[to++] = row;
+               }
+            numSelected[chunk] = to - begin;
+         });
+
+   // now remove the gaps between the chunks
+   UInt_t to = numSelected[0];
+   for (UInt_t chunk = 1; chunk < numChunks; chunk++)
       {
-      TFError::SetError("TFRowIter::Filter", 
-               "Interpreter error while processing this filter: %s", filter);
-      return kFALSE;
+      UInt_t begin = TFParallel::GetChunkBegin(fMaxIndex, numChunks, chunk);
+      memmove(fRow + to, fRow + begin, numSelected[chunk] * sizeof(UInt_t));
+      to += numSelected[chunk];
       }
-
-   // everything was OK remove the rows in fRow which we don't want
-   // any more
-   UInt_t from, to = 0;
-   for (from = 0; from < fMaxIndex; from++)
-      if (g_flt[from])
-         fRow[to++] = fRow[from];
    fMaxIndex = to;
 
    return kTRUE;
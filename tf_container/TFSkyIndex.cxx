@@ -0,0 +1,582 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFSkyIndex.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "healpix_base.h"
+#include "pointing.h"
+#include "rangeset.h"
+
+#include "TFSkyIndex.h"
+#include "TFTable.h"
+#include "TFColumn.h"
+#include "TFParallel.h"
+#include "TFError.h"
+
+#include "TObjArray.h"
+#include "TObjString.h"
+
+//_____________________________________________________________________________
+// TFSkyRegion:
+//    Internal class, used by TFRowIter::Cone(), TFRowIter::Box() and
+//    TFRowIter::Polygon(). Should not be used directly by an application.
+//    A region of the sky: a cone, a box in right ascension and declination
+//    or a convex polygon with great circles as edges. Besides the exact
+//    test of a position the region has a bounding circle, which is used
+//    to find the HEALPix pixels of the region.
+//
+// TFSkyIndex:
+//    Internal class, used by TFTable::BuildSkyIndex() and the region
+//    selections of TFRowIter. Should not be used directly by an application.
+//    The rows of a table are sorted by the HEALPix pixel ( NESTED scheme,
+//    order kOrder ) of their position. The pixels overlapping the bounding
+//    circle of a region are a few ranges of pixel numbers, in every lower
+//    order as well. Each range is one contiguous part of the sorted rows,
+//    found with a binary search. Only the rows of these parts are tested,
+//    the time of a query is proportional to the number of found rows.
+
+static const UInt_t   kNoPixel   = 0xffffffff;   // pixel of an invalid position
+static const UInt_t   kBlockRows = 4096;         // rows converted to double at once
+static const Double_t kMargin    = 1e-9;         // margin of a bounding circle in radian
+
+//_____________________________________________________________________________
+static inline void ToVector(Double_t ra, Double_t dec, Double_t * vec)
+{
+// unit vector of the position ra, dec in degrees
+
+   Double_t cDec = cos(dec * M_PI / 180);
+   vec[0] = cDec * cos(ra * M_PI / 180);
+   vec[1] = cDec * sin(ra * M_PI / 180);
+   vec[2] = sin(dec * M_PI / 180);
+}
+
+//_____________________________________________________________________________
+static inline Double_t Dot(const Double_t * v1, const Double_t * v2)
+{
+   return v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+}
+
+//_____________________________________________________________________________
+static inline Double_t Angle(const Double_t * v1, const Double_t * v2)
+{
+// angle between two unit vectors in radian
+
+   return acos(std::max(-1., std::min(1., Dot(v1, v2))));
+}
+
+//_____________________________________________________________________________
+static inline Bool_t IsValidPos(const TFBaseCol * ra, const TFBaseCol * dec,
+                                UInt_t row, Double_t raVal, Double_t decVal)
+{
+// a position with a NULL, NaN or infinite value or with a declination
+// outside -90 to 90 degrees is not in any region
+
+   return std::isfinite(raVal) && std::isfinite(decVal) && fabs(decVal) <= 90 &&
+          !(ra->HasNull() && ra->IsNull(row)) && !(dec->HasNull() && dec->IsNull(row));
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyRegion::SetCone(Double_t ra, Double_t dec, Double_t radius)
+{
+// The cone around ra, dec with the radius radius, all in degrees.
+
+   if (!(radius >= 0) || std::isnan(ra) || std::isnan(dec))
+      {
+      TFError::SetError("TFRowIter::Cone",
+                        "Invalid cone at %g, %g with radius %g.", ra, dec, radius);
+      return kFALSE;
+      }
+
+   Double_t radRadius = std::min(radius, 180.) * M_PI / 180;
+   fType     = kCone;
+   fRadius   = radRadius + kMargin;
+   fMaxDist2 = 4 * sin(radRadius / 2) * sin(radRadius / 2);
+   ToVector(ra, dec, fCenter);
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyRegion::SetBox(Double_t raMin, Double_t raMax, Double_t decMin, Double_t decMax)
+{
+// The box from raMin to raMax and from decMin to decMax in degrees. The
+// box wraps through right ascension 0 if raMin is greater than raMax.
+
+   if (std::isnan(raMin) || std::isnan(raMax) || !(decMin <= decMax))
+      {
+      TFError::SetError("TFRowIter::Box",
+                        "Invalid box from %g, %g to %g, %g.", raMin, decMin, raMax, decMax);
+      return kFALSE;
+      }
+
+   fType    = kBox;
+   fDecMin  = std::max(decMin, -90.);
+   fDecMax  = std::min(decMax, 90.);
+   fRaMin   = fmod(raMin, 360.);
+   if (fRaMin < 0)
+      fRaMin += 360;
+   if (raMax - raMin >= 360)
+      fRaWidth = 360;
+   else
+      {
+      fRaWidth = fmod(raMax - raMin, 360.);
+      if (fRaWidth < 0)
+         fRaWidth += 360;
+      }
+
+   if (fRaWidth <= 180)
+      {
+      // the farthest point of the box from its center is one of the corners
+      ToVector(fRaMin + fRaWidth / 2, (fDecMin + fDecMax) / 2, fCenter);
+      fRadius = 0;
+      for (Int_t corner = 0; corner < 4; corner++)
+         {
+         Double_t vec[3];
+         ToVector(fRaMin + (corner & 1 ? fRaWidth : 0),
+                  corner & 2 ? fDecMax : fDecMin, vec);
+         fRadius = std::max(fRadius, Angle(fCenter, vec));
+         }
+      }
+   else
+      {
+      // a wide box is bounded by a circle around one pole
+      fCenter[0] = fCenter[1] = 0;
+      fCenter[2] = fDecMin >= 0 ? 1 : -1;
+      fRadius    = fDecMin >= 0 ? (90 - fDecMin) * M_PI / 180 :
+                   fDecMax <= 0 ? (90 + fDecMax) * M_PI / 180 : M_PI;
+      }
+   fRadius += kMargin;
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyRegion::SetPolygon(UInt_t num, const Double_t * ra, const Double_t * dec)
+{
+// The convex polygon with the num vertices ra[i], dec[i] in degrees. The
+// edges are the shorter great circle arcs between two consecutive
+// vertices and between the last and the first vertex. The vertices can
+// be in clockwise or counterclockwise order.
+
+   std::vector<Double_t> vertices(3 * (size_t)num);
+   fCenter[0] = fCenter[1] = fCenter[2] = 0;
+   for (UInt_t vert = 0; vert < num; vert++)
+      {
+      ToVector(ra[vert], dec[vert], &vertices[3 * vert]);
+      for (Int_t axis = 0; axis < 3; axis++)
+         fCenter[axis] += vertices[3 * vert + axis];
+      }
+
+   Double_t norm = sqrt(Dot(fCenter, fCenter));
+   if (num < 3 || !(norm > 0))
+      {
+      TFError::SetError("TFRowIter::Polygon", "Invalid polygon with %u vertices.", num);
+      return kFALSE;
+      }
+   for (Int_t axis = 0; axis < 3; axis++)
+      fCenter[axis] /= norm;
+
+   // the normal vectors of the edges point into the polygon
+   fType = kPolygon;
+   fNormals.resize(3 * (size_t)num);
+   Double_t sign = 0;
+   for (UInt_t edge = 0; edge < num; edge++)
+      {
+      const Double_t * v1 = &vertices[3 * edge];
+      const Double_t * v2 = &vertices[3 * ((edge + 1) % num)];
+      Double_t       * n  = &fNormals[3 * edge];
+      n[0] = v1[1] * v2[2] - v1[2] * v2[1];
+      n[1] = v1[2] * v2[0] - v1[0] * v2[2];
+      n[2] = v1[0] * v2[1] - v1[1] * v2[0];
+      norm = sqrt(Dot(n, n));
+      if (edge == 0)
+         sign = Dot(n, fCenter) < 0 ? -1 : 1;
+      for (Int_t axis = 0; axis < 3; axis++)
+         n[axis] = norm > 0 ? sign * n[axis] / norm : 0;
+
+      Bool_t convex = Dot(n, fCenter) > 0;
+      for (UInt_t vert = 0; vert < num && convex; vert++)
+         convex = Dot(n, &vertices[3 * vert]) > -1e-12;
+      if (!convex)
+         {
+         TFError::SetError("TFRowIter::Polygon",
+                           "The polygon with %u vertices is not convex.", num);
+         return kFALSE;
+         }
+      }
+
+   // the farthest point of the polygon from its center is on an edge,
+   // either a vertex or the point of the great circle opposite the center
+   fRadius = 0;
+   for (UInt_t edge = 0; edge < num; edge++)
+      {
+      const Double_t * v1 = &vertices[3 * edge];
+      const Double_t * v2 = &vertices[3 * ((edge + 1) % num)];
+      fRadius = std::max(fRadius, Angle(fCenter, v1));
+
+      Double_t cosLen = Dot(v1, v2);
+      Double_t w[3];
+      for (Int_t axis = 0; axis < 3; axis++)
+         w[axis] = v2[axis] - cosLen * v1[axis];
+      norm = sqrt(Dot(w, w));
+      if (!(norm > 0))
+         continue;
+      for (Int_t axis = 0; axis < 3; axis++)
+         w[axis] /= norm;
+
+      Double_t cu  = Dot(fCenter, v1);
+      Double_t cw  = Dot(fCenter, w);
+      Double_t far = atan2(cw, cu) + M_PI;
+      if (far > 2 * M_PI)
+         far -= 2 * M_PI;
+      if (far <= acos(std::max(-1., std::min(1., cosLen))))
+         fRadius = std::max(fRadius, acos(std::max(-1., -sqrt(cu * cu + cw * cw))));
+      }
+   fRadius += kMargin;
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyRegion::Contains(Double_t ra, Double_t dec) const
+{
+// Returns kTRUE if the position ra, dec in degrees is inside the region.
+
+   if (fType == kBox)
+      {
+      if (!(dec >= fDecMin && dec <= fDecMax))
+         return kFALSE;
+      Double_t dRa = fmod(ra - fRaMin, 360.);
+      if (dRa < 0)
+         dRa += 360;
+      return dRa <= fRaWidth;
+      }
+
+   Double_t vec[3];
+   ToVector(ra, dec, vec);
+
+   if (fType == kCone)
+      {
+      Double_t dist2 = (vec[0] - fCenter[0]) * (vec[0] - fCenter[0]) +
+                       (vec[1] - fCenter[1]) * (vec[1] - fCenter[1]) +
+                       (vec[2] - fCenter[2]) * (vec[2] - fCenter[2]);
+      return dist2 <= fMaxDist2;
+      }
+
+   for (size_t edge = 0; edge < fNormals.size(); edge += 3)
+      if (!(Dot(&fNormals[edge], vec) >= 0))
+         return kFALSE;
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyIndex::GetPosCols(const TFTable & table, const char * pos, const char * location,
+                              const TFBaseCol * & ra, const TFBaseCol * & dec)
+{
+// Finds the right ascension and declination columns of pos, a comma
+// separated list of two column names of table. Returns kFALSE and writes
+// an error with location as name of the function into the error stack if
+// a column does not exist or cannot be a position column.
+
+   std::vector<TString> names;
+   TString     list(pos ? pos : "");
+   TObjArray * tokens = list.Tokenize(",");
+   for (Int_t num = 0; num < tokens->GetEntriesFast(); num++)
+      names.push_back(((TObjString*)tokens->At(num))->GetString().Strip(TString::kBoth));
+   delete tokens;
+
+   if (names.size() != 2)
+      {
+      TFError::SetError(location, "%s are not the two position columns of table %s.",
+                        pos ? pos : "", table.GetName());
+      return kFALSE;
+      }
+
+   const TFBaseCol * cols[2];
+   for (Int_t num = 0; num < 2; num++)
+      {
+      cols[num] = &table.GetColumn(names[num].Data());
+      if (cols[num] == NULL)
+         return kFALSE;
+      if (!cols[num]->IsNumeric() || cols[num]->GetNumBins() != 1)
+         {
+         TFError::SetError(location, "Column %s of table %s cannot be a position column.",
+                           names[num].Data(), table.GetName());
+         return kFALSE;
+         }
+      }
+
+   ra  = cols[0];
+   dec = cols[1];
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyIndex::Build(const TFTable & table, const char * pos, Bool_t parallel)
+{
+// Builds the index of the positions of the columns pos of table. Rows
+// with a NULL or NaN position are not in the index.
+
+   const TFBaseCol * ra;
+   const TFBaseCol * dec;
+   if (!GetPosCols(table, pos, "TFTable::BuildSkyIndex", ra, dec))
+      return kFALSE;
+
+   UInt_t        numRows = table.GetNumRows();
+   Healpix_Base2 healpix(kOrder, NEST);
+
+   // every chunk computes and sorts the pixels of its rows. The key of a
+   // row is its pixel in the upper and its row in the lower 32 bits
+   std::vector<ULong64_t> keys(numRows);
+   UInt_t numChunks = parallel ? TFParallel::GetNumChunks(numRows) : 1;
+   TFParallel::Foreach(numRows, numChunks,
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {
+            std::vector<Double_t> raBuf(kBlockRows), decBuf(kBlockRows);
+            for (UInt_t first = begin; first < end; first += kBlockRows)
+               {
+               UInt_t last = std::min(end, first + kBlockRows);
+               ra->ToDoubles(first, last, raBuf.data());
+               dec->ToDoubles(first, last, decBuf.data());
+               for (UInt_t row = first; row < last; row++)
+                  {
+                  Double_t raPos  = raBuf[row - first];
+                  Double_t decPos = decBuf[row - first];
+                  ULong64_t pixel = kNoPixel;
+                  if (IsValidPos(ra, dec, row, raPos, decPos))
+                     pixel = healpix.ang2pix(pointing((90 - decPos) * M_PI / 180,
+                                                      raPos * M_PI / 180));
+                  keys[row] = (pixel << 32) | row;
+                  }
+               }
+            std::sort(keys.begin() + begin, keys.begin() + end);
+         });
+
+   // the sorted chunks are merged pairwise, all pairs in parallel
+   std::vector<UInt_t> bounds(numChunks + 1, numRows);
+   for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+      bounds[chunk] = TFParallel::GetChunkBegin(numRows, numChunks, chunk);
+   std::vector<ULong64_t> buffer(numChunks > 1 ? numRows : 0);
+   for (UInt_t width = 1; width < numChunks; width *= 2)
+      {
+      UInt_t numMerges = (numChunks + 2 * width - 1) / (2 * width);
+      TFParallel::Foreach(numMerges, numMerges,
+            [&](UInt_t merge, UInt_t, UInt_t)
+            {
+               UInt_t first = bounds[merge * 2 * width];
+               UInt_t mid   = bounds[std::min(numChunks, merge * 2 * width + width)];
+               UInt_t last  = bounds[std::min(numChunks, (merge + 1) * 2 * width)];
+               std::merge(keys.begin() + first, keys.begin() + mid,
+                          keys.begin() + mid, keys.begin() + last, buffer.begin() + first);
+            });
+      keys.swap(buffer);
+      }
+
+   // the invalid positions are at the end
+   UInt_t numValid = std::lower_bound(keys.begin(), keys.end(),
+                                      (ULong64_t)kNoPixel << 32) - keys.begin();
+   fPixels.resize(numValid);
+   fRows.resize(numValid);
+   for (UInt_t num = 0; num < numValid; num++)
+      {
+      fPixels[num] = (UInt_t)(keys[num] >> 32);
+      fRows[num]   = (UInt_t)keys[num];
+      }
+
+   fRaName      = ra->GetName();
+   fDecName     = dec->GetName();
+   fRa          = ra;
+   fDec         = dec;
+   fRaModCount  = ra->GetModCount();
+   fDecModCount = dec->GetModCount();
+   fRaSerial    = ra->GetSerial();
+   fDecSerial   = dec->GetSerial();
+   fNumRows     = numRows;
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyIndex::IsValid(const TFTable & table) const
+{
+// Returns kTRUE if the index is up to date: the table has still the same
+// number of rows and the same position columns, which were not modified
+// since the index was built. A column is identified by its serial number,
+// a new column may have the address of a deleted column.
+
+   if (fRa == NULL || fNumRows != table.GetNumRows())
+      return kFALSE;
+
+   TFErrorType errT = TFError::GetErrorType();
+   TFError::SetErrorType(kNoErr);
+   const TFBaseCol * ra  = &table.GetColumn(fRaName.Data());
+   const TFBaseCol * dec = &table.GetColumn(fDecName.Data());
+   TFError::SetErrorType(errT);
+
+   return ra == fRa && dec == fDec &&
+          ra->GetSerial() == fRaSerial && dec->GetSerial() == fDecSerial &&
+          ra->GetModCount() == fRaModCount && dec->GetModCount() == fDecModCount;
+}
+
+//_____________________________________________________________________________
+void TFSkyIndex::Find(const TFSkyRegion & region, std::vector<UInt_t> & rows) const
+{
+// Sets rows to all rows with a position inside region, in ascending order.
+
+   rows.clear();
+
+   // the parts of the sorted rows in the pixels of the bounding circle
+   std::vector<std::pair<UInt_t, UInt_t> > parts;
+   if (region.GetRadius() >= M_PI)
+      parts.push_back(std::make_pair(0u, (UInt_t)fPixels.size()));
+   else
+      {
+      Int_t order = 0;
+      while (order < kOrder && Healpix_Base2(order + 1, NEST).max_pixrad() >= region.GetRadius())
+         order++;
+      Healpix_Base2 healpix(order, NEST);
+
+      const Double_t * center = region.GetCenter();
+      rangeset<int64> ranges;
+      healpix.query_disc_inclusive(pointing(acos(std::max(-1., std::min(1., center[2]))),
+                                            atan2(center[1], center[0])),
+                                   region.GetRadius(), ranges);
+
+      // a pixel of order contains 4^(kOrder - order) pixels of the index
+      Int_t shift = 2 * (kOrder - order);
+      for (size_t range = 0; range < ranges.nranges(); range++)
+         {
+         UInt_t begin = std::lower_bound(fPixels.begin(), fPixels.end(),
+                                         (UInt_t)(ranges.ivbegin(range) << shift)) - fPixels.begin();
+         UInt_t end   = std::lower_bound(fPixels.begin() + begin, fPixels.end(),
+                                         (UInt_t)(ranges.ivend(range) << shift)) - fPixels.begin();
+         if (begin < end)
+            parts.push_back(std::make_pair(begin, end));
+         }
+      }
+
+   for (size_t part = 0; part < parts.size(); part++)
+      for (UInt_t num = parts[part].first; num < parts[part].second; num++)
+         {
+         UInt_t row = fRows[num];
+         if (region.Contains((*fRa)[row], (*fDec)[row]))
+            rows.push_back(row);
+         }
+
+   std::sort(rows.begin(), rows.end());
+}
+
+//_____________________________________________________________________________
+TFTable * TFSkyIndex::MakeTable(const char * name) const
+{
+// Returns a new table with the index. It has the columns PIXEL and ROW and
+// the names of the position columns, the HEALPix order and the number of
+// rows of the indexed table as attributes.
+
+   TFTable   * table = new TFTable(name, fPixels.size());
+   TFUIntCol * pixel = new TFUIntCol("PIXEL", fPixels.size());
+   TFUIntCol * row   = new TFUIntCol("ROW", fRows.size());
+   if (!fPixels.empty())
+      {
+      memcpy(pixel->GetDataArray(), fPixels.data(), fPixels.size() * sizeof(UInt_t));
+      memcpy(row->GetDataArray(), fRows.data(), fRows.size() * sizeof(UInt_t));
+      }
+   table->AddColumn(pixel);
+   table->AddColumn(row);
+
+   table->AddAttribute(TFStringAttr("RA_COL", fRaName, "", "right ascension column"));
+   table->AddAttribute(TFStringAttr("DEC_COL", fDecName, "", "declination column"));
+   table->AddAttribute(TFIntAttr("HPX_ORDER", kOrder, "", "HEALPix order, NESTED scheme"));
+   table->AddAttribute(TFUIntAttr("NUM_ROWS", fNumRows, "", "number of rows of the table"));
+   return table;
+}
+
+//_____________________________________________________________________________
+static Bool_t GetAttr(const TFTable & index, const char * key, TString & value)
+{
+// the value of the attribute key of index as string
+
+   if (index.GetNumAttributes(key) == 0)
+      return kFALSE;
+
+   TFBaseAttr & attr = index.GetAttribute(key);
+   TFStringAttr * strAttr = dynamic_cast<TFStringAttr *>(&attr);
+   if (strAttr)
+      value = strAttr->GetValue();
+   else
+      {
+      char str[64];
+      value = attr.GetStringValue(str);
+      }
+   value = value.Strip(TString::kBoth);
+   return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t TFSkyIndex::SetTable(const TFTable & index, const TFTable & table)
+{
+// Sets this index to the index of table stored in index, a table created
+// by MakeTable(). Returns kFALSE and writes an error into the error stack
+// if index does not fit to table.
+
+   TString raName, decName, order, numRows;
+   if (!GetAttr(index, "RA_COL", raName)   || !GetAttr(index, "DEC_COL", decName) ||
+       !GetAttr(index, "HPX_ORDER", order) || !GetAttr(index, "NUM_ROWS", numRows) ||
+       atoi(order.Data()) != kOrder || strtoul(numRows.Data(), NULL, 10) != table.GetNumRows())
+      {
+      TFError::SetError("TFTable::ReadSkyIndex",
+                        "The sky index %s does not fit to table %s.",
+                        index.GetName(), table.GetName());
+      return kFALSE;
+      }
+
+   TString pos = raName;
+   pos += ",";
+   pos += decName;
+   const TFBaseCol * ra;
+   const TFBaseCol * dec;
+   if (!GetPosCols(table, pos.Data(), "TFTable::ReadSkyIndex", ra, dec))
+      return kFALSE;
+
+   TFErrorType errT = TFError::GetErrorType();
+   TFError::SetErrorType(kNoErr);
+   const TFUIntCol * pixel = dynamic_cast<const TFUIntCol *>(&index.GetColumn("PIXEL"));
+   const TFUIntCol * row   = dynamic_cast<const TFUIntCol *>(&index.GetColumn("ROW"));
+   TFError::SetErrorType(errT);
+
+   Bool_t valid = pixel != NULL && row != NULL;
+   for (UInt_t num = 0; valid && num < index.GetNumRows(); num++)
+      valid = (*row)[num] < table.GetNumRows() &&
+              (num == 0 || (*pixel)[num - 1] <= (*pixel)[num]);
+   if (!valid)
+      {
+      TFError::SetError("TFTable::ReadSkyIndex", "The sky index %s is corrupted.",
+                        index.GetName());
+      return kFALSE;
+      }
+
+   fPixels.resize(index.GetNumRows());
+   fRows.resize(index.GetNumRows());
+   for (UInt_t num = 0; num < index.GetNumRows(); num++)
+      {
+      fPixels[num] = (*pixel)[num];
+      fRows[num]   = (*row)[num];
+      }
+
+   fRaName      = ra->GetName();
+   fDecName     = dec->GetName();
+   fRa          = ra;
+   fDec         = dec;
+   fRaModCount  = ra->GetModCount();
+   fDecModCount = dec->GetModCount();
+   fRaSerial    = ra->GetSerial();
+   fDecSerial   = dec->GetSerial();
+   fNumRows     = table.GetNumRows();
+   return kTRUE;
+}
@@ -0,0 +1,96 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFSkyIndex.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFSkyIndex
+#define ROOT_TFSkyIndex
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#ifndef ROOT_TString
+#include "TString.h"
+#endif
+
+#include <vector>
+
+
+class TFTable;
+class TFBaseCol;
+
+//_____________________________________________________________________________
+
+class TFSkyRegion
+{
+   Int_t       fType;         // kCone, kBox or kPolygon
+   Double_t    fCenter[3];    // unit vector of the center of the bounding circle
+   Double_t    fRadius;       // radius of the bounding circle in radian
+   Double_t    fMaxDist2;     // square of the chord of the radius of a cone
+   Double_t    fRaMin;        // box: first right ascension in degrees
+   Double_t    fRaWidth;      // box: width of the right ascension range in degrees
+   Double_t    fDecMin;       // box: minimum declination in degrees
+   Double_t    fDecMax;       // box: maximum declination in degrees
+   std::vector<Double_t> fNormals;   // polygon: inner normal vector of each edge
+
+public:
+   enum {kCone, kBox, kPolygon};
+
+   TFSkyRegion() : fType(kCone), fRadius(0), fMaxDist2(0), fRaMin(0), fRaWidth(0),
+                   fDecMin(0), fDecMax(0) {fCenter[0] = fCenter[1] = 0; fCenter[2] = 1;}
+
+   Bool_t      SetCone(Double_t ra, Double_t dec, Double_t radius);
+   Bool_t      SetBox(Double_t raMin, Double_t raMax, Double_t decMin, Double_t decMax);
+   Bool_t      SetPolygon(UInt_t num, const Double_t * ra, const Double_t * dec);
+
+   Bool_t      Contains(Double_t ra, Double_t dec) const;
+   const Double_t * GetCenter() const  {return fCenter;}
+   Double_t    GetRadius() const       {return fRadius;}
+};
+
+//_____________________________________________________________________________
+
+class TFSkyIndex
+{
+public:
+   enum {kOrder = 13};        // HEALPix order of the pixels of the index
+
+private:
+   TString              fRaName;       // name of the right ascension column
+   TString              fDecName;      // name of the declination column
+   const TFBaseCol    * fRa;           // the right ascension column
+   const TFBaseCol    * fDec;          // the declination column
+   ULong64_t            fRaModCount;   // modification count of fRa
+   ULong64_t            fDecModCount;  // modification count of fDec
+   ULong64_t            fRaSerial;     // serial number of fRa
+   ULong64_t            fDecSerial;    // serial number of fDec
+   UInt_t               fNumRows;      // number of rows of the table
+   std::vector<UInt_t>  fPixels;       // NESTED pixel of each entry, ascending
+   std::vector<UInt_t>  fRows;         // row of each entry
+
+public:
+   TFSkyIndex() : fRa(NULL), fDec(NULL), fRaModCount(0), fDecModCount(0),
+                  fRaSerial(0), fDecSerial(0), fNumRows(0) {}
+
+   Bool_t         Build(const TFTable & table, const char * pos, Bool_t parallel = kTRUE);
+   Bool_t         IsValid(const TFTable & table) const;
+   const char *   GetRaName() const        {return fRaName.Data();}
+   const char *   GetDecName() const       {return fDecName.Data();}
+   Bool_t         HasColumns(const TFBaseCol * ra, const TFBaseCol * dec) const
+                                          {return ra == fRa && dec == fDec;}
+
+   void           Find(const TFSkyRegion & region, std::vector<UInt_t> & rows) const;
+
+   TFTable *      MakeTable(const char * name) const;
+   Bool_t         SetTable(const TFTable & index, const TFTable & table);
+
+   static Bool_t  GetPosCols(const TFTable & table, const char * pos, const char * location,
+                             const TFBaseCol * & ra, const TFBaseCol * & dec);
+};
+
+#endif
@@ -0,0 +1,296 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFSnapshot.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFSnapshot
+#define ROOT_TFSnapshot
+
+#ifndef ROOT_TFTable
+#include "TFTable.h"
+#endif
+
+#ifndef ROOT_TFColumn
+#include "TFColumn.h"
+#endif
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <ROOT/RVec.hxx>
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RDF/RActionImpl.hxx>
+
+#include "TFParallel.h"
+#include "TFError.h"
+
+
+class TTreeReader;
+
+//_____________________________________________________________________________
+// TFSnapshot:
+//    An action of ROOT::RDataFrame, like Snapshot(), which writes the
+//    values of some columns of the data frame into a new TFTable and saves
+//    this table optionally into an ASRO, ROOT or FITS file:
+//       ROOT::RDataFrame df = ...;
+//       ROOT::RDF::RResultPtr<TFTable> table =
+//          TFSnapshot<Float_t, Short_t>(df.Filter("PI > 30"), "EVENTS",
+//                                       {"X", "PI"}, "events.fits");
+//       table->Print();
+//    The template arguments are the types of the columns in the data frame.
+//    Supported are bool, Char_t, UChar_t, Short_t, UShort_t, Int_t, UInt_t,
+//    Float_t and Double_t, a string as std::string, std::string_view or
+//    TString and ROOT::RVec<T> of the numerical types. A RVec column is
+//    written into a column with a variable number of values per row.
+//
+//    Each slot of the data frame fills its own chunk of rows in memory.
+//    At the end of the event loop the chunks are copied one after the
+//    other into the columns of the table. If the implicit multi-threading
+//    of ROOT is enabled the rows are not in the order of the entries of the
+//    data frame, like in Snapshot().
+//    The table is saved into the file fileName if fileName is not NULL
+//    ( see TFIOElement::SaveElement() ).
+
+//_____________________________________________________________________________
+// the chunks of one numerical column, V is the type in the data frame, T
+// the type in the column C
+
+template <class T, class C, class V = T>
+   class TFSnapshotValues
+{
+   std::vector<std::vector<T> >  fChunks;   // rows filled by each slot
+
+public:
+   void     SetNSlots(UInt_t nSlots)             {fChunks.resize(nSlots);}
+   void     Fill(UInt_t slot, const V & value)   {fChunks[slot].push_back((T)value);}
+   UInt_t   GetNumRows(UInt_t slot) const        {return fChunks[slot].size();}
+
+   TFBaseCol * MakeColumn(const char * name, const std::vector<UInt_t> & first)
+                  {
+                  C * col = new C(name, first.back());
+                  T * data = col->GetDataArray();
+                  TFParallel::Foreach(fChunks.size(), fChunks.size(),
+                     [&](UInt_t slot, UInt_t, UInt_t)
+                        {
+                        std::copy(fChunks[slot].begin(), fChunks[slot].end(),
+                                  data + first[slot]);
+                        std::vector<T>().swap(fChunks[slot]);
+                        });
+                  return col;
+                  }
+};
+
+//_____________________________________________________________________________
+// the chunks of one string column
+
+template <class V>
+   class TFSnapshotStrings
+{
+   std::vector<std::vector<std::string> >  fChunks;   // rows filled by each slot
+
+   static void Append(std::vector<std::string> & chunk, const std::string & str)
+                  {chunk.push_back(str);}
+   static void Append(std::vector<std::string> & chunk, const TString & str)
+                  {chunk.emplace_back(str.Data(), str.Length());}
+   static void Append(std::vector<std::string> & chunk, std::string_view str)
+                  {chunk.emplace_back(str);}
+
+public:
+   void     SetNSlots(UInt_t nSlots)             {fChunks.resize(nSlots);}
+   void     Fill(UInt_t slot, const V & value)   {Append(fChunks[slot], value);}
+   UInt_t   GetNumRows(UInt_t slot) const        {return fChunks[slot].size();}
+
+   TFBaseCol * MakeColumn(const char * name, const std::vector<UInt_t> & first)
+                  {
+                  // all strings of a TFStringCol are in one block of memory
+                  TFStringCol * col = new TFStringCol(name, first.back());
+                  for (UInt_t slot = 0; slot < fChunks.size(); slot++)
+                     {
+                     for (UInt_t row = 0; row < fChunks[slot].size(); row++)
+                        col->SetRow(first[slot] + row, fChunks[slot][row].data(),
+                                    fChunks[slot][row].size());
+                     std::vector<std::string>().swap(fChunks[slot]);
+                     }
+                  return col;
+                  }
+};
+
+//_____________________________________________________________________________
+// the chunks of one RVec column, written into a column with a variable
+// number of values per row
+
+template <class T, class C>
+   class TFSnapshotArrays
+{
+   std::vector<std::vector<T> >         fChunks;   // values of the rows filled by each slot
+   std::vector<std::vector<Long64_t> >  fSizes;    // number of values of these rows
+
+public:
+   void     SetNSlots(UInt_t nSlots)    {fChunks.resize(nSlots); fSizes.resize(nSlots);}
+   void     Fill(UInt_t slot, const ROOT::RVec<T> & value)
+                  {
+                  fChunks[slot].insert(fChunks[slot].end(), value.begin(), value.end());
+                  fSizes[slot].push_back(value.size());
+                  }
+   UInt_t   GetNumRows(UInt_t slot) const        {return fSizes[slot].size();}
+
+   TFBaseCol * MakeColumn(const char * name, const std::vector<UInt_t> & first)
+                  {
+                  C * col = new C(name, first.back());
+                  std::vector<Long64_t> sizes;
+                  sizes.reserve(first.back());
+                  for (UInt_t slot = 0; slot < fSizes.size(); slot++)
+                     sizes.insert(sizes.end(), fSizes[slot].begin(), fSizes[slot].end());
+                  col->SetRowSizes(sizes.empty() ? NULL : &sizes[0]);
+
+                  T * data = col->GetDataArray();
+                  const ULong64_t * offsets = col->GetOffsets();
+                  TFParallel::Foreach(fChunks.size(), fChunks.size(),
+                     [&](UInt_t slot, UInt_t, UInt_t)
+                        {
+                        std::copy(fChunks[slot].begin(), fChunks[slot].end(),
+                                  data + offsets[first[slot]]);
+                        std::vector<T>().swap(fChunks[slot]);
+                        std::vector<Long64_t>().swap(fSizes[slot]);
+                        });
+                  return col;
+                  }
+};
+
+//_____________________________________________________________________________
+// the column of the table for each type of the data frame
+
+template <class V>
+   class TFSnapshotCol
+{
+   static_assert(sizeof(V) == 0, "TFSnapshot: this column type is not supported");
+};
+
+template <> class TFSnapshotCol<bool>     : public TFSnapshotValues<Char_t, TFBoolCol, bool> {};
+template <> class TFSnapshotCol<Char_t>   : public TFSnapshotValues<Char_t,   TFCharCol>   {};
+template <> class TFSnapshotCol<UChar_t>  : public TFSnapshotValues<UChar_t,  TFUCharCol>  {};
+template <> class TFSnapshotCol<Short_t>  : public TFSnapshotValues<Short_t,  TFShortCol>  {};
+template <> class TFSnapshotCol<UShort_t> : public TFSnapshotValues<UShort_t, TFUShortCol> {};
+template <> class TFSnapshotCol<Int_t>    : public TFSnapshotValues<Int_t,    TFIntCol>    {};
+template <> class TFSnapshotCol<UInt_t>   : public TFSnapshotValues<UInt_t,   TFUIntCol>   {};
+template <> class TFSnapshotCol<Float_t>  : public TFSnapshotValues<Float_t,  TFFloatCol>  {};
+template <> class TFSnapshotCol<Double_t> : public TFSnapshotValues<Double_t, TFDoubleCol> {};
+
+template <> class TFSnapshotCol<std::string>      : public TFSnapshotStrings<std::string>      {};
+template <> class TFSnapshotCol<std::string_view> : public TFSnapshotStrings<std::string_view> {};
+template <> class TFSnapshotCol<TString>          : public TFSnapshotStrings<TString>          {};
+
+template <> class TFSnapshotCol<ROOT::RVec<Char_t> >   : public TFSnapshotArrays<Char_t,   TFCharVarArrCol>   {};
+template <> class TFSnapshotCol<ROOT::RVec<UChar_t> >  : public TFSnapshotArrays<UChar_t,  TFUCharVarArrCol>  {};
+template <> class TFSnapshotCol<ROOT::RVec<Short_t> >  : public TFSnapshotArrays<Short_t,  TFShortVarArrCol>  {};
+template <> class TFSnapshotCol<ROOT::RVec<UShort_t> > : public TFSnapshotArrays<UShort_t, TFUShortVarArrCol> {};
+template <> class TFSnapshotCol<ROOT::RVec<Int_t> >    : public TFSnapshotArrays<Int_t,    TFIntVarArrCol>    {};
+template <> class TFSnapshotCol<ROOT::RVec<UInt_t> >   : public TFSnapshotArrays<UInt_t,   TFUIntVarArrCol>   {};
+template <> class TFSnapshotCol<ROOT::RVec<Float_t> >  : public TFSnapshotArrays<Float_t,  TFFloatVarArrCol>  {};
+template <> class TFSnapshotCol<ROOT::RVec<Double_t> > : public TFSnapshotArrays<Double_t, TFDoubleVarArrCol> {};
+
+//_____________________________________________________________________________
+// the action of the data frame, see TFSnapshot()
+
+template <class... ColTypes>
+   class TFSnapshotHelper : public ROOT::Detail::RDF::RActionImpl<TFSnapshotHelper<ColTypes...> >
+{
+public:
+   typedef TFTable Result_t;
+
+private:
+   std::shared_ptr<TFTable>                 fTable;      // the result
+   std::vector<std::string>                 fColNames;   // names of the columns
+   std::string                              fFileName;   // file of the table, or empty
+   std::tuple<TFSnapshotCol<ColTypes>...>   fCols;       // the chunks of each column
+   UInt_t                                   fNSlots;     // number of slots of the data frame
+
+   template <std::size_t... I>
+   void     FillCols(UInt_t slot, std::index_sequence<I...>, const ColTypes &... values)
+                  {(std::get<I>(fCols).Fill(slot, values), ...);}
+
+   template <std::size_t... I>
+   void     MakeColumns(const std::vector<UInt_t> & first, std::index_sequence<I...>)
+                  {(AddColumn(std::get<I>(fCols).MakeColumn(fColNames[I].c_str(), first)), ...);}
+
+   void     AddColumn(TFBaseCol * col)
+                  {
+                  // a column which the table rejects, for example of a 
+                  // duplicate name, is deleted
+                  try
+                     {
+                     if (fTable->AddColumn(col) == 0)
+                        return;
+                     }
+                  catch (TFException &)
+                     {
+                     delete col;
+                     throw;
+                     }
+                  TString colName = col->GetName();
+                  delete col;
+                  TFError::SetError("TFSnapshot", 
+                                    "Column %s is missing in table %s, the table has "
+                                    "already a column with this name.",
+                                    colName.Data(), fTable->GetName());
+                  }
+
+public:
+   TFSnapshotHelper(const char * name, const std::vector<std::string> & colNames,
+                    UInt_t nSlots, const char * fileName = NULL)
+      : fTable(std::make_shared<TFTable>(name)), fColNames(colNames),
+        fFileName(fileName ? fileName : ""), fNSlots(nSlots > 0 ? nSlots : 1)
+                  {
+                  std::apply([this](auto &... col) {(col.SetNSlots(fNSlots), ...);}, fCols);
+                  }
+   TFSnapshotHelper(TFSnapshotHelper &&) = default;
+   TFSnapshotHelper(const TFSnapshotHelper &) = delete;
+
+   std::shared_ptr<TFTable>   GetResultPtr() const        {return fTable;}
+   void     Initialize()                                  {}
+   void     InitTask(TTreeReader *, unsigned int)         {}
+   void     Exec(unsigned int slot, const ColTypes &... values)
+                  {FillCols(slot, std::index_sequence_for<ColTypes...>(), values...);}
+   std::string GetActionName()                            {return "TFSnapshot";}
+
+   void     Finalize()
+                  {
+                  // first row of the chunk of each slot
+                  std::vector<UInt_t> first(fNSlots + 1, 0);
+                  for (UInt_t slot = 0; slot < fNSlots; slot++)
+                     first[slot + 1] = first[slot] + std::get<0>(fCols).GetNumRows(slot);
+
+                  if (first.back() > 0)
+                     fTable->InsertRows(first.back());
+                  MakeColumns(first, std::index_sequence_for<ColTypes...>());
+
+                  if (!fFileName.empty())
+                     fTable->SaveElement(fFileName.c_str());
+                  }
+};
+
+//_____________________________________________________________________________
+template <class... ColTypes, class D>
+ROOT::RDF::RResultPtr<TFTable> TFSnapshot(D df, const char * name,
+                                          const std::vector<std::string> & colNames,
+                                          const char * fileName = NULL)
+{
+// Books the action TFSnapshotHelper in the data frame df which writes the
+// columns colNames into a new table with the name name. The table is
+// saved into fileName if fileName is not NULL. The table is filled when
+// the result is accessed the first time.
+
+   return df.template Book<ColTypes...>(
+             TFSnapshotHelper<ColTypes...>(name, colNames, df.GetNSlots(), fileName), 
+             colNames);
+}
+
+#endif
@@ -0,0 +1,312 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFSort.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+#include <vector>
+
+#include "TFSort.h"
+#include "TFColumn.h"
+#include "TFParallel.h"
+
+//_____________________________________________________________________________
+// TFSort:
+//    Internal class, used by TFRowIter::Sort(). Should not be used directly
+//    by an application.
+//    SortRows() sorts a list of row numbers depending on the values of one
+//    column. The sort is stable, rows with the same value keep their order,
+//    therefore several calls of SortRows() can be used to sort by several
+//    columns. Columns of integer and floating point numbers and dictionary
+//    encoded string columns are sorted with a radix sort, other string 
+//    columns and all other columns with a merge sort.
+//    Both sort algorithms use the threads of the ROOT thread pool if the
+//    implicit multi-threading of ROOT is enabled.
+
+//_____________________________________________________________________________
+// the sort keys of the radix sort: an unsigned integer with the same
+// order as the column value
+
+template <class T, bool isInt = std::numeric_limits<T>::is_integer>
+   struct TFSortKey;
+
+template <class T>
+   struct TFSortKey<T, true>
+{
+   typedef typename std::make_unsigned<T>::type Key;
+
+   static Key  Get(T val)
+      {return std::numeric_limits<T>::is_signed ?
+              (Key)val ^ ((Key)1 << (sizeof(Key) * 8 - 1)) : (Key)val;}
+};
+
+template <>
+   struct TFSortKey<Float_t, false>
+{
+   typedef UInt_t Key;
+
+   static Key  Get(Float_t val)
+      {Key key; memcpy(&key, &val, sizeof(key));
+       return (key & 0x80000000u) ? ~key : key | 0x80000000u;}
+};
+
+template <>
+   struct TFSortKey<Double_t, false>
+{
+   typedef ULong64_t Key;
+
+   static Key  Get(Double_t val)
+      {Key key; memcpy(&key, &val, sizeof(key));
+       return (key >> 63) ? ~key : key | (1ULL << 63);}
+};
+
+//_____________________________________________________________________________
+template <class K>
+static void RadixSort(K * keys, UInt_t * rows, UInt_t num, UInt_t numChunks)
+{
+// Stable LSD radix sort of keys with 8 bits per pass. rows are moved
+// together with their key. The histograms of every pass are computed
+// and the keys are distributed in parallel. Every chunk of the input
+// has its own part of each bucket, this keeps the sort stable.
+
+   const UInt_t kBuckets = 256;
+
+   std::vector<K>      tmpKeys(num);
+   std::vector<UInt_t> tmpRows(num);
+   std::vector<UInt_t> count(numChunks * kBuckets);
+
+   K      * inKeys  = keys;
+   UInt_t * inRows  = rows;
+   K      * outKeys = &tmpKeys[0];
+   UInt_t * outRows = &tmpRows[0];
+
+   for (UInt_t shift = 0; shift < sizeof(K) * 8; shift += 8)
+      {
+      std::fill(count.begin(), count.end(), 0);
+      TFParallel::Foreach(num, numChunks,
+            [&](UInt_t chunk, UInt_t begin, UInt_t end)
+            {
+               UInt_t * cnt = &count[chunk * kBuckets];
+               for (UInt_t i = begin; i < end; i++)
+                  cnt[(inKeys[i] >> shift) & 0xff]++;
+            });
+
+      // convert the counts into the first output position of each bucket
+      // and chunk. Skip this pass if all keys are in the same bucket
+      Bool_t skip = kFALSE;
+      for (UInt_t bucket = 0; bucket < kBuckets && !skip; bucket++)
+         {
+         UInt_t n = 0;
+         for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+            n += count[chunk * kBuckets + bucket];
+         skip = n == num;
+         }
+      if (skip)
+         continue;
+
+      UInt_t pos = 0;
+      for (UInt_t bucket = 0; bucket < kBuckets; bucket++)
+         for (UInt_t chunk = 0; chunk < numChunks; chunk++)
+            {
+            UInt_t n = count[chunk * kBuckets + bucket];
+            count[chunk * kBuckets + bucket] = pos;
+            pos += n;
+            }
+
+      TFParallel::Foreach(num, numChunks,
+            [&](UInt_t chunk, UInt_t begin, UInt_t end)
+            {
+               UInt_t * cnt = &count[chunk * kBuckets];
+               for (UInt_t i = begin; i < end; i++)
+                  {
+                  UInt_t to = cnt[(inKeys[i] >> shift) & 0xff]++;
+                  outKeys[to] = inKeys[i];
+                  outRows[to] = inRows[i];
+                  }
+            });
+
+      std::swap(inKeys, outKeys);
+      std::swap(inRows, outRows);
+      }
+
+   if (inRows != rows)
+      memcpy(rows, inRows, num * sizeof(UInt_t));
+}
+//_____________________________________________________________________________
+template <class Less>
+static void MergeSort(UInt_t * rows, UInt_t num, UInt_t numChunks, Less less)
+{
+// Stable sort of rows. Every chunk is sorted by its own thread, then the
+// sorted chunks are merged pairwise, again in parallel.
+
+   if (numChunks <= 1)
+      {
+      std::stable_sort(rows, rows + num, less);
+      return;
+      }
+
+   std::vector<UInt_t> bound(numChunks + 1);
+   for (UInt_t chunk = 0; chunk <= numChunks; chunk++)
+      bound[chunk] = TFParallel::GetChunkBegin(num, numChunks, chunk);
+
+   TFParallel::Foreach(num, numChunks,
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {std::stable_sort(rows + begin, rows + end, less);});
+
+   std::vector<UInt_t> tmp(num);
+   UInt_t * in  = rows;
+   UInt_t * out = &tmp[0];
+
+   while (bound.size() > 2)
+      {
+      // merge the sorted ranges 2*n and 2*n+1, an odd last range is copied
+      UInt_t numRanges = bound.size() - 1;
+      UInt_t numPairs  = (numRanges + 1) / 2;
+      TFParallel::Foreach(numPairs, numPairs,
+            [&](UInt_t pair, UInt_t, UInt_t)
+            {
+               UInt_t begin = bound[2 * pair];
+               UInt_t mid   = bound[2 * pair + 1];
+               UInt_t end   = 2 * pair + 2 < bound.size() ? bound[2 * pair + 2] : mid;
+               std::merge(in + begin, in + mid, in + mid, in + end, out + begin, less);
+            });
+
+      std::vector<UInt_t> newBound;
+      for (UInt_t i = 0; i < bound.size(); i += 2)
+         newBound.push_back(bound[i]);
+      if (newBound.back() != num)
+         newBound.push_back(num);
+      bound.swap(newBound);
+
+      std::swap(in, out);
+      }
+
+   if (in != rows)
+      memcpy(rows, in, num * sizeof(UInt_t));
+}
+//_____________________________________________________________________________
+template <class T, class Get>
+static void RadixSortRows(UInt_t * rows, UInt_t num, UInt_t numChunks,
+                          Bool_t ascending, Get get)
+{
+// computes the sort key of every row and sorts the rows with the radix sort
+
+   typedef typename TFSortKey<T>::Key Key;
+
+   std::vector<Key> keys(num);
+   TFParallel::Foreach(num, numChunks,
+         [&](UInt_t, UInt_t begin, UInt_t end)
+         {
+            for (UInt_t i = begin; i < end; i++)
+               keys[i] = ascending ? TFSortKey<T>::Get(get(rows[i])) :
+                                    ~TFSortKey<T>::Get(get(rows[i]));
+         });
+
+   RadixSort(&keys[0], rows, num, numChunks);
+}
+//_____________________________________________________________________________
+template <class C>
+static Bool_t SortCol(const TFBaseCol & col, Int_t, Bool_t ascending,
+                      UInt_t * rows, UInt_t num, UInt_t numChunks)
+{
+   const C * c = dynamic_cast<const C *>(&col);
+   if (c)
+      RadixSortRows<typename C::value_type>(rows, num, numChunks, ascending,
+                           [c](UInt_t row) {return (*c)[row];});
+   return c != NULL;
+}
+//_____________________________________________________________________________
+template <class C>
+static Bool_t SortArrCol(const TFBaseCol & col, Int_t bin, Bool_t ascending,
+                         UInt_t * rows, UInt_t num, UInt_t numChunks)
+{
+   const C * c = dynamic_cast<const C *>(&col);
+   if (c)
+      RadixSortRows<typename C::value_type>(rows, num, numChunks, ascending,
+                           [c, bin](UInt_t row) {return (*c)[row][bin];});
+   return c != NULL;
+}
+//_____________________________________________________________________________
+void TFSort::SortRows(const TFBaseCol & col, Int_t bin, Bool_t ascending,
+                      UInt_t * rows, UInt_t numRows, Bool_t parallel)
+{
+// Sorts the numRows row numbers in rows depending on the value of the
+// column col. bin is the used bin of an array column and has to be 0
+// for all other columns. Rows with the same value keep their order.
+// The sort uses only the calling thread if parallel is kFALSE.
+
+   if (numRows <= 1)
+      return;
+
+   UInt_t numChunks = parallel ? TFParallel::GetNumChunks(numRows) : 1;
+
+   if (SortCol<TFBoolCol>          (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFCharCol>          (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFUCharCol>         (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFShortCol>         (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFUShortCol>        (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFIntCol>           (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFUIntCol>          (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFFloatCol>         (col, bin, ascending, rows, numRows, numChunks) ||
+       SortCol<TFDoubleCol>        (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFBoolArrCol>    (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFCharArrCol>    (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFUCharArrCol>   (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFShortArrCol>   (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFUShortArrCol>  (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFIntArrCol>     (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFUIntArrCol>    (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFFloatArrCol>   (col, bin, ascending, rows, numRows, numChunks) ||
+       SortArrCol<TFDoubleArrCol>  (col, bin, ascending, rows, numRows, numChunks)   )
+      return;
+
+   const TFDictStringCol * dictCol = dynamic_cast<const TFDictStringCol *>(&col);
+   if (dictCol)
+      {
+      // sort the few strings of the dictionary, then the rows by the rank
+      // of their code with the radix sort
+      std::vector<UInt_t> codes(dictCol->GetNumCodes());
+      for (UInt_t code = 0; code < codes.size(); code++)
+         codes[code] = code;
+      std::sort(codes.begin(), codes.end(), [dictCol](UInt_t c1, UInt_t c2)
+                {return dictCol->GetCodeString(c1).CompareTo(dictCol->GetCodeString(c2)) < 0;});
+
+      std::vector<UInt_t> rank(codes.size());
+      for (UInt_t pos = 0; pos < codes.size(); pos++)
+         rank[codes[pos]] = pos;
+
+      const UInt_t * rowCodes = dictCol->GetCodes();
+      RadixSortRows<UInt_t>(rows, numRows, numChunks, ascending,
+                            [&rank, rowCodes](UInt_t row) {return rank[rowCodes[row]];});
+      return;
+      }
+
+   const TFStringCol * strCol = dynamic_cast<const TFStringCol *>(&col);
+   if (strCol)
+      {
+      const TFStringCol & c = *strCol;
+      if (ascending)
+         MergeSort(rows, numRows, numChunks, [&c](UInt_t r1, UInt_t r2)
+                                  {return c[r1].CompareTo(c[r2]) < 0;});
+      else
+         MergeSort(rows, numRows, numChunks, [&c](UInt_t r1, UInt_t r2)
+                                  {return c[r2].CompareTo(c[r1]) < 0;});
+      return;
+      }
+
+   // any other column type
+   if (ascending)
+      MergeSort(rows, numRows, numChunks, [&col](UInt_t r1, UInt_t r2)
+                               {return col.CompareRows(r1, r2) < 0;});
+   else
+      MergeSort(rows, numRows, numChunks, [&col](UInt_t r1, UInt_t r2)
+                               {return col.CompareRows(r2, r1) < 0;});
+}
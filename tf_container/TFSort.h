@@ -0,0 +1,29 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFSort.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFSort
+#define ROOT_TFSort
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+
+class TFBaseCol;
+
+//_____________________________________________________________________________
+
+class TFSort
+{
+public:
+   static void    SortRows(const TFBaseCol & col, Int_t bin, Bool_t ascending,
+                           UInt_t * rows, UInt_t numRows, Bool_t parallel = kTRUE);
+};
+
+#endif
@@ -9,14 +9,22 @@
 //  History:   1.0   17.07.03  first released version
 //
 // ////////////////////////////////////////////////////////////////////////////
+#include <math.h>
 #include <map>
 
 #include <TGraphErrors.h>
 #include <TAxis.h>
+#include <TLeaf.h>
 
 #include "TFTable.h"
 #include "TFColumn.h"
 #include "TFError.h"
+#include "TFJoin.h"
+#include "TFGroupBy.h"
+#include "TFCrossMatch.h"
+#include "TFSkyIndex.h"
+#include "TFHisto.h"
+#include "TFTreeReader.h"
 
 #ifndef TF_CLASS_IMP
 #define TF_CLASS_IMP
@@ -74,20 +82,31 @@ TFTable::TFTable()
    fNumRows = 0; 
    fReadAll = kFALSE; 
    fAlreadyRead = 0;
+   fSkyIndex = NULL;
 }
 //_____________________________________________________________________________
 TFTable::TFTable(TTree * tree)
       : TFIOElement(tree->GetName())
 {
 // the table is created from all branches of the tree which store simple
-// variables. The othere branches are skipped.
+// variables or arrays of simple variables. Arrays of variable length 
+// (leaves like "x[n]/F") are copied into TF*VarArrCol columns.
+// The othere branches are skipped.
+// tree can also be a TChain, the entries of all its trees are copied into
+// this one table.
+// The branches are read in parallel if the implicit multi-threading of
+// ROOT is enabled ( see ROOT::EnableImplicitMT() ), whole baskets of
+// branches with one number per entry are copied at once into the columns
+// ( see TFTreeReader ).
 // Warning:
 // This function sets the "branch status process" (tree->SetBranchStatus())
 // of all branches which can be copied into a TFTable to 1 and set the 
-// status of all other branches to 0.
+// status of all other branches to 0. The branch addresses of tree are
+// reset.
    fNumRows = 0; 
    fReadAll = kFALSE; 
    fAlreadyRead = 0;
+   fSkyIndex = NULL;
 
    UInt_t rows;
    if (tree->GetEntries() > TF_MAX_ROWS)
@@ -100,6 +119,7 @@ TFTable::TFTable(TTree * tree)
    TFError::SetErrorType(kAllErr);
 
    // create the columns 
+   std::vector<TFTreeCol> treeCols;
    tree->SetBranchStatus("*", 0);
    TObjArray * branches = tree->GetListOfBranches();
    for (int brLoop = 0; brLoop < branches->GetEntriesFast(); brLoop++)
@@ -114,6 +134,7 @@ TFTable::TFTable(TTree * tree)
          // we can use this branch
          {
          void * branchBuffer;
+         const char * countBranch = NULL;
          try 
             {
             const char * array = strchr(leaf, '[');
@@ -121,66 +142,116 @@ TFTable::TFTable(TTree * tree)
                {
                // an array of numbers per entry
                int size = atoi(array+1);
-               if (size == 0) // proberly an array of variable lenght
-                  continue;
-
-               switch (*(pos+1))
+               if (size == 0) 
                   {
-                  case 'C' : {
-                     TFStringCol & col = AddColumn(branch->GetName(), TFStringCol::Class());
-                     branchBuffer = col.GetStringBranchBuffer(size);
-                     }
-                     break;
-                  case 'b' : {
-                     TFUCharArrCol & col = AddColumn(branch->GetName(), TFUCharArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
-                     }
-                     break;
-                  case 'B' : {
-                     TFCharArrCol & col = AddColumn(branch->GetName(), TFCharArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
-                     }
-                     break;
-                  case 's' : {
-                     TFUShortArrCol & col = AddColumn(branch->GetName(), TFUShortArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
-                     }
-                     break;
-                  case 'S' : {
-                     TFShortArrCol & col = AddColumn(branch->GetName(), TFShortArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
-                     }
-                     break;
-                  case 'i' : {
-                     TFUIntArrCol & col = AddColumn(branch->GetName(), TFUIntArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
-                     }
-                     break;
-                  case 'I' :  {
-                     TFIntArrCol & col = AddColumn(branch->GetName(), TFIntArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
-                     }
-                     break;
-                  case 'D' : {
-                     TFDoubleArrCol & col = AddColumn(branch->GetName(), TFDoubleArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
+                  // an array of variable length, the number of values
+                  // per entry is stored in another leaf
+                  TLeaf * tleaf = (TLeaf*)branch->GetListOfLeaves()->At(0);
+                  if (tleaf == NULL || tleaf->GetLeafCount() == NULL)
+                     continue;
+
+                  TFBaseCol * col;
+                  switch (*(pos+1))
+                     {
+                     case 'b' : 
+                        col = &AddColumn(branch->GetName(), TFUCharVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFUCharVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     case 'B' : 
+                        col = &AddColumn(branch->GetName(), TFCharVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFCharVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     case 's' : 
+                        col = &AddColumn(branch->GetName(), TFUShortVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFUShortVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     case 'S' : 
+                        col = &AddColumn(branch->GetName(), TFShortVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFShortVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     case 'i' : 
+                        col = &AddColumn(branch->GetName(), TFUIntVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFUIntVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     case 'I' : 
+                        col = &AddColumn(branch->GetName(), TFIntVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFIntVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     case 'D' : 
+                        col = &AddColumn(branch->GetName(), TFDoubleVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFDoubleVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     case 'F' : 
+                        col = &AddColumn(branch->GetName(), TFFloatVarArrCol::Class());
+                        branchBuffer = dynamic_cast<TFFloatVarArrCol*>(col)->GetVarBranchBuffer(tleaf);
+                        break;
+                     default: 
+                        continue;
                      }
-                     break;
-                  case 'F' : {
-                     TFFloatArrCol & col = AddColumn(branch->GetName(), TFFloatArrCol::Class());
-                     col.SetNumBins(size);
-                     branchBuffer = col.GetBranchBuffer();
+                  // the leaf with the number of values has to be read, too
+                  countBranch = tleaf->GetLeafCount()->GetBranch()->GetName();
+                  tree->SetBranchStatus(countBranch, 1);
+                  }
+               else
+                  {
+                  switch (*(pos+1))
+                     {
+                     case 'C' : {
+                        TFStringCol & col = AddColumn(branch->GetName(), TFStringCol::Class());
+                        branchBuffer = col.GetStringBranchBuffer(size);
+                        }
+                        break;
+                     case 'b' : {
+                        TFUCharArrCol & col = AddColumn(branch->GetName(), TFUCharArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     case 'B' : {
+                        TFCharArrCol & col = AddColumn(branch->GetName(), TFCharArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     case 's' : {
+                        TFUShortArrCol & col = AddColumn(branch->GetName(), TFUShortArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     case 'S' : {
+                        TFShortArrCol & col = AddColumn(branch->GetName(), TFShortArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     case 'i' : {
+                        TFUIntArrCol & col = AddColumn(branch->GetName(), TFUIntArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     case 'I' :  {
+                        TFIntArrCol & col = AddColumn(branch->GetName(), TFIntArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     case 'D' : {
+                        TFDoubleArrCol & col = AddColumn(branch->GetName(), TFDoubleArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     case 'F' : {
+                        TFFloatArrCol & col = AddColumn(branch->GetName(), TFFloatArrCol::Class());
+                        col.SetNumBins(size);
+                        branchBuffer = col.GetBranchBuffer();
+                        }
+                        break;
+                     default: 
+                        continue;
                      }
-                     break;
-                  default: 
-                     continue;
                   }
                }
             else
@@ -220,19 +291,22 @@ TFTable::TFTable(TTree * tree)
          catch (TFException) 
             { continue; }
          tree->SetBranchStatus(branch->GetName(), 1);
-         branch->SetAddress(branchBuffer);
+         // set the address in tree, a TChain sets it in each of its trees
+         tree->SetBranchAddress(branch->GetName(), branchBuffer);
+
+         TFTreeCol treeCol;
+         treeCol.fBranch = branch->GetName();
+         treeCol.fCount  = countBranch ? countBranch : "";
+         treeCol.fCol    = &GetColumn(branch->GetName());
+         treeCols.push_back(treeCol);
          }
       }
 
    TFError::SetErrorType(prevErrType);
 
    // Fill the table columns
-   for (UInt_t row = 0; row < fNumRows; row++)
-      {
-      tree->GetEntry(row);
-      for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
-         i_c->GetCol().CopyBranchBuffer(row);
-      }
+   TFTreeReader::ReadTree(tree, treeCols, fNumRows);
+   tree->ResetBranchAddresses();
 
    // clear the branch buffer of the array columns
    for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
@@ -249,6 +323,7 @@ TFTable::TFTable(const char * name, UInt_t numRows)
    fNumRows = numRows; 
    fReadAll = kFALSE; 
    fAlreadyRead = 0;
+   fSkyIndex = NULL;
 }
 //_____________________________________________________________________________
 TFTable::TFTable(const char * name, const char * fileName)  
@@ -271,6 +346,7 @@ TFTable::TFTable(const char * name, const char * fileName)
    fNumRows = 0; 
    fReadAll = kFALSE; 
    fAlreadyRead = 0;
+   fSkyIndex = NULL;
 
    if (fio)
       fio->CreateElement();
@@ -284,6 +360,7 @@ TFTable::TFTable(const TFTable & table)
 // table in a file. The new table exist only in memory.
    
    fNumRows = table.fNumRows;
+   fSkyIndex = NULL;
 
    TObject * col;
    table.ReadAllCol();
@@ -299,6 +376,7 @@ TFTable::~TFTable()
 
    for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
      delete &i_c->GetCol();
+   delete fSkyIndex;
 }
 //_____________________________________________________________________________
 TFTable & TFTable::operator=(const TFTable & table)
@@ -321,6 +399,7 @@ TFTable & TFTable::operator=(const TFTable & table)
       fNumRows = table.fNumRows;
       fReadAll = kFALSE;
       fAlreadyRead = 0;
+      DropSkyIndex();
 
       table.ReadAllCol();
 
@@ -514,6 +593,358 @@ TFColIter TFTable::MakeColIterator() const
    return TFColIter(&fColumns);
 }
 //_____________________________________________________________________________
+Bool_t TFTable::BuildIndex(const char * colName) const
+{
+// Builds a sorted index of the rows of the column colName. The index is 
+// kept by the column until DropIndex() is called, it is rebuilt after the
+// column was modified or rows were inserted or deleted. 
+// TFRowIter::Filter() and TFRowIter::Sort() use this index to find rows
+// without a scan of all rows. A column which is already sorted in 
+// ascending order does not need an index, it is used with a binary
+// search without extra memory.
+// Only numerical columns with one value per row can have an index, for
+// other columns the function returns kFALSE.
+// If no column with name colName exist in the table a TFException is 
+// thrown or kFALSE is returned, depending on a call of 
+// TFError::SetErrorType().  
+
+   TFBaseCol * col = &GetColumn(colName);
+   if (col == NULL)
+      return kFALSE;
+
+   return col->BuildIndex();
+}
+//_____________________________________________________________________________
+void TFTable::DropIndex(const char * colName) const
+{
+// Deletes the index of the column colName built by BuildIndex().
+// If no column with name colName exist in the table a TFException is 
+// thrown or nothing happens, depending on a call of TFError::SetErrorType().
+
+   TFBaseCol * col = &GetColumn(colName);
+   if (col != NULL)
+      col->DropIndex();
+}
+//_____________________________________________________________________________
+Bool_t TFTable::BuildBitmapIndex(const char * colName) const
+{
+// Builds a bitmap index of the column colName: a compressed bitmap of the
+// rows of every value of the column. It is intended for integer columns 
+// with a few different values like STATUS, GRADE or CCD_ID. Conjunctions
+// and disjunctions of comparisons of such columns with constants in 
+// TFRowIter::Filter() are computed with the bitmaps, only the selected
+// rows are evaluated. The index is kept by the column until 
+// DropBitmapIndex() is called, it is rebuilt after the column was 
+// modified or rows were inserted or deleted. 
+// The function returns kFALSE if the column is not an integer column with
+// one value per row or if it has more than TFBaseCol::kMaxBitmaps 
+// different values.
+// If no column with name colName exist in the table a TFException is 
+// thrown or kFALSE is returned, depending on a call of 
+// TFError::SetErrorType().  
+
+   TFBaseCol * col = &GetColumn(colName);
+   if (col == NULL)
+      return kFALSE;
+
+   return col->BuildBitmapIndex();
+}
+//_____________________________________________________________________________
+void TFTable::DropBitmapIndex(const char * colName) const
+{
+// Deletes the bitmap index of the column colName.
+// If no column with name colName exist in the table a TFException is 
+// thrown or nothing happens, depending on a call of TFError::SetErrorType().
+
+   TFBaseCol * col = &GetColumn(colName);
+   if (col != NULL)
+      col->DropBitmapIndex();
+}
+//_____________________________________________________________________________
+Bool_t TFTable::BuildSkyIndex(const char * pos) const
+{
+// Builds a spatial index of the sky positions of this table. pos is the
+// comma separated list of the right ascension and the declination column,
+// both in degrees. The rows are sorted by the HEALPix pixel ( NESTED
+// scheme, order TFSkyIndex::kOrder ) of their position.
+// TFRowIter::Cone(), TFRowIter::Box() and TFRowIter::Polygon() use this
+// index to test only the rows in the pixels of the region, their time is
+// proportional to the number of selected rows and not to the number of
+// rows of the table. Rows with a NULL or NaN position are not in the index.
+// The index is kept by the table until DropSkyIndex() is called, it is
+// rebuilt after a position column was modified or rows were inserted or
+// deleted. Only one sky index per table exists, a new call of this
+// function replaces the previous index.
+// The pixels are computed in parallel if the implicit multi-threading of
+// ROOT is enabled ( see ROOT::EnableImplicitMT() ).
+// The function returns kFALSE and writes an error into the error stack
+// ( see TFError ) if a position column does not exist or is not a
+// numerical column with one value per row.
+
+   TFSkyIndex * index = new TFSkyIndex;
+   if (!index->Build(*this, pos))
+      {
+      delete index;
+      return kFALSE;
+      }
+
+   delete fSkyIndex;
+   fSkyIndex = index;
+   return kTRUE;
+}
+//_____________________________________________________________________________
+void TFTable::DropSkyIndex() const
+{
+// Deletes the sky index built by BuildSkyIndex() or read by ReadSkyIndex().
+
+   delete fSkyIndex;
+   fSkyIndex = NULL;
+}
+//_____________________________________________________________________________
+const TFSkyIndex * TFTable::GetSkyIndex() const
+{
+// Returns the up to date sky index of this table or NULL if the table has
+// no sky index. An index of modified position columns is rebuilt.
+
+   if (fSkyIndex == NULL || fSkyIndex->IsValid(*this))
+      return fSkyIndex;
+
+   TString pos = fSkyIndex->GetRaName();
+   pos += ",";
+   pos += fSkyIndex->GetDecName();
+
+   TFErrorType errT = TFError::GetErrorType();
+   TFError::SetErrorType(kNoErr);
+   if (!fSkyIndex->Build(*this, pos.Data()))
+      DropSkyIndex();
+   TFError::SetErrorType(errT);
+
+   return fSkyIndex;
+}
+//_____________________________________________________________________________
+Int_t TFTable::SaveSkyIndex() const
+{
+// Saves the sky index of this table ( see BuildSkyIndex() ) into the file
+// of this table. The index is stored as a table with the name of this
+// table and the suffix "_SKYINDEX", a previous index of this table in the
+// file is replaced. Save the table itself before its index, ReadSkyIndex()
+// accepts only an index of a table with the same number of rows.
+// Returns 0 on success. Returns -1 and writes an error into the error
+// stack ( see TFError ) if the table has no sky index or is not associated
+// with a file.
+
+   const TFSkyIndex * index = GetSkyIndex();
+   if (index == NULL || !IsFileConnected())
+      {
+      TFError::SetError("TFTable::SaveSkyIndex",
+                        index == NULL ? "Table %s has no sky index." :
+                                        "Table %s is not associated with a file.",
+                        GetName());
+      return -1;
+      }
+
+   TString fileName = GetFileName();
+   TString name = GetName();
+   name += "_SKYINDEX";
+
+   // delete all previous indexes of this table
+   TFErrorType errT = TFError::GetErrorType();
+   TFError::SetErrorType(kNoErr);
+   TFIOElement * old;
+   while ((old = TFRead(fileName.Data(), name.Data(), 0, kFReadWrite)) != NULL)
+      {
+      Int_t err = old->DeleteElement();
+      delete old;
+      if (err != 0)
+         break;
+      }
+   TFError::SetErrorType(errT);
+
+   TFTable * table = index->MakeTable(name.Data());
+   Int_t err = table->SaveElement(fileName.Data());
+   delete table;
+
+   return err;
+}
+//_____________________________________________________________________________
+Bool_t TFTable::ReadSkyIndex() const
+{
+// Reads the sky index of this table from the file of this table, saved by
+// SaveSkyIndex(). The index replaces a previous sky index of this table.
+// Returns kFALSE if the file has no index of this table. Returns kFALSE
+// and writes an error into the error stack ( see TFError ) if the index
+// in the file does not fit to this table, for example if rows were added
+// to the table after the index was saved.
+
+   DropSkyIndex();
+   if (!IsFileConnected())
+      return kFALSE;
+
+   TString name = GetName();
+   name += "_SKYINDEX";
+
+   TFErrorType errT = TFError::GetErrorType();
+   TFError::SetErrorType(kNoErr);
+   TFIOElement * element = TFRead(GetFileName(), name.Data(), 0, kFRead,
+                                  TFTable::Class());
+   TFError::SetErrorType(errT);
+
+   TFTable * table = dynamic_cast<TFTable *>(element);
+   if (table == NULL)
+      {
+      delete element;
+      return kFALSE;
+      }
+
+   TFSkyIndex * index = new TFSkyIndex;
+   if (index->SetTable(*table, *this))
+      fSkyIndex = index;
+   else
+      delete index;
+
+   delete table;
+   return fSkyIndex != NULL;
+}
+//_____________________________________________________________________________
+Bool_t TFTable::JoinRows(const TFTable & right, const char * keys,
+                         std::vector<UInt_t> & rows, std::vector<UInt_t> & rightRows,
+                         const char * rightKeys, Bool_t leftJoin) const
+{
+// Computes the equi-join of this table with the table right. keys is a 
+// comma separated list of the key columns of this table, rightKeys the
+// list of the key columns of the right table. If rightKeys is NULL the key
+// columns of both tables have the same names. 
+// A pair of rows of both tables matches if all key values are equal. 
+// Numerical key columns are compared by their values, also if they have 
+// different types, string columns ( TFStringCol and TFDictStringCol ) by
+// their strings. A NULL or NaN key value never matches.
+// The function sets rows and rightRows to the row numbers of all matching
+// pairs: row rows[i] of this table matches row rightRows[i] of the right
+// table. The pairs are ordered by rows and then by rightRows.
+// The inner join ( leftJoin == kFALSE ) returns only matching pairs. The
+// left join ( leftJoin == kTRUE ) returns also the rows of this table
+// without a matching row, rightRows is TF_MAX_ROWS for these rows.
+// The join builds a hash table of the key values of the smaller table and
+// looks up the rows of the other table in parallel, if the implicit 
+// multi-threading of ROOT is enabled ( see ROOT::EnableImplicitMT() ).
+// The function returns kFALSE and writes an error into the error stack
+// ( see TFError ) if a key column does not exist, if the number or the types
+// of the key columns do not match or if a key column is not a numerical
+// or string column with one value per row.
+
+   return TFJoin::JoinRows(*this, right, keys, rightKeys, rows, rightRows, leftJoin);
+}
+//_____________________________________________________________________________
+TFTable * TFTable::Join(const TFTable & right, const char * keys,
+                        const char * rightKeys, Bool_t leftJoin) const
+{
+// Creates a new table with the equi-join of this table with the table 
+// right. See JoinRows() for the parameters and how the rows are matched.
+// The new table has one row for each pair of matching rows. It has all
+// columns of this table and all columns of the right table except its
+// key columns. A column of the right table gets the suffix "_" and the 
+// name of the right table if this table has a column with the same name.
+// The rows of a left join without a matching row have NULL values in the
+// columns of the right table.
+// The new table is not associated with a file, the caller has to delete
+// it. The function returns NULL if JoinRows() fails.
+
+   return TFJoin::Join(*this, right, keys, rightKeys, leftJoin);
+}
+//_____________________________________________________________________________
+TFTable * TFTable::GroupBy(const char * keys, const char * aggregates) const
+{
+// Groups the rows of this table by the values of the key columns and 
+// creates a new table with one row per group. keys is a comma separated
+// list of the key columns, they have to be numerical columns with one 
+// value per row or string columns ( TFStringCol and TFDictStringCol ).
+// All rows with a NULL value of a key are one group, as all rows with a
+// NaN value.
+// aggregates is a comma separated list of the aggregates of the output 
+// table. An aggregate is one of 
+//    count         the number of rows of the group
+//    count(col)    the number of not NULL values of column col
+//    sum(col)      the sum of the values of col
+//    mean(col)     the mean value of col
+//    std(col)      the standard deviation of the values of col
+//    min(col)      the minimum value of col
+//    max(col)      the maximum value of col
+//    first(col)    the value of col of the first row of the group
+//    last(col)     the value of col of the last row of the group
+// NULL values of col are ignored by all aggregates. sum, mean and std 
+// require a numerical column with one value per row, their output column
+// is a TFDoubleCol. The output column of min, max, first and last has the 
+// type of col, first and last can be used for any type of column. 
+// The output column of count is a TFUIntCol.
+// The name of the output column of an aggregate is count or col_function,
+// for example E_mean, or is defined with name = function(col), for 
+// example "emean = mean(E)". The value of an aggregate without any not NULL
+// value of col in a group is NULL, as std with less than two values.
+// The new table has the key columns, with the values of the group, and 
+// one column per aggregate. The groups are ordered by their first row in
+// this table.
+// The rows are aggregated in parallel if the implicit multi-threading of
+// ROOT is enabled ( see ROOT::EnableImplicitMT() ). Each thread uses its 
+// own hash table of the groups, these hash tables are merged at the end.
+// The new table is not associated with a file, the caller has to delete
+// it. The function returns NULL and writes an error into the error stack
+// ( see TFError ) if a column does not exist, if a key column or a column
+// of an aggregate has the wrong type or if an aggregate is unknown.
+
+   return TFGroupBy::GroupBy(*this, keys, aggregates);
+}
+//_____________________________________________________________________________
+Bool_t TFTable::CrossMatchRows(const TFTable & other, Double_t radius,
+                               std::vector<UInt_t> & rows, std::vector<UInt_t> & otherRows,
+                               std::vector<Double_t> & separations,
+                               Bool_t nearest, const char * pos, const char * otherPos) const
+{
+// Computes the positional cross-match of this table with the table other.
+// pos is the comma separated list of the right ascension and the 
+// declination column of this table, otherPos the list of the position 
+// columns of the other table. If otherPos is NULL both tables have the 
+// same names of the position columns. The positions and the match radius
+// radius are in degrees.
+// The function sets rows, otherRows and separations to all pairs of
+// positions with a separation up to radius: the position of row rows[i]
+// of this table has the angular distance separations[i] ( in degrees ) 
+// to the position of row otherRows[i] of the other table. The pairs are
+// ordered by rows and then by increasing separation. If nearest is kTRUE
+// only the nearest position of the other table is returned for each row
+// of this table. A position with a NULL or NaN value never matches.
+// The positions of the smaller table are sorted by their HEALPix pixel
+// ( NESTED scheme ) at a resolution derived from radius. For each position
+// of the larger table only the positions in the pixels overlapping the 
+// circle of the match radius are compared. The positions of the larger 
+// table are processed in parallel, if the implicit multi-threading of 
+// ROOT is enabled ( see ROOT::EnableImplicitMT() ).
+// The function returns kFALSE and writes an error into the error stack
+// ( see TFError ) if a position column does not exist or is not a 
+// numerical column with one value per row or if radius is not positive.
+
+   return TFCrossMatch::MatchRows(*this, other, radius, pos, otherPos,
+                                  rows, otherRows, separations, nearest);
+}
+//_____________________________________________________________________________
+TFTable * TFTable::CrossMatch(const TFTable & other, Double_t radius, Bool_t nearest,
+                              const char * pos, const char * otherPos,
+                              const char * sepName) const
+{
+// Creates a new table with the positional cross-match of this table with
+// the table other. See CrossMatchRows() for the parameters and how the
+// positions are matched.
+// The new table has one row for each pair of matching positions. It has
+// all columns of this table, all columns of the other table and the 
+// TFDoubleCol sepName with the separation of both positions in degrees.
+// A column of the other table gets the suffix "_" and the name of the
+// other table if this table has a column with the same name.
+// The new table is not associated with a file, the caller has to delete
+// it. The function returns NULL if CrossMatchRows() fails or if this table
+// has already a column sepName.
+
+   return TFCrossMatch::CrossMatch(*this, other, radius, pos, otherPos, sepName, nearest);
+}
+//_____________________________________________________________________________
 TFRowIter TFTable::MakeRowIterator() const
 {
 // Returns an iterator for all rows of this table. This iterator can
@@ -678,7 +1109,7 @@ Int_t TFTable::DeleteElement(Bool_t updateMemory)
    return TFIOElement::DeleteElement();
 }
 //_____________________________________________________________________________
-TTree * TFTable::MakeTree(TFNameConvert * nameConvert) const
+TTree * TFTable::MakeTree(TFNameConvert * nameConvert, TDirectory * dir) const
 {
 // creates a TTree from all basic column of this table. Each
 // column is copied in one branch of the tree. The tree gets
@@ -686,12 +1117,24 @@ TTree * TFTable::MakeTree(TFNameConvert * nameConvert) const
 // column. 
 // nameConvert can be NULL. But it will be adopted by this
 // function and will be deleted by this function if it is not NULL.
-// The calling function has to delete the returning tree.
+// If dir is not NULL, for example a TFile open for writing, the tree
+// is created in this directory. Its baskets are written to the file
+// while the tree is filled, therefore the whole tree never has to be
+// kept in memory, and the tree is written into dir at the end. With
+// implicit multi-threading enabled (ROOT::EnableImplicitMT()) ROOT
+// compresses the baskets of the branches in parallel.
+// The calling function has to delete the returning tree. If dir is 
+// not NULL, the tree is owned by dir and deleted when dir is closed.
 
    if (nameConvert == NULL)
       nameConvert = new TFNameConvert();
 
    TTree * tree= new TTree(nameConvert->Conv(GetName()), nameConvert->Conv(GetName()) );
+   if (dir)
+      {
+      tree->SetDirectory(dir);
+      tree->SetImplicitMT(kTRUE);
+      }
 
    ReadAllCol();
   
@@ -699,11 +1142,32 @@ TTree * TFTable::MakeTree(TFNameConvert * nameConvert) const
    for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
       i_c->GetCol().MakeBranch(tree, nameConvert);
 
+   // columns with a fixed number of numbers per row are copied with
+   // memcpy directly from the column data, the others fill their 
+   // branch buffer themselves
+   struct RowCopy {const char * src; void * dst; size_t size;};
+   std::vector<RowCopy>          copies;
+   std::vector<const TFBaseCol*> others;
+   for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
+      {
+      RowCopy copy;
+      copy.src = (const char*)i_c->GetCol().GetBranchRows(copy.dst, copy.size);
+      if (copy.src)
+         copies.push_back(copy);
+      else
+         others.push_back(&i_c->GetCol());
+      }
+
    // fill the tree row by row
    for (UInt_t row = 0; row < fNumRows; row++)
       {
-      for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
-         i_c->GetCol().FillBranchBuffer(row);
+      for (std::vector<RowCopy>::iterator i_c = copies.begin(); i_c != copies.end(); i_c++)
+         {
+         memcpy(i_c->dst, i_c->src, i_c->size);
+         i_c->src += i_c->size;
+         }
+      for (std::vector<const TFBaseCol*>::iterator i_c = others.begin(); i_c != others.end(); i_c++)
+         (*i_c)->FillBranchBuffer(row);
       tree->Fill();
       }
 
@@ -711,6 +1175,9 @@ TTree * TFTable::MakeTree(TFNameConvert * nameConvert) const
    for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
       i_c->GetCol().ClearBranchBuffer();
 
+   if (dir)
+      tree->Write("", TObject::kOverwrite);
+
    delete nameConvert;
 
    return tree;
@@ -767,8 +1234,7 @@ TGraphErrors * TFTable::MakeGraph(const char * xCol, const char * yCol,
          // fill the X - axis
          const TFBaseCol & col = GetColumn(xCol);
          double * axis = graph->GetX();
-         for (UInt_t row = 0; row < numRows; row++)
-            axis[row] = col[row];
+         col.ToDoubles(0, numRows, axis);
 
          // set NULL values to 0
          TFNullIter i_null = col.MakeNullIterator();
@@ -785,8 +1251,7 @@ TGraphErrors * TFTable::MakeGraph(const char * xCol, const char * yCol,
          // fill the Y - axis
          const TFBaseCol & col = GetColumn(yCol);
          double * axis = graph->GetY();
-         for (UInt_t row = 0; row < numRows; row++)
-            axis[row] = col[row];
+         col.ToDoubles(0, numRows, axis);
 
          // set NULL values to 0
          TFNullIter i_null = col.MakeNullIterator();
@@ -803,8 +1268,7 @@ TGraphErrors * TFTable::MakeGraph(const char * xCol, const char * yCol,
          // fill the X - errors
          const TFBaseCol & col = GetColumn(xErrCol);
          double * axis = graph->GetEX();
-         for (UInt_t row = 0; row < numRows; row++)
-            axis[row] = col[row];
+         col.ToDoubles(0, numRows, axis);
 
          // set NULL values to 0
          TFNullIter i_null = col.MakeNullIterator();
@@ -821,8 +1285,7 @@ TGraphErrors * TFTable::MakeGraph(const char * xCol, const char * yCol,
          // fill the Y - errors 
          const TFBaseCol & col = GetColumn(yErrCol);
          double * axis = graph->GetEY();
-         for (UInt_t row = 0; row < numRows; row++)
-            axis[row] = col[row];
+         col.ToDoubles(0, numRows, axis);
 
          // set NULL values to 0
          TFNullIter i_null = col.MakeNullIterator();
@@ -848,13 +1311,82 @@ TGraphErrors * TFTable::MakeGraph(const char * xCol, const char * yCol,
    return graph;
 }
 //_____________________________________________________________________________
+TH1 * TFTable::MakeHisto(const char * cols, Int_t numBins, const char * weightCol,
+                         TFRowIter * rowIter, const char * name) const
+{
+// Creates a new histogram of the values of the columns cols, a comma
+// separated list of 1, 2 or 3 column names. The histogram is a TH1D, a
+// TH2D or a TH3D with numBins bins per axis. The range of an axis is the
+// range of all values of its column ( see TFBaseCol::GetStats() ), also if
+// only the rows of rowIter are filled. The name of the histogram is name
+// or, if name is NULL, the name of this table and the column names 
+// separated by "_", for example "EVENTS_DETX_DETY". The axis titles are 
+// the column names.
+// See FillHisto() for weightCol and rowIter.
+// The caller has to delete the returned histogram. The function returns
+// NULL and writes an error into the error stack ( see TFError ) if a
+// column does not exist or is not a numerical column with one value per
+// row.
+// example: an energy spectrum and a detector map of an event list:
+//    TH1 * spectrum = events.MakeHisto("PI", 1024);
+//    TH1 * map      = events.MakeHisto("DETX,DETY", 512);
+
+   return TFHisto::MakeHisto(*this, cols, numBins, weightCol, rowIter, name);
+}
+//_____________________________________________________________________________
+Bool_t TFTable::FillHisto(TH1 * hist, const char * cols, const char * weightCol,
+                          TFRowIter * rowIter) const
+{
+// Fills the values of the columns cols into the histogram hist. cols is a
+// comma separated list of column names, one column per dimension of hist:
+// x, y and z. weightCol is the column of the weights of the rows, all
+// rows have the weight 1 if it is NULL. If rowIter is not NULL only the
+// rows selected by this iterator of this table are filled ( see
+// TFRowIter::Filter() ).
+// A row with a NULL value in one of these columns is not filled. Like
+// TH1::Fill() the function adds to the bin contents, the errors and the
+// statistics of hist, values outside the axis ranges are counted in the
+// underflow and overflow bins but not in the statistics. The axes are not
+// extended.
+// The columns are read in blocks of rows with a contiguous loop per
+// column type. Each chunk of rows is counted in its own bin array, in
+// parallel if the implicit multi-threading of ROOT is enabled ( see
+// ROOT::EnableImplicitMT() ), and these arrays are added to hist at the
+// end. TH1::Fill() is not called.
+// The function returns kFALSE and writes an error into the error stack
+// ( see TFError ) if a column does not exist or is not a numerical column
+// with one value per row or if the number of columns is not the dimension
+// of hist.
+
+   return TFHisto::FillHisto(*this, hist, cols, weightCol, rowIter);
+}
+//_____________________________________________________________________________
 void TFTable::Print(const Option_t* option) const
 {
+// Prints the table, the header attributes if option contains "h", the 
+// columns if option is empty or contains "c" and the statistics of all
+// columns in memory (see TFBaseCol::GetStats() ) if option contains "s".
+
    TFIOElement::Print(option);
 
    printf("\n  number of rows: %u  number of columns: %u\n",  
       GetNumRows(), GetNumColumns() );
 
+   if (strchr(option, 's') != NULL ||
+       strchr(option, 'S') != NULL    )
+      {
+      printf("\n%-20s %12s %10s %14s %14s %14s %14s\n", "column", "values", "NULLs",
+             "min", "max", "mean", "sigma");
+      for (I_ColList i_c = fColumns.begin(); i_c != fColumns.end(); i_c++)
+         {
+         const TFColStats & stats = i_c->GetCol().GetStats();
+         printf("%-20s %12llu %10llu %14.6g %14.6g %14.6g %14.6g\n",
+                i_c->GetCol().GetName(), stats.GetCount(), stats.GetNumNull(),
+                stats.GetMin(), stats.GetMax(), stats.GetMean(), 
+                sqrt(stats.GetVariance()));
+         }
+      }
+
    if (option[0] != 0 &&
        strchr(option, 'c') == NULL &&
        strchr(option, 'C') == NULL    )
@@ -880,6 +1412,15 @@ void TFTable::Print(const Option_t* option) const
    typedefNames[TFUIntArrCol::Class()->GetName()] = "TFUIntArrCol";
    typedefNames[TFFloatArrCol::Class()->GetName()] = "TFFloatArrCol";
    typedefNames[TFDoubleArrCol::Class()->GetName()] = "TFDoubleArrCol";
+   typedefNames[TFBoolVarArrCol::Class()->GetName()] = "TFBoolVarArrCol";
+   typedefNames[TFCharVarArrCol::Class()->GetName()] = "TFCharVarArrCol";
+   typedefNames[TFUCharVarArrCol::Class()->GetName()] = "TFUCharVarArrCol";
+   typedefNames[TFShortVarArrCol::Class()->GetName()] = "TFShortVarArrCol";
+   typedefNames[TFUShortVarArrCol::Class()->GetName()] = "TFUShortVarArrCol";
+   typedefNames[TFIntVarArrCol::Class()->GetName()] = "TFIntVarArrCol";
+   typedefNames[TFUIntVarArrCol::Class()->GetName()] = "TFUIntVarArrCol";
+   typedefNames[TFFloatVarArrCol::Class()->GetName()] = "TFFloatVarArrCol";
+   typedefNames[TFDoubleVarArrCol::Class()->GetName()] = "TFDoubleVarArrCol";
    typedefNames[TFBoolCol::Class()->GetName()] = "TFBoolCol";
    typedefNames[TFCharCol::Class()->GetName()] = "TFCharCol";
    typedefNames[TFUCharCol::Class()->GetName()] = "TFUCharCol";
@@ -34,7 +34,11 @@ class TFBaseCol;
 class TFColIter;
 class TFRowIter;
 class TGraphErrors;
+class TH1;
 class TFNameConvert;
+class TDirectory;
+class TFSkyIndex;
+class TFSkyRegion;
 
 const UInt_t TF_MAX_ROWS = 0xffffffff;
 
@@ -48,6 +52,7 @@ protected:
    mutable ColList  fColumns;     //! sorted list of all columns of this table
    mutable Bool_t   fReadAll;     //! kTRUE if all columns read from file
    mutable UInt_t   fAlreadyRead; //! number of columns already read from file
+   mutable TFSkyIndex * fSkyIndex;  //! HEALPix index of the positions, see BuildSkyIndex()
 
 public:
    TFTable();
@@ -72,6 +77,33 @@ public:
    virtual  TFColIter   MakeColIterator() const;
    virtual  TFRowIter   MakeRowIterator() const;
 
+   virtual  Bool_t      BuildIndex(const char * colName) const;
+   virtual  void        DropIndex(const char * colName) const;
+   virtual  Bool_t      BuildBitmapIndex(const char * colName) const;
+   virtual  void        DropBitmapIndex(const char * colName) const;
+   virtual  Bool_t      BuildSkyIndex(const char * pos = "RA,DEC") const;
+   virtual  void        DropSkyIndex() const;
+   virtual  Int_t       SaveSkyIndex() const;
+   virtual  Bool_t      ReadSkyIndex() const;
+            const TFSkyIndex * GetSkyIndex() const;
+
+   virtual  TFTable *   Join(const TFTable & right, const char * keys,
+                             const char * rightKeys = NULL, Bool_t leftJoin = kFALSE) const;
+   virtual  Bool_t      JoinRows(const TFTable & right, const char * keys,
+                                 std::vector<UInt_t> & rows, std::vector<UInt_t> & rightRows,
+                                 const char * rightKeys = NULL, Bool_t leftJoin = kFALSE) const;
+   virtual  TFTable *   GroupBy(const char * keys, const char * aggregates) const;
+   virtual  TFTable *   CrossMatch(const TFTable & other, Double_t radius,
+                                   Bool_t nearest = kTRUE, const char * pos = "RA,DEC",
+                                   const char * otherPos = NULL,
+                                   const char * sepName = "SEPARATION") const;
+   virtual  Bool_t      CrossMatchRows(const TFTable & other, Double_t radius,
+                                       std::vector<UInt_t> & rows,
+                                       std::vector<UInt_t> & otherRows,
+                                       std::vector<Double_t> & separations,
+                                       Bool_t nearest = kTRUE, const char * pos = "RA,DEC",
+                                       const char * otherPos = NULL) const;
+
    virtual  void        InsertRows(UInt_t numRows = 1, UInt_t pos = TF_MAX_ROWS);
    virtual  void        DeleteRows(UInt_t numRows = 1, UInt_t pos = TF_MAX_ROWS);
 
@@ -83,10 +115,18 @@ public:
    virtual  Int_t       SaveElement(const char * fileName = NULL, Int_t compLevel = -1);
    virtual  Int_t       DeleteElement(Bool_t updateMemory = kFALSE);
 
-   virtual  TTree *     MakeTree(TFNameConvert * nameConvert = NULL) const;
+   virtual  TTree *     MakeTree(TFNameConvert * nameConvert = NULL,
+                                 TDirectory * dir = NULL) const;
    virtual  TGraphErrors * MakeGraph(const char * xCol, const char * yCol,
                                      const char * xErrCol = NULL, const char * yErrCol = NULL,
                                      TGraphErrors * graph = NULL);
+   virtual  TH1 *       MakeHisto(const char * cols, Int_t numBins = 100,
+                                  const char * weightCol = NULL,
+                                  TFRowIter * rowIter = NULL,
+                                  const char * name = NULL) const;
+   virtual  Bool_t      FillHisto(TH1 * hist, const char * cols,
+                                  const char * weightCol = NULL,
+                                  TFRowIter * rowIter = NULL) const;
    virtual  void        Print(const Option_t* option = "") const;
 
 protected:
@@ -108,6 +148,8 @@ class TFRowIter
          UInt_t   * fRow;        // the selected rows in sorted order
          UInt_t   fNextIndex;    // the next row index of fRow for the operator functions
          UInt_t   fMaxIndex;     // number of row indexes in fRow
+         Bool_t   fParallel;     // kTRUE: Filter() may use several threads
+         Bool_t   fAllRows;      // kTRUE: fRow are all rows of the table in ascending order
 
    TFRowIter(const TFTable * table);
 
@@ -118,17 +160,26 @@ public:
    TFRowIter & operator = (const TFRowIter & rowIter);
 
    Bool_t      Filter(const char * filter);
-   void        Sort(const char * colName);
+   Bool_t      Cone(Double_t ra, Double_t dec, Double_t radius, const char * pos = NULL);
+   Bool_t      Box(Double_t raMin, Double_t raMax, Double_t decMin, Double_t decMax,
+                   const char * pos = NULL);
+   Bool_t      Polygon(UInt_t num, const Double_t * ra, const Double_t * dec,
+                       const char * pos = NULL);
+   void        Sort(const char * colNames, Bool_t ascending = kTRUE);
    void        ClearFilterSort();
    UInt_t      Map(UInt_t index);
+   void        SetParallel(Bool_t parallel = kTRUE)  {fParallel = parallel;}
+   Bool_t      IsParallel() const         {return fParallel;}
    Bool_t      Next();
    UInt_t      operator * ()              {return fRow[fNextIndex-1];}
    void        Reset()                    {fNextIndex = 0;}
 
 friend TFRowIter TFTable::MakeRowIterator() const;
 friend class TFGroupIter;
+friend class TFHisto;
 
 private:
+   Bool_t      SelectRegion(const TFSkyRegion & region, const char * pos);
 
    ClassDef(TFRowIter, 0)  // A TFTable - iterator for rows
 };
@@ -0,0 +1,426 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFTableSource.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <typeinfo>
+
+#include <ROOT/RVec.hxx>
+
+#include "TFTableSource.h"
+#include "TFGroup.h"
+#include "TFTable.h"
+#include "TFColumn.h"
+#include "TFError.h"
+
+
+//_____________________________________________________________________________
+// TFTableSource:
+//    A data source of ROOT::RDataFrame with the rows of one TFTable or of
+//    all tables of a TFGroup. The columns are read directly from the
+//    memory of the columns of the tables, the values are not copied:
+//       TFTable * table = TFReadTable("events.asro", "EVENTS");
+//       ROOT::RDataFrame df = TFMakeDataFrame(*table);
+//       auto h = df.Filter("PI > 30").Histo1D("X");
+//    or
+//       ROOT::RDataFrame df(std::make_unique<TFTableSource>(*table));
+//
+//    The type of a column in the data frame is the C++ type of the values:
+//    Char_t, UChar_t, Short_t, UShort_t, Int_t, UInt_t, Float_t and Double_t
+//    for the numerical columns ( also Char_t for the boolean columns ),
+//    std::string_view for the string columns and ROOT::RVec<T> for the
+//    array columns with a fixed or a variable number of bins per row. The
+//    RVec and the string_view point into the memory of the column.
+//    Other columns are not available in the data frame. A NULL value
+//    has its value stored in the column.
+//
+//    The entries of a TFGroup are the rows of all its tables, table after
+//    table, in the order of the group iterator ( see TFGroupIter ). Only
+//    the tables with the same columns, the same names and the same column
+//    types, as the first table are used.
+//
+//    The entries are split into one range of rows per slot. If the implicit
+//    multi-threading of ROOT is enabled ( see ROOT::EnableImplicitMT() ) the
+//    data frame processes these ranges in parallel.
+//    The tables must not be changed and not be deleted as long as the data
+//    frame exists.
+
+//_____________________________________________________________________________
+// reader of one column, one value per slot
+
+class TFDSColumn
+{
+protected:
+   std::vector<const TFBaseCol *>  fCol;   // the column of the entry range of each slot
+
+public:
+   virtual ~TFDSColumn() {}
+
+   virtual const std::type_info & GetType() const = 0;
+   virtual void *    GetReader(UInt_t slot) = 0;
+   virtual void      SetNSlots(UInt_t nSlots)       {fCol.assign(nSlots, NULL);}
+   virtual void      InitSlot(UInt_t slot, const TFBaseCol * col)  {fCol[slot] = col;}
+   virtual void      SetEntry(UInt_t slot, UInt_t row) = 0;
+};
+
+//_____________________________________________________________________________
+// one value per row, the reader points directly to the value in the column
+
+template <class T, class C>
+   class TFDSValue : public TFDSColumn
+{
+   std::vector<const T *>  fData;    // first row of the column of each slot
+   std::vector<T *>        fValue;   // the actual value of each slot
+
+public:
+   const std::type_info & GetType() const   {return typeid(T);}
+   void *   GetReader(UInt_t slot)          {return &fValue[slot];}
+   void     SetNSlots(UInt_t nSlots)        {TFDSColumn::SetNSlots(nSlots);
+                                             fData.assign(nSlots, NULL);
+                                             fValue.assign(nSlots, NULL);}
+   void     InitSlot(UInt_t slot, const TFBaseCol * col)
+                        {fCol[slot] = col;
+                         fData[slot] = static_cast<const C *>(col)->GetDataArray();}
+   void     SetEntry(UInt_t slot, UInt_t row)
+                        {fValue[slot] = const_cast<T *>(fData[slot] + row);}
+};
+
+//_____________________________________________________________________________
+// strings, a string_view of the string in the column
+
+template <class C>
+   class TFDSString : public TFDSColumn
+{
+   std::vector<std::string_view>    fView;    // the actual string of each slot
+   std::vector<std::string_view *>  fValue;   // pointer to fView of each slot
+
+public:
+   const std::type_info & GetType() const   {return typeid(std::string_view);}
+   void *   GetReader(UInt_t slot)          {return &fValue[slot];}
+   void     SetNSlots(UInt_t nSlots)        {TFDSColumn::SetNSlots(nSlots);
+                                             fView.assign(nSlots, std::string_view());
+                                             fValue.resize(nSlots);
+                                             for (UInt_t s = 0; s < nSlots; s++)
+                                                fValue[s] = &fView[s];}
+   void     SetEntry(UInt_t slot, UInt_t row)
+                        {fView[slot] = static_cast<const C *>(fCol[slot])->GetView(row);}
+};
+
+//_____________________________________________________________________________
+// arrays, a RVec which adopts the bins of the row in the column
+
+template <class T, class C>
+   class TFDSArray : public TFDSColumn
+{
+   std::vector<ROOT::RVec<T> >    fVec;     // the actual row of each slot
+   std::vector<ROOT::RVec<T> *>   fValue;   // pointer to fVec of each slot
+
+public:
+   const std::type_info & GetType() const   {return typeid(ROOT::RVec<T>);}
+   void *   GetReader(UInt_t slot)          {return &fValue[slot];}
+   void     SetNSlots(UInt_t nSlots)        {TFDSColumn::SetNSlots(nSlots);
+                                             fVec.clear();
+                                             fVec.resize(nSlots);
+                                             fValue.resize(nSlots);
+                                             for (UInt_t s = 0; s < nSlots; s++)
+                                                fValue[s] = &fVec[s];}
+   void     SetEntry(UInt_t slot, UInt_t row)
+                        {
+                        // a RVec constructed from a pointer does not own the memory
+                        auto bins = (*static_cast<const C *>(fCol[slot]))[row];
+                        fVec[slot].~RVec<T>();
+                        new (&fVec[slot]) ROOT::RVec<T>(const_cast<T *>(bins.data()), bins.size());
+                        }
+};
+
+//_____________________________________________________________________________
+template <class C>
+static Bool_t IsCol(const TFBaseCol * col)
+{
+   return dynamic_cast<const C *>(col) != NULL;
+}
+//_____________________________________________________________________________
+static TFDSColumn * MakeReader(const TFBaseCol * col, std::string & typeName)
+{
+// returns a new reader for the column col and its type in the data frame,
+// or NULL if this kind of column is not supported
+
+   TFDSColumn * reader = NULL;
+
+   if      (IsCol<TFBoolCol>(col))     {typeName = "Char_t";   reader = new TFDSValue<Char_t,   TFBoolCol>;}
+   else if (IsCol<TFCharCol>(col))     {typeName = "Char_t";   reader = new TFDSValue<Char_t,   TFCharCol>;}
+   else if (IsCol<TFUCharCol>(col))    {typeName = "UChar_t";  reader = new TFDSValue<UChar_t,  TFUCharCol>;}
+   else if (IsCol<TFShortCol>(col))    {typeName = "Short_t";  reader = new TFDSValue<Short_t,  TFShortCol>;}
+   else if (IsCol<TFUShortCol>(col))   {typeName = "UShort_t"; reader = new TFDSValue<UShort_t, TFUShortCol>;}
+   else if (IsCol<TFIntCol>(col))      {typeName = "Int_t";    reader = new TFDSValue<Int_t,    TFIntCol>;}
+   else if (IsCol<TFUIntCol>(col))     {typeName = "UInt_t";   reader = new TFDSValue<UInt_t,   TFUIntCol>;}
+   else if (IsCol<TFFloatCol>(col))    {typeName = "Float_t";  reader = new TFDSValue<Float_t,  TFFloatCol>;}
+   else if (IsCol<TFDoubleCol>(col))   {typeName = "Double_t"; reader = new TFDSValue<Double_t, TFDoubleCol>;}
+
+   else if (IsCol<TFStringCol>(col))      {typeName = "std::string_view"; reader = new TFDSString<TFStringCol>;}
+   else if (IsCol<TFDictStringCol>(col))  {typeName = "std::string_view"; reader = new TFDSString<TFDictStringCol>;}
+
+   else if (IsCol<TFBoolArrCol>(col))     {typeName = "ROOT::VecOps::RVec<Char_t>";   reader = new TFDSArray<Char_t,   TFBoolArrCol>;}
+   else if (IsCol<TFCharArrCol>(col))     {typeName = "ROOT::VecOps::RVec<Char_t>";   reader = new TFDSArray<Char_t,   TFCharArrCol>;}
+   else if (IsCol<TFUCharArrCol>(col))    {typeName = "ROOT::VecOps::RVec<UChar_t>";  reader = new TFDSArray<UChar_t,  TFUCharArrCol>;}
+   else if (IsCol<TFShortArrCol>(col))    {typeName = "ROOT::VecOps::RVec<Short_t>";  reader = new TFDSArray<Short_t,  TFShortArrCol>;}
+   else if (IsCol<TFUShortArrCol>(col))   {typeName = "ROOT::VecOps::RVec<UShort_t>"; reader = new TFDSArray<UShort_t, TFUShortArrCol>;}
+   else if (IsCol<TFIntArrCol>(col))      {typeName = "ROOT::VecOps::RVec<Int_t>";    reader = new TFDSArray<Int_t,    TFIntArrCol>;}
+   else if (IsCol<TFUIntArrCol>(col))     {typeName = "ROOT::VecOps::RVec<UInt_t>";   reader = new TFDSArray<UInt_t,   TFUIntArrCol>;}
+   else if (IsCol<TFFloatArrCol>(col))    {typeName = "ROOT::VecOps::RVec<Float_t>";  reader = new TFDSArray<Float_t,  TFFloatArrCol>;}
+   else if (IsCol<TFDoubleArrCol>(col))   {typeName = "ROOT::VecOps::RVec<Double_t>"; reader = new TFDSArray<Double_t, TFDoubleArrCol>;}
+
+   else if (IsCol<TFBoolVarArrCol>(col))   {typeName = "ROOT::VecOps::RVec<Char_t>";   reader = new TFDSArray<Char_t,   TFBoolVarArrCol>;}
+   else if (IsCol<TFCharVarArrCol>(col))   {typeName = "ROOT::VecOps::RVec<Char_t>";   reader = new TFDSArray<Char_t,   TFCharVarArrCol>;}
+   else if (IsCol<TFUCharVarArrCol>(col))  {typeName = "ROOT::VecOps::RVec<UChar_t>";  reader = new TFDSArray<UChar_t,  TFUCharVarArrCol>;}
+   else if (IsCol<TFShortVarArrCol>(col))  {typeName = "ROOT::VecOps::RVec<Short_t>";  reader = new TFDSArray<Short_t,  TFShortVarArrCol>;}
+   else if (IsCol<TFUShortVarArrCol>(col)) {typeName = "ROOT::VecOps::RVec<UShort_t>"; reader = new TFDSArray<UShort_t, TFUShortVarArrCol>;}
+   else if (IsCol<TFIntVarArrCol>(col))    {typeName = "ROOT::VecOps::RVec<Int_t>";    reader = new TFDSArray<Int_t,    TFIntVarArrCol>;}
+   else if (IsCol<TFUIntVarArrCol>(col))   {typeName = "ROOT::VecOps::RVec<UInt_t>";   reader = new TFDSArray<UInt_t,   TFUIntVarArrCol>;}
+   else if (IsCol<TFFloatVarArrCol>(col))  {typeName = "ROOT::VecOps::RVec<Float_t>";  reader = new TFDSArray<Float_t,  TFFloatVarArrCol>;}
+   else if (IsCol<TFDoubleVarArrCol>(col)) {typeName = "ROOT::VecOps::RVec<Double_t>"; reader = new TFDSArray<Double_t, TFDoubleVarArrCol>;}
+
+   return reader;
+}
+//_____________________________________________________________________________
+TFTableSource::TFTableSource(const TFTable & table)
+{
+// The entries of the data source are the rows of table.
+
+   fNSlots = 0;
+   fRangesDone = kFALSE;
+
+   SetSchema(table);
+   AddTable(table);
+}
+//_____________________________________________________________________________
+TFTableSource::TFTableSource(TFGroup & group)
+{
+// The entries of the data source are the rows of all tables of group
+// which have the same columns as the first table of the group. The tables
+// read by the group iterator are kept and are deleted by the destructor 
+// of this data source.
+
+   fNSlots = 0;
+   fRangesDone = kFALSE;
+
+   TFGroupIter iter = group.MakeGroupIterator();
+   while (iter.Next())
+      {
+      TFTable * table = dynamic_cast<TFTable *>(&(*iter));
+      if (table == NULL || dynamic_cast<TFGroup *>(table) != NULL)
+         continue;
+
+      // the table is passed from the iterator to this data source, it is
+      // not deleted at the next call of Next()
+      iter.Release();
+
+      if (fTables.empty())
+         SetSchema(*table);
+      else if (!HasSchema(*table))
+         {
+         delete table;
+         continue;
+         }
+
+      fOwnTables.push_back(table);
+      AddTable(*table);
+      }
+
+   if (fTables.empty())
+      {
+      TFError::SetError("TFTableSource::TFTableSource",
+                        "The group %s has no table.", group.GetName());
+      fFirstEntry.push_back(0);
+      }
+}
+//_____________________________________________________________________________
+TFTableSource::~TFTableSource()
+{
+   for (UInt_t col = 0; col < fColumns.size(); col++)
+      delete fColumns[col];
+
+   for (UInt_t num = 0; num < fOwnTables.size(); num++)
+      delete fOwnTables[num];
+}
+//_____________________________________________________________________________
+void TFTableSource::SetSchema(const TFTable & table)
+{
+// private function. Defines the columns of the data source, the
+// supported columns of table
+
+   TFColIter iter = table.MakeColIterator();
+   while (iter.Next())
+      {
+      std::string typeName;
+      TFDSColumn * reader = MakeReader(&(*iter), typeName);
+      if (reader == NULL)
+         continue;
+
+      fColNames.push_back(iter->GetName());
+      fColTypes.push_back(typeName);
+      fColumns.push_back(reader);
+      fCols.push_back(std::vector<const TFBaseCol *>());
+      }
+}
+//_____________________________________________________________________________
+Bool_t TFTableSource::HasSchema(const TFTable & table) const
+{
+// private function. Returns kTRUE if table has the same columns as the
+// first table of this data source.
+
+   if (table.GetNumColumns() != fTables[0]->GetNumColumns())
+      return kFALSE;
+
+   TFErrorType errT = TFError::GetErrorType();
+   TFError::SetErrorType(kNoErr);
+
+   Bool_t same = kTRUE;
+   for (UInt_t col = 0; col < fColNames.size() && same; col++)
+      {
+      const TFBaseCol * column = &table.GetColumn(fColNames[col].c_str());
+      same = column != NULL && column->IsA() == fCols[col][0]->IsA();
+      }
+
+   TFError::SetErrorType(errT);
+
+   return same;
+}
+//_____________________________________________________________________________
+void TFTableSource::AddTable(const TFTable & table)
+{
+// private function. Appends the rows of table to the entries.
+
+   if (fFirstEntry.empty())
+      fFirstEntry.push_back(0);
+   fFirstEntry.push_back(fFirstEntry.back() + table.GetNumRows());
+
+   fTables.push_back(&table);
+   for (UInt_t col = 0; col < fColNames.size(); col++)
+      fCols[col].push_back(&table.GetColumn(fColNames[col].c_str()));
+}
+//_____________________________________________________________________________
+void TFTableSource::SetNSlots(unsigned int nSlots)
+{
+// Called by the data frame before the column readers are requested.
+
+   fNSlots = nSlots;
+   fSlotTable.assign(nSlots, 0);
+   for (UInt_t col = 0; col < fColumns.size(); col++)
+      fColumns[col]->SetNSlots(nSlots);
+}
+//_____________________________________________________________________________
+bool TFTableSource::HasColumn(std::string_view name) const
+{
+   return std::find(fColNames.begin(), fColNames.end(), name) != fColNames.end();
+}
+//_____________________________________________________________________________
+std::string TFTableSource::GetTypeName(std::string_view name) const
+{
+// Returns the C++ type of the column name in the data frame.
+
+   UInt_t col = std::find(fColNames.begin(), fColNames.end(), name) - fColNames.begin();
+   if (col == fColNames.size())
+      throw std::runtime_error("TFTableSource: column " + std::string(name) + " does not exist");
+
+   return fColTypes[col];
+}
+//_____________________________________________________________________________
+ROOT::RDF::RDataSource::Record_t
+TFTableSource::GetColumnReadersImpl(std::string_view name, const std::type_info & type)
+{
+// Returns for each slot the address of the pointer to the actual value of
+// the column name. As required by the data frame an exception is thrown if
+// the column does not exist or has an other type than type.
+
+   UInt_t col = std::find(fColNames.begin(), fColNames.end(), name) - fColNames.begin();
+   if (col == fColNames.size())
+      throw std::runtime_error("TFTableSource: column " + std::string(name) + " does not exist");
+
+   if (fColumns[col]->GetType() != type)
+      throw std::runtime_error("TFTableSource: column " + std::string(name) +
+                               " has the type " + fColTypes[col]);
+
+   if (std::find(fActive.begin(), fActive.end(), col) == fActive.end())
+      fActive.push_back(col);
+
+   Record_t readers(fNSlots);
+   for (UInt_t slot = 0; slot < fNSlots; slot++)
+      readers[slot] = fColumns[col]->GetReader(slot);
+
+   return readers;
+}
+//_____________________________________________________________________________
+std::vector<std::pair<ULong64_t, ULong64_t> > TFTableSource::GetEntryRanges()
+{
+// Returns at the first call after Initialize() one range of entries per
+// slot, none of them crosses the end of a table, and an empty list at the
+// next call.
+
+   std::vector<std::pair<ULong64_t, ULong64_t> > ranges;
+   if (fRangesDone)
+      return ranges;
+   fRangesDone = kTRUE;
+
+   ULong64_t numEntries = fFirstEntry.back();
+   ULong64_t rangeSize  = (numEntries + fNSlots - 1) / std::max(fNSlots, 1U);
+
+   ULong64_t begin = 0;
+   for (UInt_t num = 0; num < fTables.size(); num++)
+      while (begin < fFirstEntry[num + 1])
+         {
+         ULong64_t end = std::min(begin + rangeSize, fFirstEntry[num + 1]);
+         ranges.push_back(std::make_pair(begin, end));
+         begin = end;
+         }
+
+   return ranges;
+}
+//_____________________________________________________________________________
+void TFTableSource::InitSlot(unsigned int slot, ULong64_t firstEntry)
+{
+// Called by the data frame before the entries of the range starting at
+// firstEntry are read with slot.
+
+   UInt_t table = std::upper_bound(fFirstEntry.begin(), fFirstEntry.end(), firstEntry) -
+                  fFirstEntry.begin() - 1;
+   fSlotTable[slot] = table;
+
+   for (UInt_t num = 0; num < fActive.size(); num++)
+      fColumns[fActive[num]]->InitSlot(slot, fCols[fActive[num]][table]);
+}
+//_____________________________________________________________________________
+bool TFTableSource::SetEntry(unsigned int slot, ULong64_t entry)
+{
+// Sets the readers of slot to the row of entry.
+
+   UInt_t row = (UInt_t)(entry - fFirstEntry[fSlotTable[slot]]);
+   for (UInt_t num = 0; num < fActive.size(); num++)
+      fColumns[fActive[num]]->SetEntry(slot, row);
+
+   return true;
+}
+//_____________________________________________________________________________
+ROOT::RDataFrame TFMakeDataFrame(const TFTable & table)
+{
+// Returns a ROOT::RDataFrame of the rows of table. See TFTableSource.
+
+   return ROOT::RDataFrame(std::make_unique<TFTableSource>(table));
+}
+//_____________________________________________________________________________
+ROOT::RDataFrame TFMakeDataFrame(TFGroup & group)
+{
+// Returns a ROOT::RDataFrame of the rows of all tables with the same
+// columns in group. See TFTableSource.
+
+   return ROOT::RDataFrame(std::make_unique<TFTableSource>(group));
+}
@@ -0,0 +1,76 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFTableSource.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFTableSource
+#define ROOT_TFTableSource
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#include <string>
+#include <vector>
+
+#include <ROOT/RDataSource.hxx>
+#include <ROOT/RDataFrame.hxx>
+
+
+class TFTable;
+class TFGroup;
+class TFBaseCol;
+class TFDSColumn;
+
+//_____________________________________________________________________________
+
+class TFTableSource : public ROOT::RDF::RDataSource
+{
+   std::vector<const TFTable *>  fTables;      // the tables, their rows are the entries
+   std::vector<TFTable *>        fOwnTables;   // tables read from a group, deleted by this source
+   std::vector<ULong64_t>        fFirstEntry;  // first entry of each table and number of entries
+   std::vector<std::string>      fColNames;    // names of the columns
+   std::vector<std::string>      fColTypes;    // type names of the columns
+   std::vector<TFDSColumn *>     fColumns;     // one reader for each column
+   std::vector<std::vector<const TFBaseCol *> >  fCols;  // the column of each table
+   std::vector<UInt_t>           fActive;      // index of the columns used by the data frame
+   std::vector<UInt_t>           fSlotTable;   // table of the actual entry range of each slot
+   UInt_t                        fNSlots;      // number of slots
+   Bool_t                        fRangesDone;  // kTRUE: GetEntryRanges() returned all ranges
+
+   TFTableSource(const TFTableSource &);
+   TFTableSource & operator = (const TFTableSource &);
+
+   void           SetSchema(const TFTable & table);
+   Bool_t         HasSchema(const TFTable & table) const;
+   void           AddTable(const TFTable & table);
+
+protected:
+   virtual Record_t  GetColumnReadersImpl(std::string_view name, const std::type_info & type);
+
+public:
+   TFTableSource(const TFTable & table);
+   TFTableSource(TFGroup & group);
+   virtual ~TFTableSource();
+
+   virtual void      SetNSlots(unsigned int nSlots);
+   virtual const std::vector<std::string> & GetColumnNames() const  {return fColNames;}
+   virtual bool      HasColumn(std::string_view name) const;
+   virtual std::string GetTypeName(std::string_view name) const;
+   virtual std::vector<std::pair<ULong64_t, ULong64_t> > GetEntryRanges();
+   virtual void      InitSlot(unsigned int slot, ULong64_t firstEntry);
+   virtual bool      SetEntry(unsigned int slot, ULong64_t entry);
+   virtual void      Initialize()                     {fRangesDone = kFALSE;}
+   virtual std::string GetLabel()                     {return "TFTable";}
+
+   UInt_t            GetNumTables() const             {return fTables.size();}
+};
+
+ROOT::RDataFrame  TFMakeDataFrame(const TFTable & table);
+ROOT::RDataFrame  TFMakeDataFrame(TFGroup & group);
+
+#endif
@@ -0,0 +1,317 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFTreeReader.cxx
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+
+#include <algorithm>
+
+#include <TROOT.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TLeaf.h>
+#include <TBufferFile.h>
+
+#include "TFTreeReader.h"
+#include "TFColumn.h"
+#include "TFParallel.h"
+
+
+//_____________________________________________________________________________
+// TFTreeReader:
+//    Internal class, used by the constructor TFTable(TTree * tree). Should
+//    not be used directly by an application.
+//    The entries of a TTree or of all trees of a TChain are copied into the
+//    columns, tree after tree. The branches of one tree are read
+//    independent of each other, in parallel by the threads of the ROOT
+//    thread pool if the implicit multi-threading of ROOT is enabled. Like
+//    TTree::GetEntry() with implicit multi-threading each branch is read
+//    and decompressed by only one thread, and the parallel processing of
+//    branches is announced to ROOT ( TParBranchProcessingRAII ), so that
+//    the threads lock the shared file and tree cache.
+//    A branch with one number per entry is read with the bulk API of
+//    TBranch: all entries of one basket are copied with one memcpy into
+//    the data array of the column. The other branches are read entry by
+//    entry into the branch buffer of their column.
+//    A branch of a variable array is read together with its count branch.
+//    These branches are read after the other branches, as the count branch
+//    may be a column, too. The count branches of all trees are read first,
+//    with the bulk API if possible, to set the number of values of all rows
+//    of the variable array columns at once. The values of an entry are then
+//    copied directly to their row in the data array of the column.
+
+static const Int_t kBulkBufferSize = 32 * 1024;   // start size of the bulk buffer
+
+//_____________________________________________________________________________
+// columns read by one thread, and the branch of the number of values of
+// variable arrays
+
+struct TFTreeTask
+{
+   TString              fCount;   // count branch, or empty
+   std::vector<UInt_t>  fCols;    // index of the columns
+};
+
+//_____________________________________________________________________________
+static void * GetScalarData(TFBaseCol * col)
+{
+// returns the data array of a column with one number per row or NULL for
+// the other column types
+
+   if (TFCharCol   * c = dynamic_cast<TFCharCol *>(col))    return c->GetDataArray();
+   if (TFUCharCol  * c = dynamic_cast<TFUCharCol *>(col))   return c->GetDataArray();
+   if (TFShortCol  * c = dynamic_cast<TFShortCol *>(col))   return c->GetDataArray();
+   if (TFUShortCol * c = dynamic_cast<TFUShortCol *>(col))  return c->GetDataArray();
+   if (TFIntCol    * c = dynamic_cast<TFIntCol *>(col))     return c->GetDataArray();
+   if (TFUIntCol   * c = dynamic_cast<TFUIntCol *>(col))    return c->GetDataArray();
+   if (TFFloatCol  * c = dynamic_cast<TFFloatCol *>(col))   return c->GetDataArray();
+   if (TFDoubleCol * c = dynamic_cast<TFDoubleCol *>(col))  return c->GetDataArray();
+
+   return NULL;
+}
+//_____________________________________________________________________________
+template <class C>
+static Bool_t SetVarRowSizes(TFBaseCol * col, const Long64_t * sizes, void *& data,
+                             const ULong64_t *& offsets)
+{
+// sets the number of values of all rows of col if it is a column of type C
+// and returns its data array and the offsets of its rows
+
+   C * c = dynamic_cast<C *>(col);
+   if (c == NULL)
+      return kFALSE;
+
+   c->SetRowSizes(sizes);
+   data    = c->GetDataArray();
+   offsets = c->GetOffsets();
+   return kTRUE;
+}
+//_____________________________________________________________________________
+static void ReadCounts(TTree * tree, const TString & count, Long64_t * counts, UInt_t num)
+{
+// reads the first num entries of the count branch count of tree into counts
+
+   TBranch * branch = tree->GetBranch(count.Data());
+   TLeaf   * leaf   = branch ? (TLeaf *)branch->GetListOfLeaves()->At(0) : NULL;
+   if (leaf == NULL)
+      return;
+
+   UInt_t entry = 0;
+   if (strcmp(leaf->GetTypeName(), "Int_t") == 0 && branch->SupportsBulkRead())
+      {
+      TBufferFile buffer(TBuffer::kWrite, kBulkBufferSize);
+      while (entry < num)
+         {
+         Int_t numEntries = branch->GetBulkRead().GetBulkEntries(entry, buffer);
+         if (numEntries <= 0)
+            // read the rest entry by entry
+            break;
+         numEntries = std::min((UInt_t)numEntries, num - entry);
+         const Int_t * values = (const Int_t *)buffer.GetCurrent();
+         for (Int_t i = 0; i < numEntries; i++)
+            counts[entry + i] = values[i];
+         entry += numEntries;
+         }
+      }
+
+   for (; entry < num; entry++)
+      {
+      branch->GetEntry(entry);
+      counts[entry] = (Long64_t)leaf->GetValue();
+      }
+}
+//_____________________________________________________________________________
+static void ReadTask(TTree * tree, const std::vector<TFTreeCol> & cols,
+                     const std::vector<void *> & data,
+                     const std::vector<const ULong64_t *> & offsets,
+                     const TFTreeTask & task, UInt_t first, UInt_t num)
+{
+// reads the num entries of the columns of task from tree into the rows
+// starting at first. The rows of variable array columns must already
+// have their number of values, see SetVarRowSizes().
+
+   std::vector<TBranch *> branches(task.fCols.size());
+   std::vector<TLeaf *>   leaves(task.fCols.size());
+   std::vector<char *>    buffers(task.fCols.size());
+   for (UInt_t col = 0; col < task.fCols.size(); col++)
+      {
+      branches[col] = tree->GetBranch(cols[task.fCols[col]].fBranch.Data());
+      if (branches[col] && task.fCount.Length())
+         {
+         // the maximum number of values per entry depends on the tree
+         // of a TChain
+         leaves[col]  = (TLeaf *)branches[col]->GetListOfLeaves()->At(0);
+         buffers[col] = (char *)cols[task.fCols[col]].fCol->GetVarBranchBuffer(leaves[col]);
+         branches[col]->SetAddress(buffers[col]);
+         }
+      }
+   TBranch * count = task.fCount.Length() ? tree->GetBranch(task.fCount.Data()) : NULL;
+
+   UInt_t entry = 0;
+   void * colData = data[task.fCols[0]];
+   if (count == NULL && task.fCols.size() == 1 && colData && branches[0] &&
+       branches[0]->SupportsBulkRead())
+      {
+      // copy whole baskets into the column
+      size_t size = cols[task.fCols[0]].fCol->GetWidth();
+      char * dest = (char *)colData + (size_t)first * size;
+      TBufferFile buffer(TBuffer::kWrite, kBulkBufferSize);
+      while (entry < num)
+         {
+         Int_t numEntries = branches[0]->GetBulkRead().GetBulkEntries(entry, buffer);
+         if (numEntries <= 0)
+            // read the rest entry by entry
+            break;
+         numEntries = std::min((UInt_t)numEntries, num - entry);
+         memcpy(dest + (size_t)entry * size, buffer.GetCurrent(), (size_t)numEntries * size);
+         entry += numEntries;
+         }
+      }
+
+   for (; entry < num; entry++)
+      {
+      if (count)
+         count->GetEntry(entry);
+      for (UInt_t col = 0; col < branches.size(); col++)
+         {
+         if (branches[col] == NULL)
+            continue;
+         branches[col]->GetEntry(entry);
+         if (count == NULL)
+            {
+            cols[task.fCols[col]].fCol->CopyBranchBuffer(first + entry);
+            continue;
+            }
+
+         // copy the values into their row of the variable array column
+         const ULong64_t * rows = offsets[task.fCols[col]];
+         size_t size = cols[task.fCols[col]].fCol->GetWidth();
+         ULong64_t numValues = std::min((ULong64_t)leaves[col]->GetLen(),
+                                        rows[first + entry + 1] - rows[first + entry]);
+         if (numValues > 0)
+            memcpy((char *)data[task.fCols[col]] + rows[first + entry] * size,
+                   buffers[col], numValues * size);
+         }
+      }
+}
+//_____________________________________________________________________________
+void TFTreeReader::ReadTree(TTree * tree, const std::vector<TFTreeCol> & cols,
+                            UInt_t numRows)
+{
+// Copies the first numRows entries of the branches of tree into the
+// columns cols. The branch address of each column must already be set in
+// tree ( TTree::SetBranchAddress() ). tree can be a TChain.
+
+   if (cols.empty())
+      return;
+
+   // the data arrays of the columns with one number per row
+   std::vector<void *> data(cols.size());
+   for (UInt_t col = 0; col < cols.size(); col++)
+      data[col] = GetScalarData(cols[col].fCol);
+
+   // one task for each column, one task for all variable arrays of one
+   // count branch
+   std::vector<TFTreeTask> tasks;
+   std::vector<TFTreeTask> varTasks;
+   for (UInt_t col = 0; col < cols.size(); col++)
+      {
+      if (cols[col].fCount.Length() == 0)
+         {
+         tasks.push_back(TFTreeTask());
+         tasks.back().fCols.push_back(col);
+         continue;
+         }
+
+      UInt_t task = 0;
+      while (task < varTasks.size() && varTasks[task].fCount != cols[col].fCount)
+         task++;
+      if (task == varTasks.size())
+         {
+         varTasks.push_back(TFTreeTask());
+         varTasks.back().fCount = cols[col].fCount;
+         }
+      varTasks[task].fCols.push_back(col);
+      }
+
+   // the number of values of each entry of the variable arrays, read
+   // from the count branches of all trees
+   std::vector<std::vector<Long64_t> > counts(varTasks.size(),
+                                              std::vector<Long64_t>(numRows, 0));
+   UInt_t first = 0;
+   while (first < numRows && !varTasks.empty())
+      {
+      // the tree of entry first, for a TChain the next tree of the chain
+      if (tree->LoadTree(first) < 0)
+         break;
+      TTree * current = tree->GetTree();
+      UInt_t num = (UInt_t)std::min((Long64_t)(numRows - first), current->GetEntries());
+      if (num == 0)
+         break;
+
+      ROOT::Internal::TParBranchProcessingRAII parBranches;
+      TFParallel::Foreach(varTasks.size(), varTasks.size(),
+                          [&](UInt_t task, UInt_t, UInt_t)
+                             {ReadCounts(current, varTasks[task].fCount,
+                                         &counts[task][first], num);});
+      first += num;
+      }
+
+   // all rows of a variable array column get their size at once
+   std::vector<const ULong64_t *> offsets(cols.size(), (const ULong64_t *)NULL);
+   std::vector<Long64_t> sizes(numRows);
+   for (UInt_t task = 0; task < varTasks.size(); task++)
+      for (UInt_t index = 0; index < varTasks[task].fCols.size(); index++)
+         {
+         UInt_t    col    = varTasks[task].fCols[index];
+         TBranch * branch = tree->GetBranch(cols[col].fBranch.Data());
+         TLeaf   * leaf   = branch ? (TLeaf *)branch->GetListOfLeaves()->At(0) : NULL;
+         Long64_t  len    = leaf ? leaf->GetLenStatic() : 1;
+         for (UInt_t row = 0; row < numRows; row++)
+            sizes[row] = counts[task][row] > 0 ? counts[task][row] * len : 0;
+
+         TFBaseCol * c = cols[col].fCol;
+         void * & d = data[col];
+         const ULong64_t * & o = offsets[col];
+         SetVarRowSizes<TFCharVarArrCol>(c, sizes.data(), d, o)   ||
+         SetVarRowSizes<TFUCharVarArrCol>(c, sizes.data(), d, o)  ||
+         SetVarRowSizes<TFShortVarArrCol>(c, sizes.data(), d, o)  ||
+         SetVarRowSizes<TFUShortVarArrCol>(c, sizes.data(), d, o) ||
+         SetVarRowSizes<TFIntVarArrCol>(c, sizes.data(), d, o)    ||
+         SetVarRowSizes<TFUIntVarArrCol>(c, sizes.data(), d, o)   ||
+         SetVarRowSizes<TFFloatVarArrCol>(c, sizes.data(), d, o)  ||
+         SetVarRowSizes<TFDoubleVarArrCol>(c, sizes.data(), d, o);
+         }
+
+   first = 0;
+   while (first < numRows)
+      {
+      // the tree of entry first, for a TChain the next tree of the chain
+      if (tree->LoadTree(first) < 0)
+         break;
+      TTree * current = tree->GetTree();
+      UInt_t num = (UInt_t)std::min((Long64_t)(numRows - first), current->GetEntries());
+      if (num == 0)
+         break;
+
+      // the threads read sibling branches of the same tree and file
+      ROOT::Internal::TParBranchProcessingRAII parBranches;
+      TFParallel::Foreach(tasks.size(), tasks.size(),
+                          [&](UInt_t task, UInt_t, UInt_t)
+                             {ReadTask(current, cols, data, offsets, tasks[task], first, num);});
+      TFParallel::Foreach(varTasks.size(), varTasks.size(),
+                          [&](UInt_t task, UInt_t, UInt_t)
+                             {ReadTask(current, cols, data, offsets, varTasks[task], first, num);});
+
+      first += num;
+      }
+
+   // the values were copied into the data arrays of the columns
+   for (UInt_t col = 0; col < cols.size(); col++)
+      cols[col].fCol->InvalidateStats();
+}
@@ -0,0 +1,46 @@
+// ////////////////////////////////////////////////////////////////////////////
+//
+//  File:      TFTreeReader.h
+//
+//  Version:   1.0
+//
+//  History:   1.0   16.10.26  first released version
+//
+// ////////////////////////////////////////////////////////////////////////////
+#ifndef ROOT_TFTreeReader
+#define ROOT_TFTreeReader
+
+#ifndef ROOT_Rtypes
+#include "Rtypes.h"
+#endif
+
+#ifndef ROOT_TString
+#include "TString.h"
+#endif
+
+#include <vector>
+
+
+class TTree;
+class TFBaseCol;
+
+//_____________________________________________________________________________
+// one column of a table filled from one branch of a tree
+
+struct TFTreeCol
+{
+   TString     fBranch;    // name of the branch
+   TString     fCount;     // branch with the number of values of a variable array, or empty
+   TFBaseCol * fCol;       // the column, the address of the branch is its branch buffer
+};
+
+//_____________________________________________________________________________
+
+class TFTreeReader
+{
+public:
+   static void    ReadTree(TTree * tree, const std::vector<TFTreeCol> & cols,
+                           UInt_t numRows);
+};
+
+#endif